@@ -5,6 +5,7 @@
 #include <sys/mman.h>
 #include <pthread.h>
 #include "libft/libft.h"
+#include "ft_malloc_shm.h"
 
 /* -------------------------------------------------------------------------- */
 /* Constants                                                                   */
@@ -12,12 +13,69 @@
 
 # define TINY_MALLOC_LIMIT 128
 # define SMALL_MALLOC_LIMIT 1024
+# define MEDIUM_MALLOC_LIMIT (256 * 1024)
+
+/*
+ * MEDIUM zones are shared between many allocations and indexed with TLSF;
+ * each one maps at least this much (more for a request that would not fit).
+ */
+#define MEDIUM_ZONE_SIZE (4UL * 1024UL * 1024UL)
+
+/*
+ * Geometric zone growth: after every ZONE_GROWTH_STEP zones of one class,
+ * the next pooled zone of that class is twice as big, up to ZONE_MAX_SIZE
+ * (never below the class's base size). Small programs keep small zones;
+ * big heaps need far fewer mappings and zone list entries.
+ */
+#define ZONE_GROWTH_STEP 4
+#define ZONE_MAX_SIZE    (64UL * 1024UL * 1024UL)
 
 #define MIN_ALLOCS 100
 
+/*
+ * Cache coloring: pooled zones and cache slabs start their block/object
+ * area at a rotating multiple of CACHE_LINE_SIZE, within the slack left by
+ * page rounding, so their hot first lines do not all share cache sets.
+ * ZONE_COLORS lines span one 4 KiB page, i.e. every set of a typical L1.
+ */
+#define CACHE_LINE_SIZE 64UL
+#define ZONE_COLORS     64
+
 #define MALLOC_ALIGN 16UL
 #define ALIGN_UP(x) (((x) + (MALLOC_ALIGN - 1)) & ~(MALLOC_ALIGN - 1))
 
+/*
+ * Freed TINY/SMALL blocks are parked on a per-class "recently freed" list
+ * and reused as-is; they are only coalesced when an allocation misses the
+ * list or when the list grows past this many entries.
+ */
+#define DEFERRED_FREE_LIMIT 64
+
+/* Block states (low bits of t_block.info). */
+#define BLOCK_USED     0 /* Currently allocated. */
+#define BLOCK_FREE     1 /* Available; may be split or coalesced. */
+#define BLOCK_DEFERRED 2 /* Freed, parked on the recently-freed list (not coalescable). */
+#define BLOCK_FRONTIER 3 /* Untouched tail of a fresh zone: only carved by bumping. */
+
+/*
+ * Payload sizes are multiples of MALLOC_ALIGN, so the low 4 bits of
+ * t_block.info are free for flags: bits 0-1 hold the state, bits 2-3 the
+ * zone class of the block.
+ */
+#define BLOCK_STATE_MASK  0x3UL
+#define BLOCK_CLASS_SHIFT 2
+#define BLOCK_CLASS_MASK  (0x3UL << BLOCK_CLASS_SHIFT)
+#define BLOCK_FLAGS_MASK  (MALLOC_ALIGN - 1)
+
+/* mallopt() parameters specific to ft_malloc (other parameters are rejected). */
+#define M_FT_PREFAULT     (-1001) /* value != 0: map new pooled zones prefaulted. */
+#define M_FT_WARM         (-1002) /* value: prefault this many bytes of zones per pooled class now. */
+#define M_FT_SHM_STATS    (-1003) /* value != 0: start publishing live stats in /dev/shm. */
+#define M_FT_LATENCY      (-1004) /* value != 0: time every call into latency histograms. */
+#define M_FT_LOCK_PROFILE (-1005) /* value != 0: profile class lock contention per call site. */
+#define M_FT_ASYNC_UNMAP  (-1006) /* value != 0: unmap freed LARGE zones on a background thread (> 1: byte cap). */
+#define M_FT_HOT_SLABS    (-1007) /* value == 0: stop serving popular sizes from dedicated slabs (on by default). */
+
 #define ZONE_HDR_SIZE  ALIGN_UP(sizeof(t_zone))
 #define BLOCK_HDR_SIZE ALIGN_UP(sizeof(t_block))
 
@@ -29,11 +87,15 @@
 /*
  * Block Header (Metadata for each allocation)
  * This sits immediately before the memory returned to the user.
+ *
+ * 16 bytes, so user pointers stay 16-aligned. Neighbors are not stored:
+ * the next block starts right after this payload, the previous one
+ * prev_size bytes (plus a header) before this header. Every zone ends with
+ * a fence header of size 0 that stops forward walks.
  */
 typedef struct s_block {
-    struct s_block *next; /* Next block in the same zone. */
-    size_t          size; /* User payload size (excluding metadata header). */
-    int             free; /* 1 when available, 0 when currently allocated. */
+    size_t prev_size; /* Payload size of the previous block, 0 for a zone's first block. */
+    size_t info;      /* Payload size | class << BLOCK_CLASS_SHIFT | state. */
 } t_block;
 
 /*
@@ -43,25 +105,254 @@ typedef struct s_block {
 typedef enum e_zone_type {
     TINY,
     SMALL,
-    LARGE
+    MEDIUM,
+    LARGE,
+    ZONE_TYPE_COUNT /* Number of zone classes (for per-class arrays). */
 } t_zone_type;
 
+/* Bulk fill/copy kernel families (mem_kernels.c), narrowest first. */
+typedef enum e_mem_kernel {
+    MEM_KERNEL_GENERIC,
+    MEM_KERNEL_SSE2,
+    MEM_KERNEL_AVX2,
+    MEM_KERNEL_AVX512,
+    MEM_KERNEL_COUNT
+} t_mem_kernel;
+
 typedef struct s_zone {
-    struct s_zone *next;   /* Next zone in the global zone list. */
-    t_block *      blocks; /* First block contained in this zone. */
-    size_t         size;   /* Total mapped zone size, metadata included. */
-    t_zone_type    type;   /* Zone class: TINY, SMALL, or LARGE. */
+    struct s_zone *next;      /* Next zone in the global zone list. */
+    t_block *      blocks;    /* First block contained in this zone. */
+    t_block *      free_hint; /* First-fit start: no BLOCK_FREE block lies before it. */
+    size_t         size;      /* Total mapped zone size, metadata included. */
+    t_zone_type    type;      /* Zone class: TINY, SMALL, MEDIUM or LARGE. */
+    struct s_hot_size *hot;   /* Hot-size slab zones: owning size (hot_slab.c), else NULL. */
+    size_t         hot_live;  /* Hot-size slab zones: slots handed out. */
+    t_block *      hot_free;  /* Hot-size slab zones: free slots, linked through their payload. */
+    struct s_zone *hot_next;  /* Hot-size slab zones with a free slot, per size (doubly linked). */
+    struct s_zone *hot_prev;
+    t_block *      frontier;  /* Untouched tail (BLOCK_FRONTIER block), NULL when none. */
 } t_zone;
 
 
+/* -------------------------------------------------------------------------- */
+/* Block header accessors                                                      */
+/* -------------------------------------------------------------------------- */
+
+static inline size_t block_size(const t_block *block) {
+    return block->info & ~BLOCK_FLAGS_MASK;
+}
+
+static inline int block_state(const t_block *block) {
+    return (int)(block->info & BLOCK_STATE_MASK);
+}
+
+static inline t_zone_type block_class(const t_block *block) {
+    return (t_zone_type)((block->info & BLOCK_CLASS_MASK) >> BLOCK_CLASS_SHIFT);
+}
+
+static inline void block_set_size(t_block *block, const size_t size) {
+    block->info = size | (block->info & BLOCK_FLAGS_MASK);
+}
+
+static inline void block_set_state(t_block *block, const int state) {
+    block->info = (block->info & ~BLOCK_STATE_MASK) | (size_t)state;
+}
+
+static inline void block_init(t_block *block, const size_t prev_size, const size_t size,
+                              const t_zone_type type, const int state) {
+    block->prev_size = prev_size;
+    block->info      = size | ((size_t)type << BLOCK_CLASS_SHIFT) | (size_t)state;
+}
+
+/* Header right after this block's payload: the next block or the zone fence. */
+static inline t_block *block_after(const t_block *block) {
+    return (t_block *)((char *)block + BLOCK_HDR_SIZE + block_size(block));
+}
+
+/* Next block in the same zone, NULL at the zone fence. */
+static inline t_block *block_next(const t_block *block) {
+    t_block *next = block_after(block);
+
+    return block_size(next) ? next : NULL;
+}
+
+/* Previous block in the same zone, NULL for the first one. */
+static inline t_block *block_prev(const t_block *block) {
+    if (!block->prev_size)
+        return NULL;
+    return (t_block *)((char *)block - block->prev_size - BLOCK_HDR_SIZE);
+}
+
+/*
+ * Private heap: per-class zone lists owned by the caller, kept out of
+ * g_zones. Unlocked by design (single-threaded use).
+ */
+typedef struct s_heap {
+    t_zone *zones[ZONE_TYPE_COUNT];      /* Heap-owned zone lists, one per class. */
+    size_t  zone_counts[ZONE_TYPE_COUNT]; /* Zones mapped so far per class (zone growth). */
+} t_heap;
+
+/*
+ * Bump-pointer region: chunks of mmap'd memory carved by a moving cursor.
+ * The handle lives in the first chunk. Unlocked by design.
+ */
+typedef struct s_region_chunk {
+    struct s_region_chunk *next; /* Next chunk (kept across resets for reuse). */
+    size_t                 size; /* Mapped chunk size, header included. */
+} t_region_chunk;
+
+typedef struct s_region {
+    t_region_chunk *first;      /* Oldest chunk, also hosting this handle. */
+    t_region_chunk *current;    /* Chunk the cursor bumps through. */
+    char *          cursor;     /* Next free byte in current. */
+    char *          limit;      /* End of current. */
+    size_t          chunk_size; /* Size of the last mapped chunk (grows geometrically). */
+} t_region;
+
+/* Saved region position; resetting to it drops everything allocated after. */
+typedef struct s_region_mark {
+    t_region_chunk *chunk;
+    char *          cursor;
+} t_region_mark;
+
+/*
+ * Offset-linked arena (oarena.c): one mapping holding a header and a block
+ * area, linked only by offsets from the mapping base so it can be mapped
+ * anywhere. Blocks use the regular t_block header; free blocks sit on
+ * size-binned lists whose links (block offsets) live in their payloads.
+ * Every metadata write is undo-logged in the header first, so a process
+ * dying in the middle of an operation leaves a state oarena_recover()
+ * rolls back.
+ */
+#define OARENA_BINS    48 /* Free-list bins: one per power of two of payload / MALLOC_ALIGN. */
+#define OARENA_LOG_MAX 64 /* Metadata writes a single operation may log. */
+
+typedef struct s_oarena_entry {
+    uint64_t offset; /* Word written, from the arena base. */
+    uint64_t value;  /* Its value before the write. */
+} t_oarena_entry;
+
+typedef struct s_oarena {
+    uint64_t       magic;             /* Format tag, written last when formatting. */
+    uint64_t       size;              /* Mapped bytes, header included. */
+    uint64_t       first;             /* Offset of the first block header. */
+    uint64_t       root;              /* Caller's root object (payload offset), 0 if none. */
+    uint64_t       in_use;            /* Payload bytes handed out. */
+    uint64_t       bins[OARENA_BINS]; /* Free-list heads (block offsets), 0 when empty. */
+    uint64_t       log_count;         /* Entries of an operation in progress, 0 when idle. */
+    t_oarena_entry log[OARENA_LOG_MAX];
+} t_oarena;
+
+/* Persistent heap: an offset-linked arena in a MAP_SHARED file mapping. */
+typedef struct s_pheap t_pheap;
+
+/* Cross-process heap: an offset-linked arena in POSIX shared memory. */
+typedef struct s_shm_heap t_shm_heap;
+
+/*
+ * Allocator lock: short spin with backoff, then futex sleep.
+ * Counters are updated by the lock owner only, so they need no atomics.
+ */
+typedef struct s_ft_lock {
+    int    state;        /* 0 unlocked, 1 locked, 2 locked with sleepers. */
+    size_t acquisitions; /* Total successful lock calls. */
+    size_t contended;    /* Acquisitions that found the lock already held. */
+    size_t sleeps;       /* Futex waits performed by contended acquirers. */
+} t_ft_lock;
+
+#define FT_LOCK_INITIALIZER {0, 0, 0, 0}
+
+/*
+ * Typed object cache: dedicated slabs of equal-size slots whose objects
+ * keep their constructed state across free/alloc cycles.
+ */
+typedef void (*t_cache_ctor)(void *obj);
+typedef void (*t_cache_dtor)(void *obj);
+
+/* Start of the payload of a cache slab zone (cache.c). */
+typedef struct s_slab {
+    size_t capacity; /* Object slots in this slab. */
+    size_t color;    /* Offset of the first slot past the header room. */
+} t_slab;
+
+typedef struct s_cache {
+    struct s_cache *next;        /* Next cache in the registry. */
+    char            name[32];    /* Copy of the caller's cache name. */
+    size_t          object_size; /* Requested object size. */
+    size_t          align;       /* Object alignment (power of two). */
+    size_t          link_offset; /* Free-list link position inside a slot. */
+    size_t          stride;      /* Distance between two slots. */
+    t_cache_ctor    ctor;        /* Runs once per slot, when its slab is created. */
+    t_cache_dtor    dtor;        /* Runs on cached objects when the cache is destroyed. */
+    t_zone *        slabs;       /* Slab zones owned by this cache (private list). */
+    size_t          next_color;  /* Color (slot offset) of the next slab. */
+    void *          free_list;   /* Constructed objects ready to hand out. */
+    t_ft_lock       lock;        /* Protects everything above and the counters. */
+    size_t          slab_count;  /* Zones in `slabs` (request_new_zone() count). */
+    size_t          capacity;    /* Slots over all slabs. */
+    size_t          in_use;      /* Objects currently handed out. */
+    size_t          allocs;
+    size_t          frees;
+    size_t          constructed; /* Constructor calls so far. */
+} t_cache;
+
+/*
+ * Report output: text is formatted into `data` and reaches the fd in
+ * OUTBUF_SIZE batches. Lives on the caller's stack.
+ */
+#define OUTBUF_SIZE (16UL * 1024UL)
+
+typedef struct s_outbuf {
+    int    fd;
+    int    failed;            /* A write failed: the rest of the report is dropped. */
+    size_t len;               /* Pending bytes in data. */
+    char   data[OUTBUF_SIZE];
+} t_outbuf;
+
+/* Copy of the allocator state taken under the class locks (show functions). */
+typedef struct s_snap_entry {
+    const void *addr;    /* Zone base, or block payload address. */
+    size_t      size;    /* Payload size (0 for a zone entry). */
+    size_t      copied;  /* Payload bytes copied into the snapshot data. */
+    int         is_zone; /* 1: zone header entry, 0: allocated block. */
+    t_zone_type type;
+} t_snap_entry;
+
+typedef struct s_snapshot {
+    t_snap_entry * entries;  /* Zones in class order, each followed by its blocks. */
+    size_t         count;
+    unsigned char *data;     /* Copied payloads, back to back in entry order. */
+    size_t         map_size; /* Whole private mapping (entries + data). */
+} t_snapshot;
+
 /* -------------------------------------------------------------------------- */
 /* Globals                                                                     */
 /* -------------------------------------------------------------------------- */
 
-extern t_zone *g_zones;          /* Global linked list of all zones. */
-extern pthread_mutex_t g_mutex;  /* Allocator-wide mutex for thread safety. */
+extern t_zone *g_zones[ZONE_TYPE_COUNT];               /* Per-class zone lists, address ordered. */
+extern size_t g_zone_counts[ZONE_TYPE_COUNT];          /* Pooled zones mapped so far per class. */
+extern t_ft_lock g_zone_locks[ZONE_TYPE_COUNT];        /* One lock per class, taken in enum order. */
 extern int g_malloc_scribble;    /* Fill allocated/free memory with patterns when enabled. */
 extern int g_malloc_debug;       /* Emit allocator debug traces to stderr when enabled. */
+extern int g_malloc_prefault;    /* Map new pooled zones with their pages already faulted in. */
+extern t_shm_stats *g_shm_stats; /* Live stats segment, NULL unless publishing is enabled. */
+extern int g_malloc_latency;     /* Time public calls into per-thread histograms when enabled. */
+extern int g_lock_profile;       /* Record class lock wait/hold times per call site when enabled. */
+extern int g_async_unmap;        /* Hand freed LARGE zones to the reclaimer thread when enabled. */
+extern int g_hot_slabs;          /* Serve popular TINY/SMALL sizes from exact-fit slabs (default on). */
+extern __thread int t_latency_slow __attribute__((tls_model("initial-exec"))); /* Call mapped/unmapped a zone. */
+
+/* Live stats: one relaxed atomic update, only when publishing is enabled. */
+#define SHM_STAT_ADD(field, n)                                                         \
+    do {                                                                               \
+        if (g_shm_stats)                                                               \
+            __atomic_fetch_add(&g_shm_stats->field, (uint64_t)(n), __ATOMIC_RELAXED);  \
+    } while (0)
+#define SHM_STAT_SUB(field, n)                                                         \
+    do {                                                                               \
+        if (g_shm_stats)                                                               \
+            __atomic_fetch_sub(&g_shm_stats->field, (uint64_t)(n), __ATOMIC_RELAXED);  \
+    } while (0)
 
 /* -------------------------------------------------------------------------- */
 /* Public API                                                                  */
@@ -71,28 +362,228 @@ void *malloc(size_t size);
 void  free(void *ptr);
 void *realloc(void *ptr, size_t size);
 void *calloc(size_t nmemb, size_t size);
+int   posix_memalign(void **memptr, size_t alignment, size_t size);
+void *aligned_alloc(size_t alignment, size_t size);
+void *memalign(size_t alignment, size_t size);
+void *valloc(size_t size);
 void  show_alloc_mem(void);
 void  show_alloc_mem_ex(void);
+void  show_alloc_mem_stats(void);
+int   mallopt(int param, int value);
+
+/* Report variants: target fd, hexdump byte limit (0 = no limit), file path. */
+void show_alloc_mem_fd(int fd);
+void show_alloc_mem_ex_fd(int fd, size_t limit);
+int  show_alloc_mem_ex_file(const char *path, size_t limit);
+void show_alloc_mem_stats_fd(int fd);
+
+/* Heap layout as JSON Lines, for tools/ft_malloc_layout.py (0, or -1 on failure). */
+void show_alloc_mem_layout(void);
+int  show_alloc_mem_layout_fd(int fd);
+int  show_alloc_mem_layout_file(const char *path);
+
+/* Latency histograms (MallocLatency=1): p50/p99/p99.9/max per call, class and path. */
+void show_alloc_mem_latency(void);
+void show_alloc_mem_latency_fd(int fd);
+
+/* Lock profile (MallocLockProfile=1): contention, wait and hold times per call site. */
+void show_alloc_mem_lock_profile(void);
+void show_alloc_mem_lock_profile_fd(int fd);
+
+/* Private heaps: no locking, bulk release with ft_heap_destroy(). */
+t_heap *ft_heap_create(void);
+void *  ft_heap_malloc(t_heap *heap, size_t size);
+void    ft_heap_free(t_heap *heap, void *ptr);
+void    ft_heap_destroy(t_heap *heap);
+
+/* Bump-pointer regions: no per-object free, O(1) reset to a mark. */
+t_region *    ft_region_create(size_t chunk_size);
+void *        ft_region_alloc(t_region *region, size_t size, size_t align);
+t_region_mark ft_region_mark(const t_region *region);
+void          ft_region_reset(t_region *region, t_region_mark mark, int release);
+void          ft_region_destroy(t_region *region);
+
+/* Persistent file-backed heaps: offsets stay valid across restarts and remaps. */
+t_pheap *ft_pheap_open(const char *path, size_t size);
+void     ft_pheap_close(t_pheap *heap);
+void *   ft_pheap_malloc(t_pheap *heap, size_t size);
+void     ft_pheap_free(t_pheap *heap, void *ptr);
+void *   ft_pheap_root(t_pheap *heap);
+void     ft_pheap_set_root(t_pheap *heap, void *ptr);
+size_t   ft_pheap_offset(const t_pheap *heap, const void *ptr);
+void *   ft_pheap_pointer(const t_pheap *heap, size_t offset);
+int      ft_pheap_sync(t_pheap *heap);
+int      ft_pheap_check(t_pheap *heap);
+
+/* Cross-process heaps: any attached process allocates and frees; hand blocks over as offsets. */
+t_shm_heap *ft_shm_heap_create(const char *name, size_t size);
+t_shm_heap *ft_shm_heap_attach(const char *name);
+void        ft_shm_heap_detach(t_shm_heap *heap);
+int         ft_shm_heap_destroy(const char *name);
+void *      ft_shm_heap_malloc(t_shm_heap *heap, size_t size);
+void        ft_shm_heap_free(t_shm_heap *heap, void *ptr);
+void *      ft_shm_heap_root(t_shm_heap *heap);
+void        ft_shm_heap_set_root(t_shm_heap *heap, void *ptr);
+size_t      ft_shm_heap_offset(const t_shm_heap *heap, const void *ptr);
+void *      ft_shm_heap_pointer(const t_shm_heap *heap, size_t offset);
+int         ft_shm_heap_check(t_shm_heap *heap);
+
+/* Typed object caches: constructed objects are reused without re-init. */
+t_cache *ft_cache_create(const char *name, size_t size, size_t align,
+                         t_cache_ctor ctor, t_cache_dtor dtor);
+void *   ft_cache_alloc(t_cache *cache);
+void     ft_cache_free(t_cache *cache, void *obj);
+void     ft_cache_destroy(t_cache *cache);
 
 /* -------------------------------------------------------------------------- */
 /* Internal shared helpers (not part of the public API)                        */
 /* -------------------------------------------------------------------------- */
 
-/* Core logic without locks (used by realloc to avoid deadlocks) */
-void *malloc_nolock(size_t size);
-void  free_nolock(void *ptr);
+/*
+ * Locking discipline:
+ * - each class lock only protects g_zones[type] and the blocks inside it
+ * - when several class locks are needed, take them in ascending enum order
+ * - LARGE mmap()/munmap() calls run with no class lock held
+ */
+void ft_lock(t_ft_lock *lock);
+int  ft_trylock(t_ft_lock *lock);
+void ft_unlock(t_ft_lock *lock);
+void lock_zone_class_at(t_zone_type type, const char *site);
+void unlock_zone_class(t_zone_type type);
+void lock_all_zone_classes_at(const char *site);
+void unlock_all_zone_classes(void);
+
+/* Callers are recorded by name for the lock profiler. */
+#define lock_zone_class(type)   lock_zone_class_at((type), __func__)
+#define lock_all_zone_classes() lock_all_zone_classes_at(__func__)
+
+/* Lock profiler: per call site wait / hold times (MallocLockProfile=1). */
+int  lock_profile_enable(int enable);
+void lock_profile_acquire(t_zone_type type, const char *site);
+void lock_profile_release(t_zone_type type);
+void show_lock_profile(t_outbuf *out);
+
+/* Async LARGE unmapping: batched munmap() on a background thread (reclaim.c). */
+int  async_unmap_enable(int enable, size_t cap);
+void release_large_zone(t_zone *zone);
+void show_reclaim_stats(t_outbuf *out);
+
+/* Adaptive exact-fit slabs for popular TINY/SMALL sizes (hot_slab.c). */
+typedef struct s_hot_size t_hot_size;
+int      hot_slabs_enable(int enable);
+t_block *hot_slab_alloc(t_zone_type type, size_t size);
+void     hot_slab_free(t_zone *zone, t_block *block);
+t_block *hot_slab_block(const t_zone *zone, const void *ptr);
+void     show_hot_slab_stats(t_outbuf *out);
+
+/* Untimed bodies of the public calls (free_core returns the owning class, or -1). */
+void *malloc_core(size_t size);
+int   free_core(void *ptr);
+void *realloc_core(void *ptr, size_t size);
+void *calloc_core(size_t nmemb, size_t size);
+
+/* Aligned allocations and class-hinted free (memalign.c, shared with new_delete.cpp). */
+void *aligned_alloc_core(size_t alignment, size_t size);
+int   aligned_class_of(size_t size, size_t alignment);
+void  free_hinted_core(void *ptr, int type);
+
+/* Timed wrappers, taken by the public calls when g_malloc_latency is set. */
+void *latency_malloc(size_t size);
+void  latency_free(void *ptr);
+void *latency_realloc(void *ptr, size_t size);
+void *latency_calloc(size_t nmemb, size_t size);
+int   latency_enable(int enable);
+uint64_t monotonic_ns(void);
+void  show_latency_stats(t_outbuf *out);
+
+/* Core logic without locks (caller holds g_zone_locks[type]). */
+void *malloc_nolock(t_zone_type type, size_t requested_size, size_t aligned_size);
+int   free_nolock(t_zone_type type, void *ptr, t_zone **unmap_zone);
+
+/* LARGE path: maps outside any lock, takes the LARGE lock only to register. */
+void *malloc_large(size_t requested_size, size_t aligned_size);
+void *publish_large(t_zone *zone, size_t requested_size, size_t aligned_size);
 
 /* Utility helpers shared across files. */
-size_t  align_size(size_t size);
-void    split_block(t_block *block, size_t size);
-void    coalesce_right(t_block *current);
-t_zone *request_new_zone(t_zone_type type, size_t request_size);
+size_t      align_size(size_t size);
+t_zone_type get_zone_type(size_t size);
+void        split_block(t_block *block, size_t size);
+void        coalesce_right(t_block *current);
+t_zone *    map_zone(t_zone_type type, size_t request_size, size_t zone_count);
+void        register_zone(t_zone **list, t_zone *zone);
+void        unlink_zone(t_zone **list, t_zone *zone, t_zone *prev);
+void        release_zone(t_zone *zone);
+t_zone *    request_new_zone(t_zone **list, size_t *zone_count, t_zone_type type,
+                             size_t request_size);
+t_zone *    request_slab_zone(t_zone_type type, size_t request_size);
+t_zone *    find_zone_for_ptr(t_zone *zones, const void *ptr, t_zone **out_prev);
+t_block *   block_from_ptr(const t_zone *zone, const void *ptr);
+t_block *   find_free_block(t_zone *zones, size_t size, t_zone **out_zone);
+t_block *   carve_frontier(t_zone_type type, size_t size, t_zone **out_zone);
+
+/* Class arenas: one reserved range per pooled class, zones committed in order (O(1) lookups). */
+void *   arena_commit(t_zone_type type, size_t size);
+void     arena_note_outside(t_zone_type type);
+int      arena_class_of(const void *ptr);
+t_zone * arena_zone_below(const t_zone *zone);
+t_zone * find_class_zone(t_zone_type type, const void *ptr, t_zone **out_prev);
+t_block *find_class_block(t_zone_type type, const void *ptr, t_zone **out_zone, t_zone **out_prev);
+
+/* Recently-freed lists (caller holds g_zone_locks[type]). */
+void     defer_block(t_zone_type type, t_block *block);
+t_block *take_deferred_block(t_zone_type type, size_t size);
+void     flush_deferred_blocks(t_zone_type type);
+
+/* MEDIUM class: TLSF index over shared zones (caller holds g_zone_locks[MEDIUM]). */
+void *   medium_malloc_nolock(size_t requested_size, size_t aligned_size);
+void     medium_free_nolock(t_block *block);
+int      medium_grow_nolock(t_block *block, size_t need);
+void     medium_adopt_zone_nolock(t_zone *zone);
+
+/* Offset-linked arenas (caller serializes access; offsets are payload offsets, 0 = none). */
+int    oarena_format(t_oarena *arena, size_t size, uint64_t magic);
+int    oarena_valid(const t_oarena *arena, size_t size, uint64_t magic);
+void   oarena_recover(t_oarena *arena);
+size_t oarena_alloc(t_oarena *arena, size_t size);
+int    oarena_free(t_oarena *arena, size_t offset);
+void   oarena_set_root(t_oarena *arena, size_t offset);
+int    oarena_check(const t_oarena *arena);
+
+/* Bulk fill/copy kernels for payloads, picked at load time from the CPU features. */
+void mem_fill(void *dst, int c, size_t n);
+void mem_copy(void *dst, const void *src, size_t n);
+/* Force one kernel family (tests, benchmarks); 0 if this CPU lacks it. */
+int    mem_kernels_select(t_mem_kernel kernel);
+size_t mem_nt_threshold(void);
+
+/* Prefaulting and warm-up. */
+void   prefault_pages(void *ptr, size_t size);
+int    malloc_warm(size_t bytes);
+size_t parse_byte_size(const char *text);
+
+/* Live stats segment (shm_stats.c). */
+int  shm_stats_enable(void);
+void shm_stats_publish_lock(t_zone_type type);
+
+/* Reporting helpers: buffered output and lock-free formatting from snapshots. */
+void outbuf_init(t_outbuf *out, int fd);
+void outbuf_flush(t_outbuf *out);
+void outbuf_write(t_outbuf *out, const char *data, size_t len);
+void outbuf_putchar(t_outbuf *out, char c);
+void outbuf_putstr(t_outbuf *out, const char *str);
+void outbuf_putsize(t_outbuf *out, size_t value);
+void outbuf_putptr(t_outbuf *out, const void *ptr);
+int  take_snapshot(t_snapshot *snap, size_t payload_limit);
+void drop_snapshot(t_snapshot *snap);
+void put_zone_header(t_outbuf *out, t_zone_type type, const void *zone);
+void show_cache_stats(t_outbuf *out);
+void layout_dump_at_exit(const char *path);
 
 /* Debug helpers. */
 void debug_log_event(const char *event, const void *ptr, size_t size, const char *detail);
 void debug_log_block_merge(const t_block *left, const t_block *right, size_t merged_size);
 void debug_log_block_split(const t_block *block, size_t requested_size, size_t remainder_size);
 void debug_log_malloc_placement(const t_zone *zone, const t_block *block, size_t requested_size,
-                                size_t aligned_size, size_t original_block_size, int from_new_zone);
+                                size_t aligned_size, size_t original_block_size, const char *source);
 
 #endif
@@ -0,0 +1,58 @@
+#ifndef FT_MALLOC_SHM_H
+#define FT_MALLOC_SHM_H
+
+#include <stdint.h>
+
+/*
+ * Layout of the live stats segment (/dev/shm/ft_malloc.<pid>).
+ *
+ * Published by the allocator when MallocShmStats is set (or after
+ * mallopt(M_FT_SHM_STATS, 1)); read by tools/ft_malloc_top or any other
+ * process that maps the file read-only. Counters are updated with relaxed
+ * atomic adds, so each one is exact on its own, but two counters read one
+ * after the other may be a few operations apart.
+ *
+ * This header only depends on <stdint.h>, so readers can include it alone.
+ */
+
+#define FT_SHM_STATS_PREFIX  "/dev/shm/ft_malloc."
+#define FT_SHM_STATS_MAGIC   0x3154415453544d46ULL /* "FMTSTAT1" */
+#define FT_SHM_STATS_VERSION 1
+#define FT_SHM_CLASS_COUNT   4                      /* TINY, SMALL, MEDIUM, LARGE. */
+
+/* Cache-line aligned per class, so two classes never share a line between threads. */
+typedef struct s_shm_class_stats {
+    uint64_t allocs;           /* Successful allocations. */
+    uint64_t frees;            /* Successful frees. */
+    uint64_t bytes_in_use;     /* Allocated payload bytes (block sizes). */
+    uint64_t zones;            /* Zones currently mapped for malloc() (not private heaps). */
+    uint64_t zone_bytes;       /* Bytes of those zones. */
+    uint64_t mmap_calls;       /* Zones mapped or committed so far (private heaps included). */
+    uint64_t munmap_calls;     /* Zone munmap() calls so far. */
+    uint64_t reuse_hits;       /* Served from a recently-freed list (TINY / SMALL). */
+    uint64_t reuse_misses;     /* Recently-freed list missed, fell back to first-fit. */
+    uint64_t lock_acquisitions;
+    uint64_t lock_contended;
+    uint64_t lock_sleeps;
+    uint64_t reserved[4];
+} __attribute__((aligned(64))) t_shm_class_stats;
+
+typedef struct s_shm_cache_stats {
+    uint64_t hits;             /* ft_cache_alloc() served from the free list. */
+    uint64_t misses;           /* ft_cache_alloc() had to map a new slab. */
+    uint64_t frees;
+    uint64_t reserved[5];
+} __attribute__((aligned(64))) t_shm_cache_stats;
+
+typedef struct s_shm_stats {
+    uint64_t          magic;        /* FT_SHM_STATS_MAGIC once the segment is ready. */
+    uint32_t          version;      /* FT_SHM_STATS_VERSION. */
+    uint32_t          size;         /* sizeof(t_shm_stats) of the writer. */
+    int64_t           pid;          /* Process publishing into this segment. */
+    int64_t           start_time;   /* Unix time the segment was created. */
+    uint64_t          reserved[4];
+    t_shm_class_stats classes[FT_SHM_CLASS_COUNT];
+    t_shm_cache_stats caches;       /* All object caches together. */
+} __attribute__((aligned(64))) t_shm_stats;
+
+#endif
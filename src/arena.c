@@ -0,0 +1,193 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Reserved virtual range per pooled class.
+ *
+ * Instead of one mmap() per zone at a kernel-chosen address, every pooled
+ * class (TINY, SMALL, MEDIUM) reserves one large contiguous range on first
+ * use, PROT_NONE and MAP_NORESERVE: it costs address space, not memory.
+ * Zones of the global lists are then committed from the bottom of that
+ * range with mprotect(), back to back, in address order.
+ *
+ * Reservation layout:
+ * [owner table][zone][zone][zone]...[not committed yet ...]
+ *
+ * - The owner table has one uint32_t per ARENA_GRANULE of the zone area:
+ *   the granule index its zone starts at. Zone lookup from a pointer is
+ *   then an offset computation instead of a zone list walk, and the block
+ *   is the header right in front of the pointer, checked against its
+ *   neighbors (block_from_ptr()): free() never walks a zone either.
+ * - Ownership is a range comparison against [zones, zones + committed).
+ * - Committed zones are adjacent and share their protection, so the kernel
+ *   keeps them in one VMA: the VMA count stays flat as the heap grows.
+ *
+ * LARGE zones and private heaps keep their own mappings. When a range
+ * cannot be reserved or is full, zones fall back to plain mmap() and are
+ * found by the usual zone list walk; `outside` counts them.
+ *
+ * Zones of the global lists are never released, so committed space only
+ * grows and the owner table never needs clearing.
+ */
+
+#define ARENA_GRANULE_SHIFT 12 /* 4 KiB: zones are page multiples, pages are >= 4 KiB. */
+#define ARENA_ZONE_SPACE    ((size_t)1 << (sizeof(void *) > 4 ? 35 : 28)) /* 32 GiB (256 MiB on 32-bit). */
+#define ARENA_TABLE_SIZE    ((ARENA_ZONE_SPACE >> ARENA_GRANULE_SHIFT) * sizeof(uint32_t))
+
+typedef struct s_arena {
+    char *    zones;     /* Start of the zone area, NULL until reserved. */
+    uint32_t *owners;    /* Owner table (start of the reservation). */
+    size_t    committed; /* Bytes committed from `zones`, all in zones. */
+    size_t    outside;   /* Zones of the global list mapped outside the arena. */
+    int       failed;    /* Reservation failed once: do not retry on every zone. */
+} t_arena;
+
+/* Indexed by class; LARGE has no arena. Fields change under g_zone_locks[type]. */
+static t_arena g_arenas[ZONE_TYPE_COUNT];
+
+/* Reserve the range of a class and make its owner table writable. */
+static int reserve_arena(t_arena *arena) {
+    const size_t total = ARENA_TABLE_SIZE + ARENA_ZONE_SPACE;
+    char *       base  = mmap(NULL, total, PROT_NONE,
+                              MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+
+    if (base == MAP_FAILED) {
+        arena->failed = 1;
+        debug_log_event("arena", NULL, total, "failed: reserve");
+        return 0;
+    }
+    if (mprotect(base, ARENA_TABLE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+        munmap(base, total);
+        arena->failed = 1;
+        debug_log_event("arena", NULL, total, "failed: mprotect");
+        return 0;
+    }
+
+    arena->owners = (uint32_t *)base;
+    /* Lock-free readers (arena_class_of) test `zones` first. */
+    __atomic_store_n(&arena->zones, base + ARENA_TABLE_SIZE, __ATOMIC_RELEASE);
+    debug_log_event("arena", arena->zones, ARENA_ZONE_SPACE, "reserved");
+    return 1;
+}
+
+/*
+ * Commit `size` bytes (a page multiple) for a new zone of `type`, right
+ * above the previous one. Returns NULL when the class has no room left,
+ * so the caller maps the zone on its own.
+ *
+ * Caller holds g_zone_locks[type].
+ */
+void *arena_commit(const t_zone_type type, const size_t size) {
+    t_arena *arena = &g_arenas[type];
+
+    if (type == LARGE || arena->failed)
+        return NULL;
+    if (!arena->zones && !reserve_arena(arena))
+        return NULL;
+    if (size > ARENA_ZONE_SPACE - arena->committed)
+        return NULL;
+
+    char *zone = arena->zones + arena->committed;
+
+    if (mprotect(zone, size, PROT_READ | PROT_WRITE) != 0) {
+        debug_log_event("arena", zone, size, "failed: mprotect");
+        return NULL;
+    }
+
+    const uint32_t first = (uint32_t)(arena->committed >> ARENA_GRANULE_SHIFT);
+    const uint32_t count = (uint32_t)(size >> ARENA_GRANULE_SHIFT);
+
+    for (uint32_t i = 0; i < count; i++)
+        arena->owners[first + i] = first;
+    __atomic_store_n(&arena->committed, arena->committed + size, __ATOMIC_RELEASE);
+    return zone;
+}
+
+/* A zone of the global list of `type` was mapped outside its arena (caller holds the lock). */
+void arena_note_outside(const t_zone_type type) {
+    g_arenas[type].outside++;
+}
+
+/*
+ * Pooled class whose arena holds ptr, or -1.
+ *
+ * Needs no lock: a range only ever grows, and the answer is only used to
+ * pick the class lock to take. The zone itself is looked up under it.
+ */
+int arena_class_of(const void *ptr) {
+    for (int type = 0; type < LARGE; type++) {
+        const char *zones = __atomic_load_n(&g_arenas[type].zones, __ATOMIC_ACQUIRE);
+
+        if (zones && (const char *)ptr >= zones
+            && (size_t)((const char *)ptr - zones)
+                   < __atomic_load_n(&g_arenas[type].committed, __ATOMIC_ACQUIRE))
+            return type;
+    }
+    return -1;
+}
+
+/* Zone of the arena of `type` containing ptr, or NULL (caller holds g_zone_locks[type]). */
+static t_zone *arena_zone_of(const t_zone_type type, const void *ptr) {
+    const t_arena *arena = &g_arenas[type];
+
+    if (!arena->zones || (const char *)ptr < arena->zones)
+        return NULL;
+
+    const size_t offset = (size_t)((const char *)ptr - arena->zones);
+    if (offset >= arena->committed)
+        return NULL;
+    return (t_zone *)(arena->zones
+                      + ((size_t)arena->owners[offset >> ARENA_GRANULE_SHIFT] << ARENA_GRANULE_SHIFT));
+}
+
+/*
+ * Zone of the arena ending right below `zone`, or NULL. New arena zones go
+ * right after it in the (address ordered) global list.
+ *
+ * Caller holds g_zone_locks[type].
+ */
+t_zone *arena_zone_below(const t_zone *zone) {
+    if (zone->type == LARGE)
+        return NULL;
+    return arena_zone_of(zone->type, (const char *)zone - 1);
+}
+
+/*
+ * Find the zone of a global class list containing ptr.
+ *
+ * Arena zones are found by offset. Only zones mapped outside the arena
+ * (LARGE, or pooled zones that did not fit) need the list walk, and only
+ * if there are any. *out_prev is only filled by the list walk: arena
+ * zones are never unlinked.
+ *
+ * Caller holds g_zone_locks[type].
+ */
+t_zone *find_class_zone(const t_zone_type type, const void *ptr, t_zone **out_prev) {
+    if (type != LARGE) {
+        t_zone *zone = arena_zone_of(type, ptr);
+
+        if (zone || (g_arenas[type].zones && g_arenas[type].outside == 0))
+            return zone;
+    }
+    return find_zone_for_ptr(g_zones[type], ptr, out_prev);
+}
+
+/*
+ * Block of a global class list whose payload starts at ptr, or NULL.
+ *
+ * For an arena pointer both steps cost O(1): the owner table gives the
+ * zone, block_from_ptr() validates the header in front of ptr. *out_zone
+ * receives the zone containing ptr (NULL if the class has none), so the
+ * caller can tell a foreign pointer from an invalid one. *out_prev
+ * (optional) is filled as by find_class_zone().
+ *
+ * Caller holds g_zone_locks[type].
+ */
+t_block *find_class_block(const t_zone_type type, const void *ptr, t_zone **out_zone,
+                          t_zone **out_prev) {
+    t_zone *zone = find_class_zone(type, ptr, out_prev);
+
+    *out_zone = zone;
+    return zone ? block_from_ptr(zone, ptr) : NULL;
+}
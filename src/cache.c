@@ -0,0 +1,291 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Typed object caches (kmem_cache style).
+ *
+ * A cache serves objects of one size from dedicated slabs: zones of a
+ * private list, built with request_new_zone() like private heaps, sized
+ * for at least MIN_ALLOCS objects and cut into equal slots. A slab is laid
+ * out as a LARGE zone (exact size, never grown): its one block's payload
+ * holds the slab header, then the slots. Every object
+ * is run through the constructor once, when its slab is created. Freed
+ * objects keep their constructed state, so ft_cache_alloc() is a plain pop
+ * from the free list: no header, no search, no re-initialization.
+ *
+ * Slot layout: [object, padded to a word][link word][padding to `align`]
+ * The link word sits outside the object, so parking an object on the free
+ * list never clobbers its constructed state. While the object is handed out
+ * the link holds SLAB_SLOT_USED, which lets ft_cache_free() reject double
+ * frees.
+ *
+ * The destructor runs when the cache is destroyed, on every object that is
+ * back in the cache. Scribble mode is not applied to cache objects: it
+ * would destroy exactly the state the cache exists to preserve.
+ */
+
+#define SLAB_HDR_SIZE  ALIGN_UP(sizeof(t_slab))
+#define SLAB_SLOT_USED ((void *)1)
+
+/* Registry of live caches, for show_alloc_mem_stats(). */
+static t_cache * g_caches    = NULL;
+static t_ft_lock g_cache_reg = FT_LOCK_INITIALIZER;
+
+static size_t align_to(const size_t value, const size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static void **slot_link(const t_cache *cache, void *obj) {
+    return (void **)((char *)obj + cache->link_offset);
+}
+
+static t_slab *zone_slab(const t_zone *zone) {
+    return (t_slab *)((char *)zone->blocks + BLOCK_HDR_SIZE);
+}
+
+/* First slot of a slab before its color: the first cache-aligned address past the header. */
+static char *slab_start(const t_cache *cache, const t_zone *zone) {
+    return (char *)align_to((uintptr_t)zone_slab(zone) + SLAB_HDR_SIZE, cache->align);
+}
+
+/* First object slot of a slab (aligned to the cache alignment, shifted by its color). */
+static char *slab_objects(const t_cache *cache, const t_zone *zone) {
+    return slab_start(cache, zone) + zone_slab(zone)->color;
+}
+
+/*
+ * Color of a new slab: successive slabs shift their slots by one more
+ * cache line (or alignment step, if larger), back to 0 once the shift
+ * would no longer fit in the bytes the slots leave unused (`leftover`).
+ */
+static size_t next_slab_color(t_cache *cache, const size_t leftover) {
+    const size_t step  = align_to(CACHE_LINE_SIZE, cache->align);
+    size_t       color = cache->next_color;
+
+    if (color > leftover || color >= ZONE_COLORS * CACHE_LINE_SIZE)
+        color = 0;
+    cache->next_color = color + step;
+    return color;
+}
+
+/*
+ * Map and construct one slab; all its objects go on the cache free list.
+ * Caller holds cache->lock.
+ */
+static int grow_cache(t_cache *cache) {
+    /* Header, worst-case alignment gap, slots. */
+    const size_t request = SLAB_HDR_SIZE + cache->align + MIN_ALLOCS * cache->stride;
+    t_zone *     zone    = request_new_zone(&cache->slabs, &cache->slab_count, LARGE, request);
+
+    if (!zone) {
+        debug_log_event("cache", NULL, request, "failed: mmap");
+        return 0;
+    }
+
+    t_slab *     slab  = zone_slab(zone);
+    const char * end   = (const char *)slab + block_size(zone->blocks);
+    const size_t room  = (size_t)(end - slab_start(cache, zone));
+
+    slab->capacity = room / cache->stride;
+    slab->color    = next_slab_color(cache, room - slab->capacity * cache->stride);
+    cache->capacity += slab->capacity;
+
+    /* Construct every slot once; push in reverse so the first slot pops first. */
+    char *objects = slab_objects(cache, zone);
+    for (size_t i = slab->capacity; i > 0; i--) {
+        void *obj = objects + (i - 1) * cache->stride;
+
+        if (cache->ctor) {
+            cache->ctor(obj);
+            cache->constructed++;
+        }
+        *slot_link(cache, obj) = cache->free_list;
+        cache->free_list = obj;
+    }
+
+    debug_log_event("cache", zone, zone->size, cache->name);
+    return 1;
+}
+
+t_cache *ft_cache_create(const char *name, size_t size, size_t align,
+                         t_cache_ctor ctor, t_cache_dtor dtor) {
+    if (align == 0)
+        align = MALLOC_ALIGN;
+    if (align < sizeof(void *))
+        align = sizeof(void *);
+
+    /* Slots must stay aligned inside a page-aligned slab. */
+    if (size == 0 || (align & (align - 1)) != 0 || align > (size_t)getpagesize()
+        || size > SIZE_MAX / 2) {
+        debug_log_event("cache_create", NULL, size, "failed: bad size/alignment");
+        return NULL;
+    }
+
+    t_cache *cache = malloc(sizeof(t_cache));
+    if (!cache) {
+        debug_log_event("cache_create", NULL, size, "failed: malloc");
+        return NULL;
+    }
+    ft_memset(cache, 0, sizeof(*cache));
+
+    size_t len = 0;
+    while (name && name[len] && len < sizeof(cache->name) - 1) {
+        cache->name[len] = name[len];
+        len++;
+    }
+
+    cache->object_size = size;
+    cache->align       = align;
+    cache->link_offset = align_to(size, sizeof(void *));
+    cache->stride      = align_to(cache->link_offset + sizeof(void *), align);
+    cache->ctor        = ctor;
+    cache->dtor        = dtor;
+
+    ft_lock(&g_cache_reg);
+    cache->next = g_caches;
+    g_caches = cache;
+    ft_unlock(&g_cache_reg);
+
+    debug_log_event("cache_create", cache, cache->stride, cache->name);
+    return cache;
+}
+
+/* Pop a constructed object; a fresh slab is mapped only when the cache is empty. */
+void *ft_cache_alloc(t_cache *cache) {
+    if (!cache)
+        return NULL;
+
+    ft_lock(&cache->lock);
+
+    if (!cache->free_list) {
+        if (!grow_cache(cache)) {
+            ft_unlock(&cache->lock);
+            return NULL;
+        }
+        SHM_STAT_ADD(caches.misses, 1);
+    } else {
+        SHM_STAT_ADD(caches.hits, 1);
+    }
+
+    void *obj = cache->free_list;
+    cache->free_list = *slot_link(cache, obj);
+    *slot_link(cache, obj) = SLAB_SLOT_USED;
+    cache->in_use++;
+    cache->allocs++;
+
+    ft_unlock(&cache->lock);
+    return obj;
+}
+
+/* Does obj sit exactly at a slot start of one of the cache's slabs? */
+static int owns_object(const t_cache *cache, const void *obj) {
+    for (const t_zone *zone = cache->slabs; zone; zone = zone->next) {
+        const char *objects = slab_objects(cache, zone);
+        const char *end     = objects + zone_slab(zone)->capacity * cache->stride;
+
+        if ((const char *)obj >= objects && (const char *)obj < end)
+            return ((size_t)((const char *)obj - objects) % cache->stride) == 0;
+    }
+    return 0;
+}
+
+/* Give an object back in its constructed state (no destructor call). */
+void ft_cache_free(t_cache *cache, void *obj) {
+    if (!cache || !obj)
+        return;
+
+    ft_lock(&cache->lock);
+
+    if (!owns_object(cache, obj)) {
+        ft_unlock(&cache->lock);
+        debug_log_event("cache_free", obj, 0, "ignored: pointer not owned");
+        return;
+    }
+    if (*slot_link(cache, obj) != SLAB_SLOT_USED) {
+        ft_unlock(&cache->lock);
+        debug_log_event("cache_free", obj, 0, "ignored: double free");
+        return;
+    }
+
+    *slot_link(cache, obj) = cache->free_list;
+    cache->free_list = obj;
+    cache->in_use--;
+    cache->frees++;
+    SHM_STAT_ADD(caches.frees, 1);
+
+    ft_unlock(&cache->lock);
+}
+
+/*
+ * Run the destructor on every cached (free) object and unmap all slab zones.
+ * Objects still handed out are dropped without a destructor call.
+ */
+void ft_cache_destroy(t_cache *cache) {
+    if (!cache)
+        return;
+
+    ft_lock(&g_cache_reg);
+    for (t_cache **pp = &g_caches; *pp; pp = &(*pp)->next) {
+        if (*pp == cache) {
+            *pp = cache->next;
+            break;
+        }
+    }
+    ft_unlock(&g_cache_reg);
+
+    t_zone *zone = cache->slabs;
+    while (zone) {
+        t_zone *     next     = zone->next;
+        char *       objects  = slab_objects(cache, zone);
+        const size_t capacity = zone_slab(zone)->capacity;
+
+        for (size_t i = 0; cache->dtor && i < capacity; i++) {
+            void *obj = objects + i * cache->stride;
+
+            if (*slot_link(cache, obj) != SLAB_SLOT_USED)
+                cache->dtor(obj);
+        }
+        release_zone(zone);
+        zone = next;
+    }
+
+    debug_log_event("cache_destroy", cache, 0, cache->name);
+    free(cache);
+}
+
+/* One stats line per live cache (used by show_alloc_mem_stats). */
+void show_cache_stats(t_outbuf *out) {
+    ft_lock(&g_cache_reg);
+
+    for (t_cache *cache = g_caches; cache; cache = cache->next) {
+        t_cache copy;
+
+        /* Format from a copy: the cache lock is only held for the memcpy. */
+        ft_lock(&cache->lock);
+        ft_memcpy(&copy, cache, sizeof(copy));
+        ft_unlock(&cache->lock);
+
+        outbuf_putstr(out, "CACHE ");
+        outbuf_putstr(out, copy.name[0] ? copy.name : "(anonymous)");
+        outbuf_putstr(out, " : object=");
+        outbuf_putsize(out, copy.object_size);
+        outbuf_putstr(out, " stride=");
+        outbuf_putsize(out, copy.stride);
+        outbuf_putstr(out, " slabs=");
+        outbuf_putsize(out, copy.slab_count);
+        outbuf_putstr(out, " capacity=");
+        outbuf_putsize(out, copy.capacity);
+        outbuf_putstr(out, " in_use=");
+        outbuf_putsize(out, copy.in_use);
+        outbuf_putstr(out, " allocs=");
+        outbuf_putsize(out, copy.allocs);
+        outbuf_putstr(out, " frees=");
+        outbuf_putsize(out, copy.frees);
+        outbuf_putstr(out, " constructed=");
+        outbuf_putsize(out, copy.constructed);
+        outbuf_putchar(out, '\n');
+    }
+
+    ft_unlock(&g_cache_reg);
+}
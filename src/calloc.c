@@ -8,9 +8,10 @@
  * Important details:
  * - detect multiplication overflow before computing total
  * - delegate allocation to our malloc implementation
- * - explicitly memset returned region to 0 for calloc contract
+ * - zero-fill the returned region for calloc contract (skipped for
+ *   fresh LARGE mappings, which are zero already)
  */
-void *calloc(size_t nmemb, size_t size) {
+void *calloc_core(size_t nmemb, size_t size) {
     /* Overflow check for nmemb * size. */
     if (nmemb != 0 && size > SIZE_MAX / nmemb) {
         debug_log_event("calloc", NULL, size, "failed: multiplication overflow");
@@ -20,12 +21,25 @@ void *calloc(size_t nmemb, size_t size) {
     const size_t total_size = nmemb * size;
 
     /* Reuse allocator's central path (alignment, zone selection, etc.). */
-    void *ptr = malloc(total_size);
+    void *ptr = malloc_core(total_size);
+
+    /*
+     * calloc guarantee: every byte is initialized to zero.
+     * LARGE blocks are fresh anonymous mappings the kernel already zeroed
+     * (unless scribble mode just filled them with 0xAA).
+     */
+    const int fresh_mapping = get_zone_type(align_size(total_size)) == LARGE && !g_malloc_scribble;
 
-    /* calloc guarantee: every byte is initialized to zero. */
-    if (ptr)
-        ft_memset(ptr, 0, total_size);
+    if (ptr && !fresh_mapping)
+        mem_fill(ptr, 0, total_size);
 
     debug_log_event("calloc", ptr, total_size, ptr ? "ok" : "failed: malloc");
     return ptr;
 }
+
+/* Public calloc: timed through the latency histograms when they are on. */
+void *calloc(size_t nmemb, size_t size) {
+    if (g_malloc_latency)
+        return latency_calloc(nmemb, size);
+    return calloc_core(nmemb, size);
+}
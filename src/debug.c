@@ -129,7 +129,7 @@ void debug_log_block_split(const t_block *block, size_t requested_size, size_t r
 
 /* Rich placement log to explain where malloc served a request from. */
 void debug_log_malloc_placement(const t_zone *zone, const t_block *block, size_t requested_size,
-                                size_t aligned_size, size_t original_block_size, int from_new_zone)
+                                size_t aligned_size, size_t original_block_size, const char *source)
 {
     char   buffer[320];
     size_t len;
@@ -149,26 +149,62 @@ void debug_log_malloc_placement(const t_zone *zone, const t_block *block, size_t
     len = append_text(buffer, len, " block_before=");
     len = append_size(buffer, len, original_block_size);
     len = append_text(buffer, len, " source=");
-    len = append_text(buffer, len, from_new_zone ? "new-zone" : "reused-free");
+    len = append_text(buffer, len, source);
     buffer[len++] = '\n';
     write(STDERR_FILENO, buffer, len);
 }
 
+/* An env flag is on when the variable is present and not exactly "0". */
+static int env_flag(const char *value)
+{
+    return value && value[0] != '\0' && !(value[0] == '0' && value[1] == '\0');
+}
+
 /*
  * Constructor runs once when the shared library is loaded.
  *
- * Enabled when env var is present and not exactly "0".
+ * Flags are enabled when env var is present and not exactly "0".
+ * MallocWarm takes a size ("64M"); zones are warmed once flags are known.
+ * MallocAsyncUnmap also takes an optional size: the cap on pending bytes.
+ * MallocLayoutDump takes a path: the heap layout is written there at exit.
+ * MallocShmStats starts publishing live stats before the warm-up, so the
+ * warmed zones show up in them.
  */
 void __attribute__((constructor)) init_malloc_debug(void)
 {
     const char *scribble = getenv("MallocScribble");
     const char *debug    = getenv("MallocDebug");
+    const char *prefault = getenv("MallocPrefault");
+    const char *warm     = getenv("MallocWarm");
+    const char *shm      = getenv("MallocShmStats");
+    const char *latency  = getenv("MallocLatency");
+    const char *lockprof = getenv("MallocLockProfile");
+    const char *async    = getenv("MallocAsyncUnmap");
+    const char *hot      = getenv("MallocHotSlabs");
+    const char *layout   = getenv("MallocLayoutDump");
+
+    g_malloc_scribble = env_flag(scribble);
+    g_malloc_debug    = env_flag(debug);
+    g_malloc_prefault = env_flag(prefault);
+
+    if (env_flag(shm))
+        shm_stats_enable();
+    if (env_flag(latency))
+        latency_enable(1);
+    if (env_flag(lockprof))
+        lock_profile_enable(1);
+    if (env_flag(async)) {
+        const size_t cap = parse_byte_size(async);
+
+        async_unmap_enable(1, cap > 1 ? cap : 0);
+    }
+    if (hot && hot[0] == '0' && hot[1] == '\0')
+        hot_slabs_enable(0);
+    if (layout)
+        layout_dump_at_exit(layout);
 
-    g_malloc_scribble = 0;
-    g_malloc_debug    = 0;
+    const size_t warm_bytes = warm ? parse_byte_size(warm) : 0;
 
-    if (scribble && scribble[0] != '\0' && !(scribble[0] == '0' && scribble[1] == '\0'))
-        g_malloc_scribble = 1;
-    if (debug && debug[0] != '\0' && !(debug[0] == '0' && debug[1] == '\0'))
-        g_malloc_debug = 1;
+    if (warm_bytes > 0)
+        malloc_warm(warm_bytes);
 }
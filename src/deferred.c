@@ -0,0 +1,116 @@
+#include "ft_malloc.h"
+
+/*
+ * Recently-freed lists (deferred coalescing).
+ *
+ * A workload that frees and reallocates same-size objects would otherwise
+ * merge a block with its neighbors on free() and split it again on the next
+ * malloc(). Instead, a freed TINY/SMALL block is parked here untouched
+ * (state BLOCK_DEFERRED) and handed back as-is to the next request it fits
+ * without a split.
+ *
+ * Parked blocks are invisible to first-fit and to coalescing. They are
+ * turned back into BLOCK_FREE and merged only when:
+ * - an allocation misses the list, or
+ * - the list grows past DEFERRED_FREE_LIMIT entries.
+ *
+ * The list link lives in the first payload bytes of each parked block.
+ * All functions expect the caller to hold g_zone_locks[type].
+ */
+
+static t_block *g_deferred[ZONE_TYPE_COUNT];
+static size_t   g_deferred_count[ZONE_TYPE_COUNT];
+
+static t_block **payload_link(t_block *block) {
+    return (t_block **)((char *)block + BLOCK_HDR_SIZE);
+}
+
+/* The link overwrote freed bytes: restore the 0x55 free pattern. */
+static void rescribble_link(t_block *block) {
+    if (g_malloc_scribble)
+        ft_memset(payload_link(block), 0x55, sizeof(t_block *));
+}
+
+/*
+ * Turn one parked block back into BLOCK_FREE and merge it with its free
+ * physical neighbors (prev_size finds the left one in O(1)). Blocks still
+ * parked act as barriers; they merge when their own turn comes.
+ * The zone's first-fit hint moves down to the merged block if needed.
+ */
+static void release_parked(const t_zone_type type, t_block *block) {
+    block_set_state(block, BLOCK_FREE);
+    while (block_next(block) && block_state(block_next(block)) == BLOCK_FREE)
+        coalesce_right(block);
+
+    t_block *prev = block_prev(block);
+
+    while (prev && block_state(prev) == BLOCK_FREE) {
+        coalesce_right(prev);
+        block = prev;
+        prev = block_prev(block);
+    }
+
+    t_zone *zone = find_class_zone(type, block, NULL);
+
+    if (zone && block < zone->free_hint)
+        zone->free_hint = block;
+}
+
+/* Park a freed pooled block; flush the list once it grows too long. */
+void defer_block(const t_zone_type type, t_block *block) {
+    block_set_state(block, BLOCK_DEFERRED);
+    *payload_link(block) = g_deferred[type];
+    g_deferred[type] = block;
+
+    if (++g_deferred_count[type] > DEFERRED_FREE_LIMIT)
+        flush_deferred_blocks(type);
+}
+
+/*
+ * Pop a parked block that fits `size` without needing a split,
+ * i.e. one that malloc would hand out whole anyway.
+ *
+ * The returned block is already marked BLOCK_USED.
+ */
+t_block *take_deferred_block(const t_zone_type type, const size_t size) {
+    t_block **link = &g_deferred[type];
+
+    while (*link) {
+        t_block *block = *link;
+
+        if (block_size(block) >= size && block_size(block) < size + BLOCK_HDR_SIZE + MALLOC_ALIGN) {
+            *link = *payload_link(block);
+            g_deferred_count[type]--;
+            rescribble_link(block);
+            block_set_state(block, BLOCK_USED);
+            return block;
+        }
+        link = payload_link(block);
+    }
+    return NULL;
+}
+
+/*
+ * Release every parked block of a class back to the regular free state,
+ * merged with its neighbors. Only the parked blocks and the blocks next to
+ * them are visited: the cost is bounded by DEFERRED_FREE_LIMIT, not by the
+ * size of the heap.
+ */
+void flush_deferred_blocks(const t_zone_type type) {
+    t_block *block = g_deferred[type];
+
+    if (!block)
+        return;
+
+    debug_log_event("flush", NULL, g_deferred_count[type], "deferred blocks");
+
+    while (block) {
+        t_block *next = *payload_link(block);
+
+        rescribble_link(block);
+        release_parked(type, block);
+        block = next;
+    }
+    g_deferred[type] = NULL;
+    g_deferred_count[type] = 0;
+}
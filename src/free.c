@@ -4,131 +4,140 @@
  * Merge current block with its immediate right neighbor.
  *
  * Preconditions for merge:
- * - current->next exists
+ * - a next block exists (the zone fence is never free)
  * - that next block is free
  */
 void coalesce_right(t_block *current) {
-    const t_block *next_block = current->next;
+    const t_block *next_block = block_next(current);
 
-    if (next_block && next_block->free) {
+    if (next_block && block_state(next_block) == BLOCK_FREE) {
         /* Payload grows by: next payload + next header now reclaimed. */
-        current->size += BLOCK_HDR_SIZE + next_block->size;
+        const size_t merged_size = block_size(current) + BLOCK_HDR_SIZE + block_size(next_block);
 
-        /* Skip merged node in linked list. */
-        current->next = next_block->next;
+        block_set_size(current, merged_size);
 
-        debug_log_block_merge(current, next_block, current->size);
+        /* The block after the merged one must now point back to current. */
+        block_after(current)->prev_size = merged_size;
+
+        debug_log_block_merge(current, next_block, merged_size);
     }
 }
 
 /*
- * Free path dedicated to LARGE zones.
+ * Core free implementation for one class (caller holds g_zone_locks[type]).
+ *
+ * Returns 1 when ptr falls inside a zone of this class (the request was
+ * handled, even if it was rejected), 0 when this class does not own it.
  *
- * LARGE allocations are mapped independently, so we must:
- * 1) unlink zone from global list
- * 2) munmap entire zone in one operation
+ * LARGE allocations are mapped independently: under the lock we only
+ * unlink the zone and hand it back through *unmap_zone, so the caller can
+ * munmap() it once the lock has been released.
+ *
+ * Validation strategy:
+ * - pointer inside zone but not block start: ignore
+ * - double free: ignore
  */
-static void free_large_zone(t_zone *zone, t_zone *prev_zone) {
-    if (prev_zone)
-        prev_zone->next = zone->next;
-    else
-        g_zones = zone->next;
+int free_nolock(const t_zone_type type, void *ptr, t_zone **unmap_zone) {
+    t_zone * prev_zone = NULL;
+    t_zone * zone      = NULL;
+    t_block *block     = find_class_block(type, ptr, &zone, &prev_zone);
+
+    if (!zone)
+        return 0;
+
+    /*
+     * Pointer lands inside zone mapping but is not a valid block start.
+     * Example: free(ptr + 1) or free(middle_of_payload).
+     */
+    if (!block) {
+        debug_log_event("free", ptr, 0, "ignored: invalid pointer");
+        return 1;
+    }
+
+    /* Already free => double free attempt. */
+    if (block_state(block) != BLOCK_USED) {
+        debug_log_event("free", ptr, 0, "ignored: double free");
+        return 1;
+    }
 
-    munmap(zone, zone->size);
+    /* Optional debug mode: poison released bytes with 0x55. */
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0x55, block_size(block));
+
+    SHM_STAT_ADD(classes[type].frees, 1);
+    SHM_STAT_SUB(classes[type].bytes_in_use, block_size(block));
+
+    /* Dedicated unmap path for LARGE blocks. */
+    if (zone->type == LARGE) {
+        debug_log_event("free", ptr, block_size(block), "large");
+        unlink_zone(&g_zones[LARGE], zone, prev_zone);
+        *unmap_zone = zone;
+        return 1;
+    }
+
+    /* MEDIUM blocks go straight back to the TLSF index, merged with free neighbors. */
+    if (type == MEDIUM) {
+        debug_log_event("free", ptr, block_size(block), "medium");
+        medium_free_nolock(block);
+        return 1;
+    }
+
+    /* Slab slots go straight back to their slab. */
+    if (zone->hot) {
+        debug_log_event("free", ptr, block_size(block), "hot slab");
+        hot_slab_free(zone, block);
+        return 1;
+    }
+
+    /*
+     * Park the block as-is: a same-size malloc will take it back without
+     * any split, and coalescing is postponed until the recently-freed list
+     * is flushed.
+     */
+    debug_log_event("free", ptr, block_size(block), "deferred");
+    defer_block(type, block);
+    return 1;
 }
 
 /*
- * Core free implementation (expects caller already holds g_mutex).
+ * free body; returns the class that owned ptr, or -1.
  *
- * Validation strategy:
- * - null pointer: ignore
- * - unknown pointer: ignore
- * - pointer inside zone but not block start: ignore
- * - double free: ignore
+ * A pointer inside a class arena names its class by address alone, so only
+ * that class is locked. Other pointers (LARGE, zones mapped outside the
+ * arenas) probe the classes one at a time, each under its own lock only.
+ * A LARGE zone is munmap()'d after its lock has been dropped (or handed
+ * to the reclaimer thread, see reclaim.c).
  */
-void free_nolock(void *ptr) {
+int free_core(void *ptr) {
     if (!ptr) {
         debug_log_event("free", NULL, 0, "ignored: null pointer");
-        return;
+        return -1;
     }
 
-    t_zone *zone      = g_zones;
-    t_zone *prev_zone = NULL;
-
-    while (zone) {
-        char *zone_start = (char *)zone;
-        char *zone_end   = zone_start + zone->size;
-
-        /*
-         * Fast range filter:
-         * if ptr is outside this zone address range, skip block scan entirely.
-         */
-        if ((char *)ptr >= zone_start && (char *)ptr < zone_end) {
-            t_block *block      = zone->blocks;
-            t_block *prev_block = NULL;
-
-            while (block) {
-                /* Valid user pointer for this block = header + BLOCK_HDR_SIZE. */
-                const void *data_ptr = (char *)block + BLOCK_HDR_SIZE;
-
-                if (data_ptr == ptr) {
-                    /* Already free => double free attempt. */
-                    if (block->free) {
-                        debug_log_event("free", ptr, 0, "ignored: double free");
-                        return;
-                    }
-
-                    /* Optional debug mode: poison released bytes with 0x55. */
-                    if (g_malloc_scribble)
-                        ft_memset(ptr, 0x55, block->size);
-
-                    /* Dedicated unmap path for LARGE blocks. */
-                    if (zone->type == LARGE) {
-                        debug_log_event("free", ptr, block->size, "large");
-                        free_large_zone(zone, prev_zone);
-                        return;
-                    }
-
-                    /* Mark reusable and reduce fragmentation via coalescing. */
-                    block->free = 1;
-
-                    /* Step 1: merge right if possible. */
-                    coalesce_right(block);
-
-                    /*
-                     * Step 2: merge left (by merging previous block rightward)
-                     * when previous block is also free.
-                     */
-                    if (prev_block && prev_block->free)
-                        coalesce_right(prev_block);
-
-                    debug_log_event("free", ptr, block->size, "zone");
-                    return;
-                }
-
-                prev_block = block;
-                block = block->next;
-            }
-
-            /*
-             * Pointer lands inside zone mapping but is not a valid block start.
-             * Example: free(ptr + 1) or free(middle_of_payload).
-             */
-            debug_log_event("free", ptr, 0, "ignored: invalid pointer");
-            return;
-        }
-
-        prev_zone = zone;
-        zone = zone->next;
+    const int arena_type = arena_class_of(ptr);
+
+    for (int type = arena_type >= 0 ? arena_type : 0; type < ZONE_TYPE_COUNT; type++) {
+        t_zone *unmap_zone = NULL;
+
+        lock_zone_class((t_zone_type)type);
+        const int owned = free_nolock((t_zone_type)type, ptr, &unmap_zone);
+        unlock_zone_class((t_zone_type)type);
+
+        if (unmap_zone)
+            release_large_zone(unmap_zone);
+        if (owned)
+            return type;
     }
 
     /* No zone owned this pointer. */
     debug_log_event("free", ptr, 0, "ignored: pointer not owned");
+    return -1;
 }
 
-/* Public free wrapper: lock -> core logic -> unlock. */
+/* Public free: timed through the latency histograms when they are on. */
 void free(void *ptr) {
-    pthread_mutex_lock(&g_mutex);
-    free_nolock(ptr);
-    pthread_mutex_unlock(&g_mutex);
+    if (g_malloc_latency)
+        latency_free(ptr);
+    else
+        free_core(ptr);
 }
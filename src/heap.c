@@ -0,0 +1,148 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Private heaps.
+ *
+ * A heap owns its own per-class zone lists, built with request_new_zone()
+ * exactly like the global ones but never published in g_zones. Typical use
+ * is "allocate many objects, drop them all at once": ft_heap_destroy()
+ * unmaps every zone in one pass, without visiting a single block.
+ *
+ * No locking at all: a heap is meant to be used by one thread at a time.
+ * Callers sharing a heap between threads must serialize access themselves.
+ * Pointers from a heap must only be released with ft_heap_free() (or by
+ * destroying the heap); free() does not know about heap zones.
+ */
+
+t_heap *ft_heap_create(void) {
+    t_heap *heap = malloc(sizeof(t_heap));
+
+    if (!heap) {
+        debug_log_event("heap_create", NULL, 0, "failed: malloc");
+        return NULL;
+    }
+    ft_memset(heap, 0, sizeof(*heap));
+
+    debug_log_event("heap_create", heap, 0, "ok");
+    return heap;
+}
+
+/*
+ * Same placement policy as malloc(): first-fit in the heap's zones of the
+ * matching class, fresh zone otherwise, split pooled blocks when useful.
+ * MEDIUM blocks use first-fit too: the TLSF index only covers g_zones.
+ */
+void *ft_heap_malloc(t_heap *heap, size_t size) {
+    if (!heap)
+        return NULL;
+
+    const size_t requested_size = size == 0 ? (size_t)1u : size;
+
+    /* Prevent wraparound before alignment math. */
+    if (requested_size > SIZE_MAX - (size_t)15u) {
+        debug_log_event("heap_malloc", NULL, requested_size, "failed: size overflow");
+        return NULL;
+    }
+
+    const size_t      aligned_size = align_size(requested_size);
+    const t_zone_type type         = get_zone_type(aligned_size);
+    t_zone *          zone         = NULL;
+    t_block *         block        = NULL;
+
+    /* LARGE blocks always get a dedicated zone, never a reused one. */
+    if (type != LARGE)
+        block = find_free_block(heap->zones[type], aligned_size, &zone);
+
+    if (!block) {
+        zone = request_new_zone(&heap->zones[type], &heap->zone_counts[type], type,
+                                aligned_size);
+        if (!zone) {
+            debug_log_event("heap_malloc", NULL, aligned_size, "failed: mmap");
+            return NULL;
+        }
+        block = zone->blocks;
+    }
+
+    if (type != LARGE)
+        split_block(block, aligned_size);
+
+    void *ptr = (void *)((char *)block + BLOCK_HDR_SIZE);
+
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, requested_size);
+
+    debug_log_event("heap_malloc", ptr, requested_size, type == LARGE ? "large" : "zone");
+    return ptr;
+}
+
+/*
+ * Release one block of a heap.
+ *
+ * Pooled blocks are coalesced right away: heaps have no recently-freed
+ * list, since their objects are usually dropped in bulk by ft_heap_destroy().
+ */
+void ft_heap_free(t_heap *heap, void *ptr) {
+    if (!heap || !ptr)
+        return;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        t_zone *prev_zone = NULL;
+        t_zone *zone      = find_zone_for_ptr(heap->zones[type], ptr, &prev_zone);
+
+        if (!zone)
+            continue;
+
+        t_block *block = block_from_ptr(zone, ptr);
+
+        if (!block || block_state(block) != BLOCK_USED) {
+            debug_log_event("heap_free", ptr, 0,
+                            block ? "ignored: double free" : "ignored: invalid pointer");
+            return;
+        }
+
+        if (g_malloc_scribble)
+            mem_fill(ptr, 0x55, block_size(block));
+
+        debug_log_event("heap_free", ptr, block_size(block), type == LARGE ? "large" : "zone");
+
+        if (type == LARGE) {
+            unlink_zone(&heap->zones[LARGE], zone, prev_zone);
+            release_zone(zone);
+            return;
+        }
+
+        block_set_state(block, BLOCK_FREE);
+        if (block < zone->free_hint)
+            zone->free_hint = block;
+        coalesce_right(block);
+
+        t_block *prev_block = block_prev(block);
+        if (prev_block && block_state(prev_block) == BLOCK_FREE)
+            coalesce_right(prev_block);
+        return;
+    }
+
+    debug_log_event("heap_free", ptr, 0, "ignored: pointer not owned");
+}
+
+/* Unmap every zone of the heap in one pass, then drop the handle. */
+void ft_heap_destroy(t_heap *heap) {
+    if (!heap)
+        return;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        t_zone *zone = heap->zones[type];
+
+        while (zone) {
+            t_zone *next = zone->next;
+
+            release_zone(zone);
+            zone = next;
+        }
+    }
+
+    debug_log_event("heap_destroy", heap, 0, "ok");
+    free(heap);
+}
@@ -0,0 +1,370 @@
+#include "ft_malloc.h"
+
+/*
+ * Adaptive hot-size slabs.
+ *
+ * Request sizes are spiky: a handful of exact sizes usually make most of
+ * a program's allocations, and which ones depends on the program.
+ * malloc_nolock() samples one TINY/SMALL request in HOT_SAMPLE_PERIOD into
+ * a small per-class size table. At the end of every epoch
+ * (HOT_EPOCH_SAMPLES samples):
+ * - a size seen in at least 1/HOT_PROMOTE_SHARE of the samples becomes hot
+ *   (up to HOT_SIZES_MAX per class)
+ * - a hot size seen in less than 1/HOT_COOL_SHARE of the samples for
+ *   HOT_COOL_EPOCHS epochs in a row is retired
+ *
+ * A hot size is served from slab zones: ordinary zones of the class (same
+ * arena, same free() / realloc() / show_alloc_mem() paths) carved up front
+ * into back to back blocks of exactly that size. Each slab keeps its own
+ * free slots; the size links the slabs that have one. malloc pops a slot
+ * from the first of them (no first-fit search, no split), free pushes it
+ * back onto its slab (no coalescing). Free slots are BLOCK_DEFERRED, so
+ * first-fit, coalescing and double-free checks leave them alone; their
+ * first payload word links the next free slot of the slab.
+ *
+ * A retired size stops handing out slots. Each of its slab zones turns back
+ * into an ordinary zone (one free block) once its last slot is freed; all
+ * its slots are then free, so it only leaves the size's slab list.
+ *
+ * Turned on by default; MallocHotSlabs=0 or mallopt(M_FT_HOT_SLABS, 0)
+ * turn it off (and retire every hot size). All functions but the switch
+ * and the report expect the caller to hold g_zone_locks[type].
+ */
+
+#define HOT_SAMPLE_PERIOD 16  /* One request in 16 is sampled. */
+#define HOT_TABLE_SIZE    16  /* Candidate sizes tracked per class. */
+#define HOT_EPOCH_SAMPLES 256 /* Samples per decision round. */
+#define HOT_PROMOTE_SHARE 8   /* Hot from 1/8 of the samples (12.5%). */
+#define HOT_COOL_SHARE    64  /* Cold below 1/64 of the samples... */
+#define HOT_COOL_EPOCHS   4   /* ...for this many epochs in a row. */
+#define HOT_SIZES_MAX     8   /* Hot sizes per class. */
+
+typedef struct s_hot_candidate {
+    size_t size;
+    size_t hits; /* Samples of this size in the current epoch. */
+} t_hot_candidate;
+
+struct s_hot_size {
+    size_t   size;        /* Payload size of every slot, 0 if the entry is unused. */
+    t_zone * partial;     /* Slab zones with a free slot. */
+    size_t   zones;       /* Slab zones owned. */
+    size_t   live;        /* Slots handed out. */
+    size_t   free_slots;
+    size_t   cold_epochs; /* Cold epochs in a row. */
+    int      retired;     /* No more slots handed out; zones go back when empty. */
+};
+
+typedef struct s_hot_class {
+    size_t          countdown; /* Requests until the next sample. */
+    size_t          samples;   /* Samples in the current epoch. */
+    t_hot_candidate table[HOT_TABLE_SIZE];
+    t_hot_size      sizes[HOT_SIZES_MAX];
+} t_hot_class;
+
+int g_hot_slabs = 1;
+
+/* TINY and SMALL only: MEDIUM has its own O(1) index. */
+static t_hot_class g_hot[MEDIUM];
+
+static const char *g_hot_class_names[MEDIUM] = {"TINY", "SMALL"};
+
+static t_block **slot_next(t_block *block) {
+    return (t_block **)((char *)block + BLOCK_HDR_SIZE);
+}
+
+/* The link overwrote freed bytes: restore the 0x55 free pattern. */
+static void rescribble_link(t_block *block) {
+    if (g_malloc_scribble)
+        ft_memset(slot_next(block), 0x55, sizeof(t_block *));
+}
+
+/* A slab gained its first free slot. */
+static void link_partial(t_hot_size *hot, t_zone *zone) {
+    zone->hot_prev = NULL;
+    zone->hot_next = hot->partial;
+    if (hot->partial)
+        hot->partial->hot_prev = zone;
+    hot->partial = zone;
+}
+
+/* A slab has no free slot left, or goes back to its class. */
+static void unlink_partial(t_hot_size *hot, t_zone *zone) {
+    if (zone->hot_prev)
+        zone->hot_prev->hot_next = zone->hot_next;
+    else
+        hot->partial = zone->hot_next;
+    if (zone->hot_next)
+        zone->hot_next->hot_prev = zone->hot_prev;
+    zone->hot_next = NULL;
+    zone->hot_prev = NULL;
+}
+
+static t_hot_size *find_hot(t_hot_class *hot, const size_t size) {
+    for (int i = 0; i < HOT_SIZES_MAX; i++)
+        if (hot->sizes[i].size == size)
+            return &hot->sizes[i];
+    return NULL;
+}
+
+/* End of the fence-delimited block area of a zone. */
+static t_block *zone_fence(const t_zone *zone) {
+    return (t_block *)((char *)zone + zone->size - BLOCK_HDR_SIZE);
+}
+
+/*
+ * Map a slab zone for `hot` and carve it into slots of exactly hot->size
+ * bytes; the last slot also takes what is left before the fence.
+ */
+static int grow_slab(const t_zone_type type, t_hot_size *hot) {
+    t_zone *zone = request_slab_zone(type, hot->size);
+
+    if (!zone)
+        return 0;
+
+    t_block *    fence  = zone_fence(zone);
+    const size_t stride = hot->size + BLOCK_HDR_SIZE;
+    const size_t count  = (size_t)((char *)fence - (char *)zone->blocks) / stride;
+    t_block *    block  = zone->blocks;
+    t_block **   tail   = &zone->hot_free;
+    size_t       prev   = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const size_t size = i + 1 < count ? hot->size
+                                          : (size_t)((char *)fence - (char *)block) - BLOCK_HDR_SIZE;
+
+        block_init(block, prev, size, type, BLOCK_DEFERRED);
+        *tail = block;
+        tail = slot_next(block);
+        prev = size;
+        block = block_after(block);
+    }
+    *tail = NULL;
+    fence->prev_size = prev;
+
+    zone->hot = hot;
+    zone->hot_live = 0;
+    link_partial(hot, zone);
+    hot->zones++;
+    hot->free_slots += count;
+    debug_log_event("hot_slab", zone, hot->size, "new slab");
+    return 1;
+}
+
+/*
+ * Give an empty slab zone back to its class as an ordinary zone. Every
+ * slot is free, so the slab only leaves the size's list: no slot is visited.
+ */
+static void release_slab(t_zone *zone) {
+    t_hot_size * hot    = zone->hot;
+    t_block *    fence  = zone_fence(zone);
+    const size_t stride = hot->size + BLOCK_HDR_SIZE;
+    const size_t size   = (size_t)((char *)fence - (char *)zone->blocks) - BLOCK_HDR_SIZE;
+
+    unlink_partial(hot, zone);
+    hot->free_slots -= (size_t)((char *)fence - (char *)zone->blocks) / stride;
+
+    block_init(zone->blocks, 0, size, zone->type, BLOCK_FREE);
+    fence->prev_size = size;
+    zone->free_hint = zone->blocks;
+    zone->hot = NULL;
+    zone->hot_free = NULL;
+
+    debug_log_event("hot_slab", zone, hot->size, "slab released");
+    if (--hot->zones == 0)
+        ft_memset(hot, 0, sizeof(*hot));
+}
+
+/* Stop handing out slots of a size; its empty slabs go back right away. */
+static void retire_size(t_hot_size *hot) {
+    hot->retired = 1;
+    debug_log_event("hot_slab", NULL, hot->size, "size retired");
+
+    /* An empty slab has free slots: it is on the list. */
+    t_zone *zone = hot->partial;
+
+    while (zone && hot->size != 0) {
+        t_zone *next = zone->hot_next;
+
+        if (zone->hot_live == 0)
+            release_slab(zone);
+        zone = next;
+    }
+    if (hot->size != 0 && hot->zones == 0)
+        ft_memset(hot, 0, sizeof(*hot));
+}
+
+static size_t candidate_hits(const t_hot_class *hot, const size_t size) {
+    for (int i = 0; i < HOT_TABLE_SIZE; i++)
+        if (hot->table[i].size == size)
+            return hot->table[i].hits;
+    return 0;
+}
+
+/* Decision round: cool down idle hot sizes, then promote popular ones. */
+static void end_epoch(t_hot_class *hot) {
+    for (int i = 0; i < HOT_SIZES_MAX; i++) {
+        t_hot_size *entry = &hot->sizes[i];
+
+        if (entry->size == 0 || entry->retired)
+            continue;
+        if (candidate_hits(hot, entry->size) * HOT_COOL_SHARE >= hot->samples)
+            entry->cold_epochs = 0;
+        else if (++entry->cold_epochs >= HOT_COOL_EPOCHS)
+            retire_size(entry);
+    }
+
+    for (int i = 0; i < HOT_TABLE_SIZE; i++) {
+        const t_hot_candidate *candidate = &hot->table[i];
+
+        if (candidate->size == 0 || candidate->hits * HOT_PROMOTE_SHARE < hot->samples)
+            continue;
+
+        t_hot_size *entry = find_hot(hot, candidate->size);
+
+        /* Hot again before its last slab went back: keep using it. */
+        if (entry) {
+            entry->retired = 0;
+            entry->cold_epochs = 0;
+            continue;
+        }
+        entry = find_hot(hot, 0);
+        if (!entry)
+            break;
+        entry->size = candidate->size;
+        debug_log_event("hot_slab", NULL, entry->size, "size promoted");
+    }
+
+    ft_memset(hot->table, 0, sizeof(hot->table));
+    hot->samples = 0;
+}
+
+/* Count one sampled request; a new size takes over the least seen entry. */
+static void record_sample(t_hot_class *hot, const size_t size) {
+    t_hot_candidate *victim = &hot->table[0];
+    int              found  = 0;
+
+    for (int i = 0; i < HOT_TABLE_SIZE && !found; i++) {
+        if (hot->table[i].size == size) {
+            hot->table[i].hits++;
+            found = 1;
+        } else if (hot->table[i].hits < victim->hits) {
+            victim = &hot->table[i];
+        }
+    }
+    if (!found) {
+        victim->size = size;
+        victim->hits = 1;
+    }
+    if (++hot->samples >= HOT_EPOCH_SAMPLES)
+        end_epoch(hot);
+}
+
+/*
+ * Sample the request, then pop a slot if `size` is hot. Returns a block
+ * already marked BLOCK_USED, or NULL to take the regular path.
+ */
+t_block *hot_slab_alloc(const t_zone_type type, const size_t size) {
+    t_hot_class *hot = &g_hot[type];
+
+    if (hot->countdown == 0) {
+        hot->countdown = HOT_SAMPLE_PERIOD;
+        record_sample(hot, size);
+    }
+    hot->countdown--;
+
+    t_hot_size *entry = find_hot(hot, size);
+
+    if (!entry || entry->retired || (!entry->partial && !grow_slab(type, entry)))
+        return NULL;
+
+    t_zone * zone  = entry->partial;
+    t_block *block = zone->hot_free;
+
+    zone->hot_free = *slot_next(block);
+    if (!zone->hot_free)
+        unlink_partial(entry, zone);
+    rescribble_link(block);
+    block_set_state(block, BLOCK_USED);
+    zone->hot_live++;
+    entry->live++;
+    entry->free_slots--;
+    return block;
+}
+
+/* Take back a used slot of a slab zone (free() has validated it). */
+void hot_slab_free(t_zone *zone, t_block *block) {
+    t_hot_size *hot = zone->hot;
+
+    block_set_state(block, BLOCK_DEFERRED);
+    if (!zone->hot_free)
+        link_partial(hot, zone);
+    *slot_next(block) = zone->hot_free;
+    zone->hot_free = block;
+    zone->hot_live--;
+    hot->live--;
+    hot->free_slots++;
+
+    if (hot->retired && zone->hot_live == 0)
+        release_slab(zone);
+}
+
+/* Slot whose payload starts at ptr, or NULL: slots sit at a fixed stride. */
+t_block *hot_slab_block(const t_zone *zone, const void *ptr) {
+    const size_t stride = zone->hot->size + BLOCK_HDR_SIZE;
+    const char * first  = (const char *)zone->blocks + BLOCK_HDR_SIZE;
+    const size_t count  = (size_t)((char *)zone_fence(zone) - (char *)zone->blocks) / stride;
+
+    if ((const char *)ptr < first)
+        return NULL;
+
+    const size_t offset = (size_t)((const char *)ptr - first);
+
+    if (offset % stride != 0 || offset / stride >= count)
+        return NULL;
+    return (t_block *)((char *)ptr - BLOCK_HDR_SIZE);
+}
+
+/* Turn hot-size slabs on or off; off retires every hot size. Returns 1. */
+int hot_slabs_enable(const int enable) {
+    g_hot_slabs = enable != 0;
+    if (!enable) {
+        for (int type = 0; type < MEDIUM; type++) {
+            lock_zone_class((t_zone_type)type);
+            for (int i = 0; i < HOT_SIZES_MAX; i++)
+                if (g_hot[type].sizes[i].size != 0 && !g_hot[type].sizes[i].retired)
+                    retire_size(&g_hot[type].sizes[i]);
+            unlock_zone_class((t_zone_type)type);
+        }
+    }
+    debug_log_event("hot_slabs", NULL, (size_t)enable, enable ? "on" : "off");
+    return 1;
+}
+
+/* One line per hot (or retiring) size; each class is copied under its lock. */
+void show_hot_slab_stats(t_outbuf *out) {
+    t_hot_size sizes[HOT_SIZES_MAX];
+
+    for (int type = 0; type < MEDIUM; type++) {
+        lock_zone_class((t_zone_type)type);
+        ft_memcpy(sizes, g_hot[type].sizes, sizeof(sizes));
+        unlock_zone_class((t_zone_type)type);
+
+        for (int i = 0; i < HOT_SIZES_MAX; i++) {
+            if (sizes[i].size == 0)
+                continue;
+            outbuf_putstr(out, "HOT SLAB ");
+            outbuf_putstr(out, g_hot_class_names[type]);
+            outbuf_putchar(out, ' ');
+            outbuf_putsize(out, sizes[i].size);
+            outbuf_putstr(out, " bytes : slabs=");
+            outbuf_putsize(out, sizes[i].zones);
+            outbuf_putstr(out, " live=");
+            outbuf_putsize(out, sizes[i].live);
+            outbuf_putstr(out, " free=");
+            outbuf_putsize(out, sizes[i].free_slots);
+            if (sizes[i].retired)
+                outbuf_putstr(out, " (retired)");
+            outbuf_putchar(out, '\n');
+        }
+    }
+}
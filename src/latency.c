@@ -0,0 +1,285 @@
+#include <stdint.h>
+#include <time.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Per-operation latency histograms.
+ *
+ * Averages hide the tail: a malloc() that has to mmap() a zone or a free()
+ * that walks a long zone costs 100x a normal one. When enabled
+ * (MallocLatency=1 or mallopt(M_FT_LATENCY, 1)), malloc, free, realloc and
+ * calloc are timed with CLOCK_MONOTONIC and counted into log-linear (HDR
+ * style) histograms, one set per thread, split by:
+ * - operation
+ * - size class
+ * - path: "slow" when the call mapped or unmapped a zone, "fast" otherwise
+ *
+ * Buckets: values below LAT_SUB_COUNT ns get one bucket each; above that,
+ * every power of two is cut into LAT_SUB_COUNT linear steps, so a bucket
+ * is never wider than 1/LAT_SUB_COUNT of its values (12.5%).
+ *
+ * Only the owning thread writes its histograms (plain increments, no
+ * atomics). Reports add all threads together on demand; while threads are
+ * running the totals are approximate, which is fine for percentiles.
+ * A thread's set is handed over to the next new thread when it exits, so
+ * memory stays bounded by the peak thread count.
+ *
+ * With the feature off, the public entry points pay one predictable branch
+ * on g_malloc_latency and nothing else.
+ */
+
+#define LAT_SUB_BITS  3
+#define LAT_SUB_COUNT (1 << LAT_SUB_BITS)
+#define LAT_MAX_MSB   40 /* 2^40 ns (~18 min): longer samples land in the last bucket. */
+#define LAT_BUCKETS   ((LAT_MAX_MSB - LAT_SUB_BITS + 2) * LAT_SUB_COUNT)
+#define LAT_PATHS     2  /* 0 = fast, 1 = slow. */
+
+typedef enum e_lat_op {
+    LAT_MALLOC,
+    LAT_FREE,
+    LAT_REALLOC,
+    LAT_CALLOC,
+    LAT_OP_COUNT
+} t_lat_op;
+
+typedef struct s_lat_hist {
+    uint64_t count;
+    uint64_t max;
+    uint64_t buckets[LAT_BUCKETS];
+} t_lat_hist;
+
+/* All histograms of one thread, in one private mapping. */
+typedef struct s_lat_set {
+    struct s_lat_set *next;  /* Registry link (sets are never unmapped). */
+    int               owned; /* 1 while a live thread records into it. */
+    t_lat_hist        hist[LAT_OP_COUNT][ZONE_TYPE_COUNT][LAT_PATHS];
+} t_lat_set;
+
+int g_malloc_latency = 0;
+
+/* Set by map_zone() / release_zone(): the current call took the slow path. */
+__thread int t_latency_slow __attribute__((tls_model("initial-exec"))) = 0;
+
+static __thread t_lat_set *t_lat_own __attribute__((tls_model("initial-exec"))) = NULL;
+
+static t_lat_set *    g_lat_sets      = NULL;
+static t_ft_lock      g_lat_lock      = FT_LOCK_INITIALIZER;
+static pthread_key_t  g_lat_key;
+static int            g_lat_key_ready = 0;
+
+static const char *g_lat_op_names[LAT_OP_COUNT] = {"malloc", "free", "realloc", "calloc"};
+static const char *g_lat_class_names[ZONE_TYPE_COUNT] = {"TINY", "SMALL", "MEDIUM", "LARGE"};
+
+/* Monotonic clock in ns (vDSO, no syscall); shared with the lock profiler. */
+uint64_t monotonic_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t bucket_index(const uint64_t value) {
+    if (value < LAT_SUB_COUNT)
+        return (size_t)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    if (msb > LAT_MAX_MSB)
+        return LAT_BUCKETS - 1;
+
+    const size_t sub = (size_t)(value >> (msb - LAT_SUB_BITS)) & (LAT_SUB_COUNT - 1);
+    return (size_t)(msb - LAT_SUB_BITS + 1) * LAT_SUB_COUNT + sub;
+}
+
+/* Highest value that falls into a bucket (percentiles are reported conservatively). */
+static uint64_t bucket_upper(const size_t index) {
+    if (index < LAT_SUB_COUNT)
+        return index;
+
+    const size_t   shift = index / LAT_SUB_COUNT - 1;
+    const uint64_t lower = (uint64_t)(LAT_SUB_COUNT + index % LAT_SUB_COUNT) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+/* Thread exit: leave the set (and its samples) to the next new thread. */
+static void release_set(void *set) {
+    __atomic_store_n(&((t_lat_set *)set)->owned, 0, __ATOMIC_RELEASE);
+}
+
+/* The calling thread's set: a released one if any, else a fresh mapping. */
+static t_lat_set *own_set(void) {
+    t_lat_set *set;
+
+    ft_lock(&g_lat_lock);
+    for (set = g_lat_sets; set; set = set->next)
+        if (!__atomic_load_n(&set->owned, __ATOMIC_ACQUIRE))
+            break;
+
+    if (!set) {
+        set = mmap(NULL, sizeof(t_lat_set), PROT_READ | PROT_WRITE,
+                   MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        if (set == MAP_FAILED) {
+            ft_unlock(&g_lat_lock);
+            return NULL;
+        }
+        set->next = g_lat_sets;
+        g_lat_sets = set;
+    }
+    set->owned = 1;
+    ft_unlock(&g_lat_lock);
+
+    /* Before pthread_setspecific(), which may calloc() back into us. */
+    t_lat_own = set;
+    if (g_lat_key_ready)
+        pthread_setspecific(g_lat_key, set);
+    return set;
+}
+
+static void record(const t_lat_op op, const int type, const uint64_t start) {
+    const uint64_t elapsed = monotonic_ns() - start;
+    t_lat_set *    set     = t_lat_own ? t_lat_own : own_set();
+
+    if (!set || type < 0)
+        return;
+
+    t_lat_hist *hist = &set->hist[op][type][t_latency_slow ? 1 : 0];
+
+    hist->count++;
+    hist->buckets[bucket_index(elapsed)]++;
+    if (elapsed > hist->max)
+        hist->max = elapsed;
+}
+
+/* Size class of a request, as malloc() would pick it. */
+static int request_class(const size_t size) {
+    if (size > SIZE_MAX - (size_t)15u)
+        return LARGE;
+    return get_zone_type(align_size(size == 0 ? 1 : size));
+}
+
+void *latency_malloc(const size_t size) {
+    t_latency_slow = 0;
+    const uint64_t start = monotonic_ns();
+    void *         ptr   = malloc_core(size);
+
+    record(LAT_MALLOC, request_class(size), start);
+    return ptr;
+}
+
+void latency_free(void *ptr) {
+    t_latency_slow = 0;
+    const uint64_t start = monotonic_ns();
+    const int      type  = free_core(ptr);
+
+    record(LAT_FREE, type, start);
+}
+
+void *latency_realloc(void *ptr, const size_t size) {
+    t_latency_slow = 0;
+    const uint64_t start  = monotonic_ns();
+    void *         result = realloc_core(ptr, size);
+
+    record(LAT_REALLOC, request_class(size), start);
+    return result;
+}
+
+void *latency_calloc(const size_t nmemb, const size_t size) {
+    t_latency_slow = 0;
+    const uint64_t start = monotonic_ns();
+    void *         ptr   = calloc_core(nmemb, size);
+
+    /* An overflowing product is counted as LARGE. */
+    const size_t total = (nmemb != 0 && size > SIZE_MAX / nmemb) ? SIZE_MAX : nmemb * size;
+    record(LAT_CALLOC, request_class(total), start);
+    return ptr;
+}
+
+/* Turn timing on or off (samples are kept). Returns 1. */
+int latency_enable(const int enable) {
+    ft_lock(&g_lat_lock);
+    if (enable && !g_lat_key_ready)
+        g_lat_key_ready = pthread_key_create(&g_lat_key, release_set) == 0;
+    ft_unlock(&g_lat_lock);
+
+    g_malloc_latency = enable != 0;
+    debug_log_event("latency", NULL, (size_t)enable, enable ? "on" : "off");
+    return 1;
+}
+
+/* Value at or below which `basis_points` / 100 % of the samples lie. */
+static uint64_t percentile(const t_lat_hist *hist, const uint64_t basis_points) {
+    /* Rank of the sample, rounded up: p99.9 of 1000 samples is the 999th. */
+    const uint64_t rank = (hist->count * basis_points + 9999) / 10000;
+    uint64_t       seen = 0;
+
+    for (size_t i = 0; i < LAT_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank && seen > 0)
+            return bucket_upper(i) < hist->max ? bucket_upper(i) : hist->max;
+    }
+    return hist->max;
+}
+
+static void merge_hist(t_lat_hist *total, const t_lat_hist *hist) {
+    total->count += hist->count;
+    if (hist->max > total->max)
+        total->max = hist->max;
+    for (size_t i = 0; i < LAT_BUCKETS; i++)
+        total->buckets[i] += hist->buckets[i];
+}
+
+static void print_latency_line(t_outbuf *out, const int op, const int type, const int path,
+                               const t_lat_hist *hist) {
+    outbuf_putstr(out, "LATENCY ");
+    outbuf_putstr(out, g_lat_op_names[op]);
+    outbuf_putchar(out, ' ');
+    outbuf_putstr(out, g_lat_class_names[type]);
+    outbuf_putstr(out, path ? " slow" : " fast");
+    outbuf_putstr(out, " : count=");
+    outbuf_putsize(out, hist->count);
+    outbuf_putstr(out, " p50=");
+    outbuf_putsize(out, percentile(hist, 5000));
+    outbuf_putstr(out, "ns p99=");
+    outbuf_putsize(out, percentile(hist, 9900));
+    outbuf_putstr(out, "ns p99.9=");
+    outbuf_putsize(out, percentile(hist, 9990));
+    outbuf_putstr(out, "ns max=");
+    outbuf_putsize(out, hist->max);
+    outbuf_putstr(out, "ns\n");
+}
+
+/*
+ * Add every thread's histograms together and print one line per
+ * (operation, class, path) that has samples. Used by show_alloc_mem_stats.
+ */
+void show_latency_stats(t_outbuf *out) {
+    t_lat_hist hist;
+
+    for (int op = 0; op < LAT_OP_COUNT; op++) {
+        for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+            for (int path = 0; path < LAT_PATHS; path++) {
+                ft_memset(&hist, 0, sizeof(hist));
+
+                ft_lock(&g_lat_lock);
+                for (const t_lat_set *set = g_lat_sets; set; set = set->next)
+                    merge_hist(&hist, &set->hist[op][type][path]);
+                ft_unlock(&g_lat_lock);
+
+                if (hist.count > 0)
+                    print_latency_line(out, op, type, path, &hist);
+            }
+        }
+    }
+}
+
+void show_alloc_mem_latency_fd(const int fd) {
+    t_outbuf out;
+
+    outbuf_init(&out, fd);
+    show_latency_stats(&out);
+    outbuf_flush(&out);
+}
+
+void show_alloc_mem_latency(void) {
+    show_alloc_mem_latency_fd(1);
+}
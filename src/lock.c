@@ -0,0 +1,116 @@
+#define _GNU_SOURCE
+#include <sched.h>
+
+#include "ft_malloc.h"
+
+#ifdef __linux__
+# include <linux/futex.h>
+# include <sys/syscall.h>
+#endif
+
+/*
+ * Allocator lock: spin briefly, then park.
+ *
+ * Critical sections in the allocator are usually tens of nanoseconds, so a
+ * waiter that spins a little almost always gets the lock without paying for
+ * a futex sleep and a context switch. Only when the owner stays inside for
+ * longer (a fresh mmap(), a long zone walk) do waiters go to sleep.
+ *
+ * State machine (Drepper, "Futexes Are Tricky", mutex #2):
+ *   0 = unlocked, 1 = locked, 2 = locked and someone may be sleeping.
+ */
+
+#define FT_LOCK_SPIN_ROUNDS 64  /* Acquire attempts before parking. */
+#define FT_LOCK_MAX_BACKOFF 64  /* Upper bound of pause instructions per round. */
+
+/* CPU hint that we are in a spin-wait loop (saves power, frees the sibling thread). */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+static inline int try_acquire(t_ft_lock *lock) {
+    int expected = 0;
+
+    return __atomic_compare_exchange_n(&lock->state, &expected, 1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/* Sleep while the lock word still reads `value`. */
+static void park(t_ft_lock *lock, const int value) {
+#ifdef __linux__
+    syscall(SYS_futex, &lock->state, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    (void)lock;
+    (void)value;
+    sched_yield();
+#endif
+}
+
+/* Wake one sleeper, if any. */
+static void unpark(t_ft_lock *lock) {
+#ifdef __linux__
+    syscall(SYS_futex, &lock->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void)lock;
+#endif
+}
+
+/* Take the lock only if it is free right now. Returns 1 on success. */
+int ft_trylock(t_ft_lock *lock) {
+    if (!try_acquire(lock))
+        return 0;
+    lock->acquisitions++;
+    return 1;
+}
+
+void ft_lock(t_ft_lock *lock) {
+    /* Fast path: uncontended CAS 0 -> 1. */
+    if (try_acquire(lock)) {
+        lock->acquisitions++;
+        return;
+    }
+
+    /* Spin phase: exponential backoff between attempts. */
+    unsigned backoff = 1;
+    for (int round = 0; round < FT_LOCK_SPIN_ROUNDS; round++) {
+        for (unsigned i = 0; i < backoff; i++)
+            cpu_relax();
+        if (backoff < FT_LOCK_MAX_BACKOFF)
+            backoff <<= 1;
+
+        if (__atomic_load_n(&lock->state, __ATOMIC_RELAXED) == 0 && try_acquire(lock)) {
+            /* Counters are only written by the owner: no atomics needed. */
+            lock->acquisitions++;
+            lock->contended++;
+            return;
+        }
+    }
+
+    /*
+     * Park phase: advertise a waiter (state 2) and sleep until an unlock
+     * finds us. Whoever swaps in 2 over a 0 owns the lock.
+     */
+    size_t sleeps = 0;
+    int    state  = __atomic_exchange_n(&lock->state, 2, __ATOMIC_ACQUIRE);
+    while (state != 0) {
+        park(lock, 2);
+        sleeps++;
+        state = __atomic_exchange_n(&lock->state, 2, __ATOMIC_ACQUIRE);
+    }
+
+    lock->acquisitions++;
+    lock->contended++;
+    lock->sleeps += sleeps;
+}
+
+void ft_unlock(t_ft_lock *lock) {
+    /* 1 -> 0: nobody was waiting. 2 -> 0: wake one sleeper. */
+    if (__atomic_exchange_n(&lock->state, 0, __ATOMIC_RELEASE) == 2)
+        unpark(lock);
+}
@@ -0,0 +1,199 @@
+#include "ft_malloc.h"
+
+/*
+ * Class lock profiler.
+ *
+ * Before changing how the allocator locks, we want numbers: which callers
+ * wait on which class lock, for how long, and how long they keep it. When
+ * enabled (MallocLockProfile=1 or mallopt(M_FT_LOCK_PROFILE, 1)), every
+ * lock_zone_class() records, per class and per call site (the calling
+ * function's name):
+ * - acquisitions, and those that found the lock taken (contended)
+ * - total and max wait time (contended acquisitions only; a free lock is
+ *   taken with a single trylock and counts as zero wait)
+ * - total and max hold time, from acquisition to unlock_zone_class()
+ *
+ * Every record is made while holding the class lock it describes, so the
+ * per-class site tables need no atomics: the class lock serializes them.
+ * Results are printed by show_alloc_mem_stats(), show_alloc_mem_lock_profile()
+ * and, while profiling is on, once more on stderr at exit.
+ */
+
+#define LOCK_SITE_MAX   32                  /* Site slots per class. */
+#define LOCK_SITE_OTHER (LOCK_SITE_MAX - 1) /* Reserved: every site that found no free slot. */
+
+typedef struct s_lock_site {
+    const char *name;         /* __func__ of the caller (static storage, compared by address). */
+    size_t      acquisitions;
+    size_t      contended;
+    uint64_t    wait_total;   /* ns */
+    uint64_t    wait_max;
+    uint64_t    hold_total;
+    uint64_t    hold_max;
+} t_lock_site;
+
+typedef struct s_lock_owner {
+    t_lock_site *site;        /* Site of the current holder, NULL if not profiled. */
+    uint64_t     since;       /* Acquisition time of the current holder. */
+} t_lock_owner;
+
+int g_lock_profile = 0;
+
+static t_lock_site  g_lock_sites[ZONE_TYPE_COUNT][LOCK_SITE_MAX];
+static t_lock_owner g_lock_owners[ZONE_TYPE_COUNT];
+
+static const char *g_lock_class_names[ZONE_TYPE_COUNT] = {"TINY", "SMALL", "MEDIUM", "LARGE"};
+
+/*
+ * Site slot of `name` in a class table (caller holds that class lock).
+ * A named slot keeps its name; once they are all taken, new sites share
+ * the reserved "(other)" slot.
+ */
+static t_lock_site *find_site(const t_zone_type type, const char *name) {
+    t_lock_site *sites = g_lock_sites[type];
+
+    for (int i = 0; i < LOCK_SITE_OTHER; i++) {
+        if (sites[i].name == name)
+            return &sites[i];
+        if (!sites[i].name) {
+            sites[i].name = name;
+            return &sites[i];
+        }
+    }
+    sites[LOCK_SITE_OTHER].name = "(other)";
+    return &sites[LOCK_SITE_OTHER];
+}
+
+void lock_profile_acquire(const t_zone_type type, const char *site_name) {
+    t_ft_lock *lock      = &g_zone_locks[type];
+    uint64_t   wait      = 0;
+    int        contended = 0;
+
+    if (!ft_trylock(lock)) {
+        const uint64_t start = monotonic_ns();
+
+        ft_lock(lock);
+        wait = monotonic_ns() - start;
+        contended = 1;
+    }
+
+    t_lock_site *site = find_site(type, site_name);
+
+    site->acquisitions++;
+    if (contended) {
+        site->contended++;
+        site->wait_total += wait;
+        if (wait > site->wait_max)
+            site->wait_max = wait;
+    }
+
+    g_lock_owners[type].site  = site;
+    g_lock_owners[type].since = monotonic_ns();
+}
+
+/* Close the hold interval of the current holder (caller still owns the lock). */
+void lock_profile_release(const t_zone_type type) {
+    t_lock_owner *owner = &g_lock_owners[type];
+    t_lock_site * site  = owner->site;
+
+    /* Taken before profiling was switched on. */
+    if (!site)
+        return;
+
+    const uint64_t hold = monotonic_ns() - owner->since;
+
+    site->hold_total += hold;
+    if (hold > site->hold_max)
+        site->hold_max = hold;
+    owner->site = NULL;
+}
+
+/* Turn profiling on or off (results are kept). Returns 1. */
+int lock_profile_enable(const int enable) {
+    g_lock_profile = enable != 0;
+    debug_log_event("lock_profile", NULL, (size_t)enable, enable ? "on" : "off");
+    return 1;
+}
+
+/* Same format as the stats percentages: two decimals, integer math only. */
+static void put_percent(t_outbuf *out, const size_t part, const size_t whole) {
+    const size_t basis_points = whole ? (size_t)((unsigned long long)part * 10000ULL / whole) : 0;
+
+    outbuf_putsize(out, basis_points / 100);
+    outbuf_putchar(out, '.');
+    outbuf_putchar(out, (char)('0' + (basis_points / 10) % 10));
+    outbuf_putchar(out, (char)('0' + basis_points % 10));
+    outbuf_putchar(out, '%');
+}
+
+static void put_ns(t_outbuf *out, const char *label, const uint64_t value) {
+    outbuf_putstr(out, label);
+    outbuf_putsize(out, value);
+    outbuf_putstr(out, "ns");
+}
+
+static void print_site(t_outbuf *out, const t_zone_type type, const t_lock_site *site) {
+    outbuf_putstr(out, "LOCKPROF ");
+    outbuf_putstr(out, g_lock_class_names[type]);
+    outbuf_putchar(out, ' ');
+    outbuf_putstr(out, site->name);
+    outbuf_putstr(out, " : acquisitions=");
+    outbuf_putsize(out, site->acquisitions);
+    outbuf_putstr(out, " contended=");
+    outbuf_putsize(out, site->contended);
+    outbuf_putstr(out, " (");
+    put_percent(out, site->contended, site->acquisitions);
+    outbuf_putchar(out, ')');
+    put_ns(out, " wait_total=", site->wait_total);
+    put_ns(out, " wait_max=", site->wait_max);
+    put_ns(out, " hold_total=", site->hold_total);
+    put_ns(out, " hold_max=", site->hold_max);
+    outbuf_putchar(out, '\n');
+}
+
+/*
+ * One line per (class, call site), most waited-on first. Each class table
+ * is copied under its lock (with the profiler's own acquisition not
+ * recorded), then sorted and printed without it.
+ */
+void show_lock_profile(t_outbuf *out) {
+    t_lock_site sites[LOCK_SITE_MAX];
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        ft_lock(&g_zone_locks[type]);
+        ft_memcpy(sites, g_lock_sites[type], sizeof(sites));
+        ft_unlock(&g_zone_locks[type]);
+
+        /* Selection sort by total wait: the tables are tiny. */
+        for (int i = 0; i < LOCK_SITE_MAX && sites[i].name; i++) {
+            int best = i;
+
+            for (int j = i + 1; j < LOCK_SITE_MAX && sites[j].name; j++)
+                if (sites[j].wait_total > sites[best].wait_total)
+                    best = j;
+
+            const t_lock_site tmp = sites[i];
+            sites[i] = sites[best];
+            sites[best] = tmp;
+            print_site(out, (t_zone_type)type, &sites[i]);
+        }
+    }
+}
+
+void show_alloc_mem_lock_profile_fd(const int fd) {
+    t_outbuf out;
+
+    outbuf_init(&out, fd);
+    show_lock_profile(&out);
+    outbuf_flush(&out);
+}
+
+void show_alloc_mem_lock_profile(void) {
+    show_alloc_mem_lock_profile_fd(1);
+}
+
+/* Exit dump on stderr, so a profiled run needs no code change to report. */
+static void __attribute__((destructor)) lock_profile_dump(void) {
+    if (g_lock_profile)
+        show_alloc_mem_lock_profile_fd(STDERR_FILENO);
+}
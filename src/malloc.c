@@ -5,11 +5,51 @@
 
 /*
  * Global allocator state:
- * - g_zones is the head of our zone list.
- * - g_mutex serializes all allocator mutations.
+ * - g_zones[type] is the head of the zone list for one size class.
+ * - g_zone_counts[type] counts the zones mapped for that class (zone growth);
+ *   hot-size slabs are not counted.
+ * - g_zone_locks[type] serializes mutations of that class only, so TINY,
+ *   SMALL, MEDIUM and LARGE traffic never wait on each other.
  */
-t_zone *        g_zones = NULL;
-pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+t_zone *        g_zones[ZONE_TYPE_COUNT] = {NULL, NULL, NULL, NULL};
+size_t          g_zone_counts[ZONE_TYPE_COUNT] = {0, 0, 0, 0};
+t_ft_lock       g_zone_locks[ZONE_TYPE_COUNT] = {
+    FT_LOCK_INITIALIZER,
+    FT_LOCK_INITIALIZER,
+    FT_LOCK_INITIALIZER,
+    FT_LOCK_INITIALIZER,
+};
+
+/*
+ * Class lock wrappers. `site` is the calling function (the lock_zone_class()
+ * and lock_all_zone_classes() macros pass __func__), used by the lock
+ * profiler to attribute wait and hold times.
+ */
+void lock_zone_class_at(const t_zone_type type, const char *site) {
+    if (g_lock_profile)
+        lock_profile_acquire(type, site);
+    else
+        ft_lock(&g_zone_locks[type]);
+}
+
+void unlock_zone_class(const t_zone_type type) {
+    if (g_shm_stats)
+        shm_stats_publish_lock(type);
+    if (g_lock_profile)
+        lock_profile_release(type);
+    ft_unlock(&g_zone_locks[type]);
+}
+
+/* Whole-heap views (show_* functions) freeze every class, in lock order. */
+void lock_all_zone_classes_at(const char *site) {
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+        lock_zone_class_at((t_zone_type)type, site);
+}
+
+void unlock_all_zone_classes(void) {
+    for (int type = ZONE_TYPE_COUNT - 1; type >= 0; type--)
+        unlock_zone_class((t_zone_type)type);
+}
 
 /*
  * Align a byte count up to the next 16-byte boundary.
@@ -26,13 +66,16 @@ size_t align_size(const size_t size) {
  * Decide which zone class should handle a request.
  *
  * TINY/SMALL requests are pooled (many blocks per mmap zone),
+ * MEDIUM requests share big TLSF-indexed zones,
  * LARGE requests get dedicated zones.
  */
-static t_zone_type get_zone_type(const size_t size) {
+t_zone_type get_zone_type(const size_t size) {
     if (size <= TINY_MALLOC_LIMIT)
         return TINY;
     if (size <= SMALL_MALLOC_LIMIT)
         return SMALL;
+    if (size <= MEDIUM_MALLOC_LIMIT)
+        return MEDIUM;
     return LARGE;
 }
 
@@ -45,157 +88,235 @@ static t_zone_type get_zone_type(const size_t size) {
  * - plus at least MALLOC_ALIGN user bytes
  */
 void split_block(t_block *block, const size_t size) {
+    const size_t total = block_size(block);
+
     /* Guard: don't create unusable tiny fragments. */
-    if (block->size >= size + BLOCK_HDR_SIZE + MALLOC_ALIGN) {
+    if (total >= size + BLOCK_HDR_SIZE + MALLOC_ALIGN) {
         /*
          * New remainder block starts right after:
          * current block header + requested payload.
          */
-        t_block *new_block = (t_block *)((char *)block + BLOCK_HDR_SIZE + size);
+        t_block *    new_block      = (t_block *)((char *)block + BLOCK_HDR_SIZE + size);
+        const size_t remainder_size = total - size - BLOCK_HDR_SIZE;
 
-        /* Initialize remainder metadata. */
-        new_block->size = block->size - size - BLOCK_HDR_SIZE;
-        new_block->next = block->next;
-        new_block->free = 1;
+        /* Initialize remainder metadata; the block after it now follows the remainder. */
+        block_init(new_block, size, remainder_size, block_class(block), BLOCK_FREE);
+        block_after(new_block)->prev_size = remainder_size;
 
         /* Shrink current block to exactly the allocated size. */
-        block->size = size;
-        block->next = new_block;
-        block->free = 0;
+        block_set_size(block, size);
+        block_set_state(block, BLOCK_USED);
 
-        debug_log_block_split(block, size, new_block->size);
+        debug_log_block_split(block, size, remainder_size);
     } else {
         /* No useful split possible: consume full block as one allocation. */
-        block->free = 0;
+        block_set_state(block, BLOCK_USED);
     }
 }
 
 /*
- * First-fit search inside zones of the matching type.
+ * First-fit search inside one zone list (one class).
  *
  * This keeps policy simple and deterministic:
  * - iterate zones in list order
  * - iterate blocks in each zone
  * - pick first free block large enough
+ *
+ * The owning zone is reported too, so debug output needs no second walk.
+ *
+ * Each zone's walk starts at its free_hint, and the hint is moved up to
+ * the first free block seen (or to the last block when there is none), so
+ * full zones and long used prefixes are not rescanned on every call.
  */
-static t_block *find_free_block(const t_zone_type type, const size_t size) {
-    const t_zone *zone = g_zones;
+t_block *find_free_block(t_zone *zones, const size_t size, t_zone **out_zone) {
+    for (t_zone *zone = zones; zone; zone = zone->next) {
+        /* Slab zones only serve their own size (hot_slab.c). */
+        if (zone->hot)
+            continue;
 
-    while (zone) {
-        /* Never mix types: TINY requests never consume SMALL/LARGE zones. */
-        if (zone->type == type) {
-            t_block *block = zone->blocks;
+        t_block *block      = zone->free_hint;
+        t_block *first_free = NULL;
+        t_block *last       = block;
 
-            while (block) {
-                if (block->free && block->size >= size)
+        while (block) {
+            if (block_state(block) == BLOCK_FREE) {
+                if (!first_free)
+                    first_free = block;
+                if (block_size(block) >= size) {
+                    zone->free_hint = first_free;
+                    *out_zone = zone;
                     return block;
-                block = block->next;
+                }
             }
+            last = block;
+            block = block_next(block);
         }
-        zone = zone->next;
+        zone->free_hint = first_free ? first_free : last;
     }
     return NULL;
 }
 
-/*
- * Debug helper: map a block pointer back to its owning zone.
- *
- * This is intentionally O(n) and only used for richer debug output.
- */
-static t_zone *find_zone_for_block(const t_block *target)
-{
-    t_zone *zone = g_zones;
+/* Shared tail of every pooled allocation: optional scribble + trace. */
+static void *finish_pooled_block(t_block *block, const size_t requested_size) {
+    /* User pointer always starts immediately after metadata header. */
+    void *ptr = (void *)((char *)block + BLOCK_HDR_SIZE);
 
-    while (zone) {
-        t_block *block = zone->blocks;
+    /* Optional debug mode: mark fresh bytes with 0xAA to expose uninitialized use. */
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, requested_size);
 
-        while (block) {
-            if (block == target)
-                return zone;
-            block = block->next;
-        }
-        zone = zone->next;
-    }
-    return NULL;
+    SHM_STAT_ADD(classes[block_class(block)].allocs, 1);
+    SHM_STAT_ADD(classes[block_class(block)].bytes_in_use, block_size(block));
+    debug_log_event("malloc", ptr, requested_size, "zone");
+    return ptr;
 }
 
 /*
- * Core malloc implementation (expects caller already holds g_mutex).
+ * Core pooled malloc implementation (caller holds g_zone_locks[type]).
  *
  * Central flow:
- * 1) normalize+align request
- * 2) reuse a free block if possible
- * 3) otherwise mmap/register a new zone
- * 4) split pooled blocks when useful
- * 5) return user pointer (header skipped)
+ * 0) popular sizes come from their exact-fit slab (hot_slab.c)
+ * 1) hand back a recently-freed block that fits whole (no split, no merge)
+ * 2) carve the block off the untouched tail of the newest zone (a bump)
+ * 3) otherwise coalesce parked blocks and reuse a free block if possible
+ * 4) otherwise mmap/register a new zone and carve from its tail
+ * 5) split a reused block when useful
+ * 6) return user pointer (header skipped)
  */
-void *malloc_nolock(size_t size) {
-    /*
-     * malloc(0) is implementation-defined; we choose minimum alloc behavior
-     * so returned pointer stays safely free-able and practical for callers.
-     */
-    const size_t requested_size = size == 0 ? (size_t)1u : size;
+void *malloc_nolock(const t_zone_type type, const size_t requested_size, const size_t aligned_size) {
+    /* MEDIUM has its own O(1) index instead of first-fit. */
+    if (type == MEDIUM)
+        return medium_malloc_nolock(requested_size, aligned_size);
 
-    /* Prevent wraparound before alignment math. */
-    if (requested_size > SIZE_MAX - (size_t)15u) {
-        debug_log_event("malloc", NULL, requested_size, "failed: size overflow");
-        return NULL;
+    t_block *block = NULL;
+
+    /* Exact sizes only: aligned_alloc_core() cuts its padded block up afterwards. */
+    if (g_hot_slabs && aligned_size == align_size(requested_size))
+        block = hot_slab_alloc(type, aligned_size);
+    if (block) {
+        debug_log_malloc_placement(NULL, block, requested_size, aligned_size,
+                                   block_size(block), "hot-slab");
+        return finish_pooled_block(block, requested_size);
     }
 
-    /* Work internally with aligned payload size. */
-    const size_t      aligned_size = align_size(requested_size);
-    const t_zone_type type         = get_zone_type(aligned_size);
+    block = take_deferred_block(type, aligned_size);
+    if (block) {
+        SHM_STAT_ADD(classes[type].reuse_hits, 1);
+        debug_log_malloc_placement(NULL, block, requested_size, aligned_size,
+                                   block_size(block), "recently-freed");
+        return finish_pooled_block(block, requested_size);
+    }
+    SHM_STAT_ADD(classes[type].reuse_misses, 1);
+
+    t_zone *zone = NULL;
+
+    block = carve_frontier(type, aligned_size, &zone);
+    if (block) {
+        debug_log_malloc_placement(zone, block, requested_size, aligned_size,
+                                   block_size(block), "frontier");
+        return finish_pooled_block(block, requested_size);
+    }
+
+    /* Miss: merge parked blocks so first-fit sees the real free space. */
+    flush_deferred_blocks(type);
 
     /* Try reuse path first to reduce mmap calls and fragmentation pressure. */
-    t_block *block         = find_free_block(type, aligned_size);
-    int      from_new_zone = 0;
+    const char *source = "reused-free";
+
+    block = find_free_block(g_zones[type], aligned_size, &zone);
 
     if (!block) {
         /* Slow path: acquire fresh zone from kernel. */
-        t_zone *zone = request_new_zone(type, aligned_size);
+        zone = request_new_zone(&g_zones[type], &g_zone_counts[type], type, aligned_size);
 
         if (!zone) {
             debug_log_event("malloc", NULL, aligned_size, "failed: mmap");
             return NULL;
         }
 
-        /* Fresh zones expose one initial block covering available payload area. */
-        block = zone->blocks;
-        from_new_zone = 1;
+        /* A fresh zone is all frontier: the block is a bump away. */
+        block = carve_frontier(type, aligned_size, &zone);
+        source = "new-zone";
     }
 
-    /* Snapshot pre-placement state for debug trace. */
-    const size_t block_size_before = block->size;
-    t_zone *     block_zone        = find_zone_for_block(block);
+    debug_log_malloc_placement(zone, block, requested_size, aligned_size,
+                               block_size(block), source);
+
+    /* Split if profitable so leftovers remain reusable (carved blocks already fit). */
+    split_block(block, aligned_size);
+
+    return finish_pooled_block(block, requested_size);
+}
+
+/*
+ * LARGE allocation: one dedicated zone per request.
+ *
+ * The mmap() happens before any lock is taken, so a big mapping never
+ * stalls TINY/SMALL traffic; the LARGE lock only covers the list insert.
+ */
+void *malloc_large(const size_t requested_size, const size_t aligned_size) {
+    t_zone *zone = map_zone(LARGE, aligned_size, 0);
 
-    debug_log_malloc_placement(block_zone, block, requested_size, aligned_size,
-                               block_size_before, from_new_zone);
+    if (!zone) {
+        debug_log_event("malloc", NULL, aligned_size, "failed: mmap");
+        return NULL;
+    }
+    return publish_large(zone, requested_size, aligned_size);
+}
+
+/* Register a freshly mapped LARGE zone and hand out its block (no lock held on entry). */
+void *publish_large(t_zone *zone, const size_t requested_size, const size_t aligned_size) {
+    t_block *block = zone->blocks;
+    debug_log_malloc_placement(zone, block, requested_size, aligned_size, block_size(block), "new-zone");
+
+    lock_zone_class(LARGE);
+    register_zone(&g_zones[LARGE], zone);
+    SHM_STAT_ADD(classes[LARGE].allocs, 1);
+    SHM_STAT_ADD(classes[LARGE].bytes_in_use, block_size(block));
+    unlock_zone_class(LARGE);
+
+    /* The mapping is ours alone: scribbling needs no lock. */
+    void *ptr = (void *)((char *)block + BLOCK_HDR_SIZE);
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, requested_size);
+
+    debug_log_event("malloc", ptr, requested_size, "large");
+    return ptr;
+}
 
+/*
+ * malloc body:
+ * normalize+align request -> pick class -> lock that class only.
+ */
+void *malloc_core(size_t size) {
     /*
-     * Allocation finalization policy:
-     * - TINY/SMALL: split if profitable so leftovers remain reusable
-     * - LARGE: one block per zone, mark it used directly
+     * malloc(0) is implementation-defined; we choose minimum alloc behavior
+     * so returned pointer stays safely free-able and practical for callers.
      */
-    if (type != LARGE)
-        split_block(block, aligned_size);
-    else
-        block->free = 0;
+    const size_t requested_size = size == 0 ? (size_t)1u : size;
 
-    /* User pointer always starts immediately after metadata header. */
-    void *ptr = (void *)((char *)block + BLOCK_HDR_SIZE);
+    /* Prevent wraparound before alignment math. */
+    if (requested_size > SIZE_MAX - (size_t)15u) {
+        debug_log_event("malloc", NULL, requested_size, "failed: size overflow");
+        return NULL;
+    }
 
-    /* Optional debug mode: mark fresh bytes with 0xAA to expose uninitialized use. */
-    if (g_malloc_scribble)
-        ft_memset(ptr, 0xAA, requested_size);
+    /* Work internally with aligned payload size. */
+    const size_t      aligned_size = align_size(requested_size);
+    const t_zone_type type         = get_zone_type(aligned_size);
 
-    debug_log_event("malloc", ptr, requested_size, type == LARGE ? "large" : "zone");
+    if (type == LARGE)
+        return malloc_large(requested_size, aligned_size);
+
+    lock_zone_class(type);
+    void *ptr = malloc_nolock(type, requested_size, aligned_size);
+    unlock_zone_class(type);
     return ptr;
 }
 
-/* Public malloc wrapper: lock -> core logic -> unlock. */
+/* Public malloc: timed through the latency histograms when they are on. */
 void *malloc(size_t size) {
-    pthread_mutex_lock(&g_mutex);
-    void *ptr = malloc_nolock(size);
-    pthread_mutex_unlock(&g_mutex);
-    return ptr;
+    if (g_malloc_latency)
+        return latency_malloc(size);
+    return malloc_core(size);
 }
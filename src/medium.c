@@ -0,0 +1,272 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * MEDIUM class: two-level segregated fit (TLSF).
+ *
+ * Requests between SMALL_MALLOC_LIMIT and MEDIUM_MALLOC_LIMIT share big
+ * zones instead of paying one mmap() each. Free blocks are indexed by size
+ * in a two-level table of lists:
+ * - first level: power of two of the size (fl)
+ * - second level: TLSF_SL_COUNT linear subdivisions of that range (sl)
+ * One bitmap per level tells which lists are non-empty, so finding a fit is
+ * a couple of find-first-set instructions instead of a zone walk.
+ *
+ * Free blocks are always fully coalesced: on free() the block merges with
+ * both physical neighbors right away (prev_size makes the left side O(1)),
+ * so malloc() and free() both run in bounded time.
+ *
+ * The free-list links live in the first payload bytes of each free block;
+ * split_block() never leaves less than MALLOC_ALIGN payload, which is
+ * exactly the room they need. All functions expect the caller to hold
+ * g_zone_locks[MEDIUM].
+ *
+ * A zone that becomes one free block holds no data: its payload pages go
+ * back to the kernel (MADV_DONTNEED), as LARGE memory does on free. Zones
+ * of the global list are never unmapped (see arena.c), so the zone stays
+ * indexed and refaults zero pages on reuse. The first zone is kept warm
+ * for the next burst, and so is the last zone that went empty: its pages
+ * only go once another zone goes empty after it. A zone that keeps
+ * filling and draining does not pay for a madvise() every time.
+ */
+
+#define TLSF_SL_LOG2     4
+#define TLSF_SL_COUNT    (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT    (TLSF_SL_LOG2 + 4) /* 4 = log2(MALLOC_ALIGN). */
+#define TLSF_SMALL_BLOCK (1UL << TLSF_FL_SHIFT)
+#define TLSF_FL_MAX      32                 /* Blocks stay below 4 GB (bounded by the zone size). */
+#define TLSF_FL_COUNT    (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+typedef struct s_tlsf_links {
+    t_block *next_free;
+    t_block *prev_free;
+} t_tlsf_links;
+
+typedef struct s_tlsf {
+    unsigned int fl_bitmap;                               /* Bit fl: some list of row fl is non-empty. */
+    unsigned int sl_bitmap[TLSF_FL_COUNT];                /* Bit sl: heads[fl][sl] is non-empty. */
+    t_block *    heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} t_tlsf;
+
+static t_tlsf g_medium_index;
+static t_zone *g_medium_spare; /* Last zone that went empty, still resident. */
+
+static t_tlsf_links *free_links(t_block *block) {
+    return (t_tlsf_links *)((char *)block + BLOCK_HDR_SIZE);
+}
+
+/* Index of the most significant set bit (size > 0). */
+static int fls_size(const size_t size) {
+    return (int)(sizeof(unsigned long) * 8) - 1 - __builtin_clzl((unsigned long)size);
+}
+
+/* List that a free block of `size` bytes belongs to. */
+static void mapping_insert(const size_t size, int *fl, int *sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (int)(size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+        return;
+    }
+
+    const int msb = fls_size(size);
+
+    *sl = (int)(size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+    *fl = msb - (TLSF_FL_SHIFT - 1);
+    if (*fl >= TLSF_FL_COUNT) {
+        *fl = TLSF_FL_COUNT - 1;
+        *sl = TLSF_SL_COUNT - 1;
+    }
+}
+
+/*
+ * First list whose every block fits `size`: round the size up to the next
+ * second-level boundary before mapping it (good-fit, never a walk).
+ */
+static void mapping_search(size_t size, int *fl, int *sl) {
+    if (size >= TLSF_SMALL_BLOCK)
+        size += ((size_t)1 << (fls_size(size) - TLSF_SL_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+}
+
+static void index_insert(t_block *block) {
+    int fl;
+    int sl;
+
+    mapping_insert(block_size(block), &fl, &sl);
+
+    t_block *head = g_medium_index.heads[fl][sl];
+
+    free_links(block)->next_free = head;
+    free_links(block)->prev_free = NULL;
+    if (head)
+        free_links(head)->prev_free = block;
+
+    g_medium_index.heads[fl][sl] = block;
+    g_medium_index.fl_bitmap |= 1U << fl;
+    g_medium_index.sl_bitmap[fl] |= 1U << sl;
+}
+
+static void index_remove(t_block *block) {
+    int fl;
+    int sl;
+
+    mapping_insert(block_size(block), &fl, &sl);
+
+    t_block *next = free_links(block)->next_free;
+    t_block *prev = free_links(block)->prev_free;
+
+    if (next)
+        free_links(next)->prev_free = prev;
+    if (prev) {
+        free_links(prev)->next_free = next;
+        return;
+    }
+
+    g_medium_index.heads[fl][sl] = next;
+    if (!next) {
+        g_medium_index.sl_bitmap[fl] &= ~(1U << sl);
+        if (!g_medium_index.sl_bitmap[fl])
+            g_medium_index.fl_bitmap &= ~(1U << fl);
+    }
+}
+
+/* Unlink and return a free block of at least `size` bytes, or NULL. */
+static t_block *index_take(const size_t size) {
+    int fl;
+    int sl;
+
+    mapping_search(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT)
+        return NULL;
+
+    unsigned int sl_map = g_medium_index.sl_bitmap[fl] & (~0U << sl);
+
+    if (!sl_map) {
+        const unsigned int fl_map = fl + 1 < TLSF_FL_COUNT
+                                        ? g_medium_index.fl_bitmap & (~0U << (fl + 1))
+                                        : 0;
+        if (!fl_map)
+            return NULL;
+        fl = __builtin_ctz(fl_map);
+        sl_map = g_medium_index.sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+
+    t_block *block = g_medium_index.heads[fl][sl];
+    index_remove(block);
+    return block;
+}
+
+/* Split off the tail of a used block and index it, if split_block() made one. */
+static void split_and_index(t_block *block, const size_t size) {
+    split_block(block, size);
+
+    /* Neighbors of a free block are never free, so a free next is the new tail. */
+    t_block *next = block_next(block);
+
+    if (next && block_state(next) == BLOCK_FREE)
+        index_insert(next);
+}
+
+void *medium_malloc_nolock(const size_t requested_size, const size_t aligned_size) {
+    t_zone *    zone   = NULL;
+    const char *source = "tlsf";
+    t_block *   block  = index_take(aligned_size);
+
+    if (!block) {
+        zone = request_new_zone(&g_zones[MEDIUM], &g_zone_counts[MEDIUM], MEDIUM, aligned_size);
+        if (!zone) {
+            debug_log_event("malloc", NULL, aligned_size, "failed: mmap");
+            return NULL;
+        }
+        block = zone->blocks;
+        source = "new-zone";
+    }
+
+    debug_log_malloc_placement(zone, block, requested_size, aligned_size, block_size(block), source);
+    split_and_index(block, aligned_size);
+
+    void *ptr = (void *)((char *)block + BLOCK_HDR_SIZE);
+
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, requested_size);
+
+    SHM_STAT_ADD(classes[MEDIUM].allocs, 1);
+    SHM_STAT_ADD(classes[MEDIUM].bytes_in_use, block_size(block));
+    debug_log_event("malloc", ptr, requested_size, "medium");
+    return ptr;
+}
+
+/* Index the initial free block of a MEDIUM zone mapped ahead of demand. */
+void medium_adopt_zone_nolock(t_zone *zone) {
+    index_insert(zone->blocks);
+}
+
+/* Drop the pages of a zone that is one free block; its header and links stay. */
+static void drop_zone_pages(t_zone *zone) {
+    t_block *       block     = zone->blocks;
+    const uintptr_t page_mask = (uintptr_t)getpagesize() - 1;
+    const uintptr_t first     = ((uintptr_t)free_links(block) + sizeof(t_tlsf_links) + page_mask) & ~page_mask;
+    const uintptr_t end       = (uintptr_t)block_after(block) & ~page_mask;
+
+    if (first >= end)
+        return;
+    madvise((void *)first, end - first, MADV_DONTNEED);
+    debug_log_event("medium", zone, end - first, "pages released");
+}
+
+/*
+ * A zone just became one free block: keep it as the spare, and release
+ * the previous spare if it is still empty.
+ */
+static void release_empty_zone(t_block *block) {
+    t_zone *zone = find_class_zone(MEDIUM, block, NULL);
+
+    if (!zone || zone == g_zones[MEDIUM] || zone == g_medium_spare)
+        return;
+
+    t_zone *spare = g_medium_spare;
+
+    g_medium_spare = zone;
+    if (spare && block_state(spare->blocks) == BLOCK_FREE && !block_next(spare->blocks))
+        drop_zone_pages(spare);
+}
+
+/* Merge with free physical neighbors and put the result back in the index. */
+void medium_free_nolock(t_block *block) {
+    block_set_state(block, BLOCK_FREE);
+
+    t_block *next = block_next(block);
+    t_block *prev = block_prev(block);
+
+    if (next && block_state(next) == BLOCK_FREE) {
+        index_remove(next);
+        coalesce_right(block);
+    }
+    if (prev && block_state(prev) == BLOCK_FREE) {
+        index_remove(prev);
+        block = prev;
+        coalesce_right(block);
+    }
+    index_insert(block);
+    if (!block->prev_size && !block_next(block))
+        release_empty_zone(block);
+}
+
+/*
+ * realloc() helper: grow a used block into its free right neighbor.
+ * Returns 1 on success, 0 when the neighbor is missing, used or too small.
+ */
+int medium_grow_nolock(t_block *block, const size_t need) {
+    t_block *next = block_next(block);
+
+    if (!next || block_state(next) != BLOCK_FREE
+        || block_size(block) + BLOCK_HDR_SIZE + block_size(next) < need)
+        return 0;
+
+    index_remove(next);
+    coalesce_right(block);
+    split_and_index(block, need);
+    return 1;
+}
@@ -0,0 +1,305 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+#if defined(__x86_64__)
+# include <immintrin.h>
+#endif
+
+/*
+ * Bulk fill/copy kernels.
+ *
+ * calloc() zeroing, realloc() moves and the scribble patterns are the only
+ * places where the allocator touches user payloads in bulk. They go through
+ * mem_fill()/mem_copy(), which dispatch to the widest kernel the CPU
+ * supports (AVX-512, AVX2, SSE2, or a portable word loop), picked once when
+ * the library is loaded.
+ *
+ * x86 kernels store to aligned addresses only: an unaligned store covers
+ * the head and another one the tail, and the body runs on the aligned
+ * addresses in between. Above g_nt_threshold (the last level cache size)
+ * the body uses non-temporal stores, so a huge calloc() or realloc() runs
+ * at memory bandwidth without evicting the whole cache.
+ *
+ * The pointers start on the portable kernels: constructors of other
+ * libraries may allocate before ours has run.
+ */
+
+#define MEM_SMALL_COPY           64
+#define MEM_DEFAULT_NT_THRESHOLD (8UL * 1024UL * 1024UL)
+
+typedef uint64_t __attribute__((may_alias)) t_mem_word;
+
+typedef void (*t_fill_kernel)(void *dst, int c, size_t n);
+typedef void (*t_copy_kernel)(void *dst, const void *src, size_t n);
+
+static size_t g_nt_threshold = MEM_DEFAULT_NT_THRESHOLD;
+
+/* Portable kernels: byte head and tail around a word-sized body. */
+static void fill_generic(void *dst, const int c, size_t n) {
+    unsigned char *  d       = (unsigned char *)dst;
+    const t_mem_word pattern = 0x0101010101010101ULL * (unsigned char)c;
+
+    while (n > 0 && ((uintptr_t)d & (sizeof(t_mem_word) - 1))) {
+        *d++ = (unsigned char)c;
+        n--;
+    }
+    for (; n >= sizeof(t_mem_word); n -= sizeof(t_mem_word), d += sizeof(t_mem_word))
+        *(t_mem_word *)d = pattern;
+    while (n-- > 0)
+        *d++ = (unsigned char)c;
+}
+
+static void copy_generic(void *dst, const void *src, size_t n) {
+    unsigned char *      d = (unsigned char *)dst;
+    const unsigned char *s = (const unsigned char *)src;
+
+    /* Word copies only when both sides can be aligned together. */
+    if ((((uintptr_t)d ^ (uintptr_t)s) & (sizeof(t_mem_word) - 1)) != 0) {
+        ft_memcpy(dst, src, n);
+        return;
+    }
+    while (n > 0 && ((uintptr_t)d & (sizeof(t_mem_word) - 1))) {
+        *d++ = *s++;
+        n--;
+    }
+    for (; n >= sizeof(t_mem_word); n -= sizeof(t_mem_word)) {
+        *(t_mem_word *)d = *(const t_mem_word *)s;
+        d += sizeof(t_mem_word);
+        s += sizeof(t_mem_word);
+    }
+    while (n-- > 0)
+        *d++ = *s++;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse2")))
+static void fill_sse2(void *dst, const int c, const size_t n) {
+    if (n < MEM_SMALL_COPY) {
+        fill_generic(dst, c, n);
+        return;
+    }
+
+    const __m128i  v   = _mm_set1_epi8((char)c);
+    char *         end = (char *)dst + n;
+    char *         p   = (char *)(((uintptr_t)dst + 16) & ~(uintptr_t)15);
+
+    _mm_storeu_si128((__m128i *)dst, v);
+    if (n >= g_nt_threshold) {
+        for (; p + 16 <= end; p += 16)
+            _mm_stream_si128((__m128i *)p, v);
+        _mm_sfence();
+    } else {
+        for (; p + 16 <= end; p += 16)
+            _mm_store_si128((__m128i *)p, v);
+    }
+    _mm_storeu_si128((__m128i *)(end - 16), v);
+}
+
+__attribute__((target("sse2")))
+static void copy_sse2(void *dst, const void *src, size_t n) {
+    if (n < MEM_SMALL_COPY) {
+        copy_generic(dst, src, n);
+        return;
+    }
+
+    const __m128i head = _mm_loadu_si128((const __m128i *)src);
+    const __m128i tail = _mm_loadu_si128((const __m128i *)((const char *)src + n - 16));
+    char *        d    = (char *)dst;
+    const char *  s    = (const char *)src;
+    const size_t  skip = 16 - ((uintptr_t)d & 15);
+    const int     nt   = n >= g_nt_threshold;
+
+    d += skip;
+    s += skip;
+    n -= skip;
+    for (; n >= 16; n -= 16, d += 16, s += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)s);
+
+        if (nt)
+            _mm_stream_si128((__m128i *)d, v);
+        else
+            _mm_store_si128((__m128i *)d, v);
+    }
+    if (nt)
+        _mm_sfence();
+    _mm_storeu_si128((__m128i *)dst, head);
+    _mm_storeu_si128((__m128i *)(d + n - 16), tail);
+}
+
+__attribute__((target("avx2")))
+static void fill_avx2(void *dst, const int c, const size_t n) {
+    if (n < MEM_SMALL_COPY) {
+        fill_generic(dst, c, n);
+        return;
+    }
+
+    const __m256i v   = _mm256_set1_epi8((char)c);
+    char *        end = (char *)dst + n;
+    char *        p   = (char *)(((uintptr_t)dst + 32) & ~(uintptr_t)31);
+
+    _mm256_storeu_si256((__m256i *)dst, v);
+    if (n >= g_nt_threshold) {
+        for (; p + 32 <= end; p += 32)
+            _mm256_stream_si256((__m256i *)p, v);
+        _mm_sfence();
+    } else {
+        for (; p + 32 <= end; p += 32)
+            _mm256_store_si256((__m256i *)p, v);
+    }
+    _mm256_storeu_si256((__m256i *)(end - 32), v);
+}
+
+__attribute__((target("avx2")))
+static void copy_avx2(void *dst, const void *src, size_t n) {
+    if (n < MEM_SMALL_COPY) {
+        copy_generic(dst, src, n);
+        return;
+    }
+
+    const __m256i head = _mm256_loadu_si256((const __m256i *)src);
+    const __m256i tail = _mm256_loadu_si256((const __m256i *)((const char *)src + n - 32));
+    char *        d    = (char *)dst;
+    const char *  s    = (const char *)src;
+    const size_t  skip = 32 - ((uintptr_t)d & 31);
+    const int     nt   = n >= g_nt_threshold;
+
+    d += skip;
+    s += skip;
+    n -= skip;
+    for (; n >= 32; n -= 32, d += 32, s += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)s);
+
+        if (nt)
+            _mm256_stream_si256((__m256i *)d, v);
+        else
+            _mm256_store_si256((__m256i *)d, v);
+    }
+    if (nt)
+        _mm_sfence();
+    _mm256_storeu_si256((__m256i *)dst, head);
+    _mm256_storeu_si256((__m256i *)(d + n - 32), tail);
+}
+
+__attribute__((target("avx512f")))
+static void fill_avx512(void *dst, const int c, const size_t n) {
+    if (n < 2 * MEM_SMALL_COPY) {
+        fill_avx2(dst, c, n);
+        return;
+    }
+
+    const __m512i v   = _mm512_set1_epi32((int)(0x01010101U * (unsigned char)c));
+    char *        end = (char *)dst + n;
+    char *        p   = (char *)(((uintptr_t)dst + 64) & ~(uintptr_t)63);
+
+    _mm512_storeu_si512((void *)dst, v);
+    if (n >= g_nt_threshold) {
+        for (; p + 64 <= end; p += 64)
+            _mm512_stream_si512((void *)p, v);
+        _mm_sfence();
+    } else {
+        for (; p + 64 <= end; p += 64)
+            _mm512_store_si512((void *)p, v);
+    }
+    _mm512_storeu_si512((void *)(end - 64), v);
+}
+
+__attribute__((target("avx512f")))
+static void copy_avx512(void *dst, const void *src, size_t n) {
+    if (n < 2 * MEM_SMALL_COPY) {
+        copy_avx2(dst, src, n);
+        return;
+    }
+
+    const __m512i head = _mm512_loadu_si512((const void *)src);
+    const __m512i tail = _mm512_loadu_si512((const void *)((const char *)src + n - 64));
+    char *        d    = (char *)dst;
+    const char *  s    = (const char *)src;
+    const size_t  skip = 64 - ((uintptr_t)d & 63);
+    const int     nt   = n >= g_nt_threshold;
+
+    d += skip;
+    s += skip;
+    n -= skip;
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+        const __m512i v = _mm512_loadu_si512((const void *)s);
+
+        if (nt)
+            _mm512_stream_si512((void *)d, v);
+        else
+            _mm512_store_si512((void *)d, v);
+    }
+    if (nt)
+        _mm_sfence();
+    _mm512_storeu_si512((void *)dst, head);
+    _mm512_storeu_si512((void *)(d + n - 64), tail);
+}
+
+#endif
+
+static t_fill_kernel g_fill_kernel = fill_generic;
+static t_copy_kernel g_copy_kernel = copy_generic;
+
+void mem_fill(void *dst, const int c, const size_t n) {
+    g_fill_kernel(dst, c, n);
+}
+
+/* dst and src must not overlap. */
+void mem_copy(void *dst, const void *src, const size_t n) {
+    g_copy_kernel(dst, src, n);
+}
+
+int mem_kernels_select(const t_mem_kernel kernel) {
+    switch (kernel) {
+    case MEM_KERNEL_GENERIC:
+        g_fill_kernel = fill_generic;
+        g_copy_kernel = copy_generic;
+        return 1;
+#if defined(__x86_64__)
+    case MEM_KERNEL_SSE2:
+        /* SSE2 is part of the x86-64 baseline. */
+        g_fill_kernel = fill_sse2;
+        g_copy_kernel = copy_sse2;
+        return 1;
+    case MEM_KERNEL_AVX2:
+        if (!__builtin_cpu_supports("avx2"))
+            return 0;
+        g_fill_kernel = fill_avx2;
+        g_copy_kernel = copy_avx2;
+        return 1;
+    case MEM_KERNEL_AVX512:
+        if (!__builtin_cpu_supports("avx512f"))
+            return 0;
+        g_fill_kernel = fill_avx512;
+        g_copy_kernel = copy_avx512;
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+/* Size from which the x86 kernels switch to non-temporal stores. */
+size_t mem_nt_threshold(void) {
+    return g_nt_threshold;
+}
+
+/* Pick the widest kernels once, at load time. */
+static void __attribute__((constructor)) select_mem_kernels(void) {
+    static const char *names[MEM_KERNEL_COUNT] = {"generic", "sse2", "avx2", "avx512"};
+    int                kernel                  = MEM_KERNEL_COUNT - 1;
+
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    const long llc_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (llc_size > 0)
+        g_nt_threshold = (size_t)llc_size;
+#endif
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#endif
+    while (!mem_kernels_select((t_mem_kernel)kernel))
+        kernel--;
+    debug_log_event("mem_kernels", NULL, g_nt_threshold, names[kernel]);
+}
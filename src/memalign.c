@@ -0,0 +1,214 @@
+#include <errno.h>
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Aligned allocations: posix_memalign(), aligned_alloc(), memalign(),
+ * valloc(), and the aligned C++ operator new (new_delete.cpp).
+ *
+ * Every block payload is already MALLOC_ALIGN aligned, so smaller
+ * alignments are plain mallocs. Larger ones over-allocate by the alignment
+ * plus two headers, then cut the block down to the aligned part:
+ * - pooled classes: the bytes in front of the aligned payload become a
+ *   block of their own, and so does the unused tail; both are released at
+ *   once, exactly like a free() of a block of that size
+ * - LARGE: the zone's only block simply starts further in (zone->blocks
+ *   points at it); the gap in front of it is never handed out
+ *
+ * The result is an ordinary block: free(), realloc() and show_alloc_mem()
+ * need nothing special for it.
+ */
+
+static int is_power_of_two(const size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+/* Bytes requested from a class for an aligned block (0 on overflow). */
+static size_t padded_size(const size_t aligned_size, const size_t alignment) {
+    if (aligned_size > SIZE_MAX - alignment - 2 * BLOCK_HDR_SIZE)
+        return 0;
+    return aligned_size + alignment + 2 * BLOCK_HDR_SIZE;
+}
+
+/*
+ * Class an allocation of `size` bytes aligned to `alignment` is served from,
+ * so sized deletes can go straight to it. -1 if it cannot be allocated.
+ */
+int aligned_class_of(const size_t size, const size_t alignment) {
+    const size_t requested = size == 0 ? 1 : size;
+
+    if (requested > SIZE_MAX - (size_t)15u)
+        return -1;
+    if (alignment <= MALLOC_ALIGN)
+        return get_zone_type(align_size(requested));
+
+    const size_t padded = padded_size(align_size(requested), alignment);
+    return padded ? (int)get_zone_type(padded) : -1;
+}
+
+/* Hand a used fragment back to its class, as free() would (caller holds the class lock). */
+static void release_fragment(const t_zone_type type, t_block *block) {
+    /* Its header goes back too: the block it was cut from was counted whole. */
+    SHM_STAT_SUB(classes[type].bytes_in_use, block_size(block) + BLOCK_HDR_SIZE);
+    if (type == MEDIUM)
+        medium_free_nolock(block);
+    else
+        defer_block(type, block);
+}
+
+/*
+ * Cut a used pooled block so its payload starts at `aligned_ptr` and holds
+ * `size` bytes; the leading and trailing leftovers are released. Returns
+ * the new block (caller holds g_zone_locks[type]).
+ */
+static t_block *trim_pooled(const t_zone_type type, t_block *block, char *aligned_ptr,
+                            const size_t size) {
+    t_block *aligned_block = (t_block *)(aligned_ptr - BLOCK_HDR_SIZE);
+
+    if (aligned_block != block) {
+        const size_t front = (size_t)((char *)aligned_block - (char *)block) - BLOCK_HDR_SIZE;
+        const size_t rest  = block_size(block) - front - BLOCK_HDR_SIZE;
+
+        block_init(aligned_block, front, rest, type, BLOCK_USED);
+        block_after(aligned_block)->prev_size = rest;
+        block_set_size(block, front);
+        release_fragment(type, block);
+    }
+
+    const size_t total = block_size(aligned_block);
+
+    if (total >= size + BLOCK_HDR_SIZE + MALLOC_ALIGN) {
+        t_block *    tail      = (t_block *)(aligned_ptr + size);
+        const size_t tail_size = total - size - BLOCK_HDR_SIZE;
+
+        block_init(tail, size, tail_size, type, BLOCK_USED);
+        block_after(tail)->prev_size = tail_size;
+        block_set_size(aligned_block, size);
+        release_fragment(type, tail);
+    }
+    return aligned_block;
+}
+
+/* LARGE: map with room for the alignment and start the block at the aligned spot. */
+static void *aligned_large(const size_t requested_size, const size_t aligned_size,
+                           const size_t alignment) {
+    t_zone *zone = map_zone(LARGE, aligned_size + alignment, 0);
+
+    if (!zone) {
+        debug_log_event("memalign", NULL, aligned_size, "failed: mmap");
+        return NULL;
+    }
+
+    const uintptr_t payload = (uintptr_t)zone->blocks + BLOCK_HDR_SIZE;
+    const uintptr_t aligned = (payload + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+    if (aligned != payload) {
+        t_block *    block = (t_block *)(aligned - BLOCK_HDR_SIZE);
+        t_block *    fence = block_after(zone->blocks);
+        const size_t size  = (size_t)((uintptr_t)fence - aligned);
+
+        block_init(block, 0, size, LARGE, BLOCK_USED);
+        fence->prev_size = size;
+        zone->blocks = block;
+        zone->free_hint = block;
+    }
+    return publish_large(zone, requested_size, aligned_size);
+}
+
+/*
+ * Allocate `size` bytes at a multiple of `alignment` (a power of two).
+ * Returns NULL on failure; the caller validates `alignment`.
+ */
+void *aligned_alloc_core(const size_t alignment, const size_t size) {
+    if (alignment <= MALLOC_ALIGN)
+        return malloc_core(size);
+
+    const size_t requested_size = size == 0 ? (size_t)1u : size;
+
+    if (requested_size > SIZE_MAX - (size_t)15u) {
+        debug_log_event("memalign", NULL, requested_size, "failed: size overflow");
+        return NULL;
+    }
+
+    const size_t aligned_size = align_size(requested_size);
+    const size_t padded       = padded_size(aligned_size, alignment);
+
+    if (padded == 0) {
+        debug_log_event("memalign", NULL, requested_size, "failed: size overflow");
+        return NULL;
+    }
+
+    const t_zone_type type = get_zone_type(padded);
+
+    if (type == LARGE)
+        return aligned_large(requested_size, aligned_size, alignment);
+
+    lock_zone_class(type);
+    char *ptr = malloc_nolock(type, requested_size, padded);
+    if (ptr) {
+        /* A leading fragment needs a header and MALLOC_ALIGN payload bytes. */
+        uintptr_t aligned = (uintptr_t)ptr;
+
+        if (aligned & (alignment - 1))
+            aligned = ((uintptr_t)ptr + BLOCK_HDR_SIZE + MALLOC_ALIGN + alignment - 1)
+                      & ~(uintptr_t)(alignment - 1);
+        trim_pooled(type, (t_block *)(ptr - BLOCK_HDR_SIZE), (char *)aligned, aligned_size);
+        ptr = (char *)aligned;
+    }
+    unlock_zone_class(type);
+
+    if (ptr && g_malloc_scribble)
+        mem_fill(ptr, 0xAA, requested_size);
+    debug_log_event("memalign", ptr, alignment, ptr ? "ok" : "failed: malloc");
+    return ptr;
+}
+
+/*
+ * free() with the class already known (sized C++ delete). A wrong hint
+ * only costs the probe: the pointer then goes through free_core().
+ */
+void free_hinted_core(void *ptr, const int type) {
+    if (!ptr || type < 0) {
+        free_core(ptr);
+        return;
+    }
+
+    t_zone *unmap_zone = NULL;
+
+    lock_zone_class((t_zone_type)type);
+    const int owned = free_nolock((t_zone_type)type, ptr, &unmap_zone);
+    unlock_zone_class((t_zone_type)type);
+
+    if (unmap_zone)
+        release_large_zone(unmap_zone);
+    if (!owned)
+        free_core(ptr);
+}
+
+int posix_memalign(void **memptr, const size_t alignment, const size_t size) {
+    if (!is_power_of_two(alignment) || alignment % sizeof(void *) != 0)
+        return EINVAL;
+
+    void *ptr = aligned_alloc_core(alignment, size);
+    if (!ptr)
+        return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+
+void *aligned_alloc(const size_t alignment, const size_t size) {
+    if (!is_power_of_two(alignment)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return aligned_alloc_core(alignment, size);
+}
+
+void *memalign(const size_t alignment, const size_t size) {
+    return aligned_alloc(alignment, size);
+}
+
+void *valloc(const size_t size) {
+    return aligned_alloc_core((size_t)getpagesize(), size);
+}
@@ -0,0 +1,154 @@
+#include <cstddef>
+#include <new>
+
+extern "C" {
+#include "ft_malloc.h"
+}
+
+/*
+ * Replaceable C++ allocation functions.
+ *
+ * Without these, `new` and `delete` reach ft_malloc through libstdc++'s
+ * own operators, which call malloc() / free(): sized delete loses its
+ * size, and aligned new goes through aligned_alloc(). Here every overload
+ * calls straight into the allocator core:
+ * - new: malloc_core() (or the timed wrapper), retried through the
+ *   new_handler loop on failure; std::bad_alloc once there is no handler
+ * - aligned new: aligned_alloc_core()
+ * - sized delete: the size (and alignment) give the owning class, so only
+ *   that class is locked (free_hinted_core())
+ * - nothrow variants: same paths, nullptr instead of an exception
+ */
+
+namespace {
+
+void *alloc_once(const std::size_t size, const std::size_t alignment) {
+    if (alignment > MALLOC_ALIGN)
+        return aligned_alloc_core(alignment, size);
+    if (g_malloc_latency)
+        return latency_malloc(size);
+    return malloc_core(size);
+}
+
+/* [new.delete.single]: call the new_handler until it succeeds or there is none. */
+void *new_impl(const std::size_t size, const std::size_t alignment) {
+    for (;;) {
+        void *ptr = alloc_once(size, alignment);
+        if (ptr)
+            return ptr;
+
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *new_nothrow_impl(const std::size_t size, const std::size_t alignment) noexcept {
+    try {
+        return new_impl(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void delete_impl(void *ptr) noexcept {
+    if (g_malloc_latency)
+        latency_free(ptr);
+    else
+        free_core(ptr);
+}
+
+void delete_sized_impl(void *ptr, const std::size_t size, const std::size_t alignment) noexcept {
+    if (g_malloc_latency)
+        latency_free(ptr);
+    else
+        free_hinted_core(ptr, aligned_class_of(size, alignment));
+}
+
+} // namespace
+
+/* Plain and array new. */
+void *operator new(std::size_t size) {
+    return new_impl(size, 0);
+}
+
+void *operator new[](std::size_t size) {
+    return new_impl(size, 0);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return new_nothrow_impl(size, 0);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return new_nothrow_impl(size, 0);
+}
+
+/* Aligned new (over-aligned types, C++17). */
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return new_impl(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return new_impl(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return new_nothrow_impl(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return new_nothrow_impl(size, static_cast<std::size_t>(alignment));
+}
+
+/* Plain and array delete. */
+void operator delete(void *ptr) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    delete_impl(ptr);
+}
+
+/* Sized delete (C++14): straight to the owning class. */
+void operator delete(void *ptr, std::size_t size) noexcept {
+    delete_sized_impl(ptr, size, 0);
+}
+
+void operator delete[](void *ptr, std::size_t size) noexcept {
+    delete_sized_impl(ptr, size, 0);
+}
+
+/* Aligned delete. */
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    delete_impl(ptr);
+}
+
+void operator delete(void *ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    delete_sized_impl(ptr, size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    delete_sized_impl(ptr, size, static_cast<std::size_t>(alignment));
+}
@@ -0,0 +1,303 @@
+#include "ft_malloc.h"
+
+/*
+ * Offset-linked arenas: the allocator behind persistent heaps (pheap.c)
+ * and cross-process heaps (shm_heap.c).
+ *
+ * The arena is one mapping: a t_oarena header, then a block area ending on
+ * a fence, with the same t_block headers as the zones. Nothing in it is a
+ * pointer. Neighbors are found from the sizes in the headers, and free
+ * blocks sit on OARENA_BINS size-binned lists whose links are block offsets
+ * stored in the first 16 payload bytes. The mapping may therefore land at a
+ * different address every time it is mapped.
+ *
+ * Crash consistency: every metadata word (header fields, block headers,
+ * free-list links) is changed through logged_store(), which first appends
+ * the word's old value to the undo log in the header. An operation ends by
+ * clearing the log. If the process dies half-way, the log still holds the
+ * words it changed, and oarena_recover() puts them back, in reverse order:
+ * the arena is exactly as it was before the interrupted call. Payload bytes
+ * are never logged.
+ *
+ * No locking here: callers serialize access to an arena.
+ */
+
+#define OARENA_MIN_SPLIT (BLOCK_HDR_SIZE + MALLOC_ALIGN) /* Smallest remainder worth a block. */
+
+/* Free-list links, in the first payload bytes of a free block. */
+typedef struct s_oarena_link {
+    uint64_t next; /* Block offset, 0 at the end of the list. */
+    uint64_t prev; /* Block offset, 0 for the list head. */
+} t_oarena_link;
+
+static inline t_block *block_at(const t_oarena *arena, const uint64_t offset) {
+    return (t_block *)((char *)arena + offset);
+}
+
+static inline uint64_t offset_of(const t_oarena *arena, const void *ptr) {
+    return (uint64_t)((const char *)ptr - (const char *)arena);
+}
+
+static inline t_oarena_link *link_of(const t_block *block) {
+    return (t_oarena_link *)((char *)block + BLOCK_HDR_SIZE);
+}
+
+/* Header words are size_t; arenas are only built where that is 64 bits. */
+static inline uint64_t *word_of(size_t *field) {
+    return (uint64_t *)field;
+}
+
+static inline uint64_t block_word(const size_t size, const int state) {
+    return (uint64_t)size | (uint64_t)state;
+}
+
+/* Bin of a free block: floor(log2(payload / MALLOC_ALIGN)), capped. */
+static int bin_of(const size_t size) {
+    const size_t units = size / MALLOC_ALIGN;
+    const int    bin   = 63 - __builtin_clzl(units ? units : 1);
+
+    return bin < OARENA_BINS ? bin : OARENA_BINS - 1;
+}
+
+/*
+ * Change one metadata word. The undo entry is complete before it counts,
+ * and it counts before the word changes, so the log always covers every
+ * word that differs from the state before the operation.
+ */
+static void logged_store(t_oarena *arena, uint64_t *word, const uint64_t value) {
+    const uint64_t count = arena->log_count;
+
+    if (*word == value)
+        return;
+    arena->log[count].offset = offset_of(arena, word);
+    arena->log[count].value  = *word;
+    __atomic_store_n(&arena->log_count, count + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+}
+
+/* End of an operation: its writes are now the state to keep. */
+static void commit(t_oarena *arena) {
+    __atomic_store_n(&arena->log_count, 0, __ATOMIC_RELEASE);
+}
+
+static void unlink_free(t_oarena *arena, const t_block *block) {
+    const t_oarena_link *link = link_of(block);
+
+    if (link->prev)
+        logged_store(arena, &link_of(block_at(arena, link->prev))->next, link->next);
+    else
+        logged_store(arena, &arena->bins[bin_of(block_size(block))], link->next);
+    if (link->next)
+        logged_store(arena, &link_of(block_at(arena, link->next))->prev, link->prev);
+}
+
+static void insert_free(t_oarena *arena, t_block *block) {
+    const uint64_t offset = offset_of(arena, block);
+    uint64_t *     head   = &arena->bins[bin_of(block_size(block))];
+    t_oarena_link *link   = link_of(block);
+
+    logged_store(arena, &link->next, *head);
+    logged_store(arena, &link->prev, 0);
+    if (*head)
+        logged_store(arena, &link_of(block_at(arena, *head))->prev, offset);
+    logged_store(arena, head, offset);
+}
+
+/*
+ * Lay out an empty arena over `size` bytes (a multiple of MALLOC_ALIGN):
+ * one free block up to the fence. The magic is written last, so an arena
+ * interrupted while formatting is never taken for a valid one.
+ * Returns 0 if `size` is too small.
+ */
+int oarena_format(t_oarena *arena, const size_t size, const uint64_t magic) {
+    const size_t first = ALIGN_UP(sizeof(t_oarena));
+
+    if (size < first + 2 * BLOCK_HDR_SIZE + MALLOC_ALIGN || size % MALLOC_ALIGN)
+        return 0;
+
+    ft_memset(arena, 0, first);
+    arena->size  = size;
+    arena->first = first;
+
+    t_block *    block   = block_at(arena, first);
+    const size_t payload = size - first - 2 * BLOCK_HDR_SIZE;
+
+    block_init(block, 0, payload, TINY, BLOCK_FREE);
+    block_init(block_after(block), payload, 0, TINY, BLOCK_USED);
+    link_of(block)->next         = 0;
+    link_of(block)->prev         = 0;
+    arena->bins[bin_of(payload)] = first;
+
+    __atomic_store_n(&arena->magic, magic, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Header sanity check for an existing arena mapped over `size` bytes. */
+int oarena_valid(const t_oarena *arena, const size_t size, const uint64_t magic) {
+    return arena->magic == magic && arena->size == size
+           && arena->first == ALIGN_UP(sizeof(t_oarena)) && arena->log_count <= OARENA_LOG_MAX;
+}
+
+/* Undo an operation that never finished (no-op when the log is empty). */
+void oarena_recover(t_oarena *arena) {
+    size_t count = arena->log_count;
+
+    if (count == 0)
+        return;
+    debug_log_event("oarena_recover", arena, count, "rolling back");
+    while (count-- > 0) {
+        const t_oarena_entry *entry = &arena->log[count];
+
+        if (entry->offset < arena->size && entry->offset % sizeof(uint64_t) == 0)
+            *(uint64_t *)((char *)arena + entry->offset) = entry->value;
+    }
+    commit(arena);
+}
+
+/*
+ * Allocate `size` bytes. Returns the payload offset, 0 if no free block
+ * is large enough. The smallest bin that can hold the request is searched
+ * first-fit; any block of a higher bin fits.
+ */
+size_t oarena_alloc(t_oarena *arena, const size_t size) {
+    const size_t requested = size == 0 ? MALLOC_ALIGN : size;
+
+    if (requested > arena->size)
+        return 0;
+
+    const size_t aligned = ALIGN_UP(requested);
+    t_block *    block   = NULL;
+
+    for (int bin = bin_of(aligned); bin < OARENA_BINS && !block; bin++) {
+        for (uint64_t offset = arena->bins[bin]; offset; offset = link_of(block_at(arena, offset))->next) {
+            if (block_size(block_at(arena, offset)) >= aligned) {
+                block = block_at(arena, offset);
+                break;
+            }
+        }
+    }
+    if (!block)
+        return 0;
+
+    const size_t total = block_size(block);
+
+    unlink_free(arena, block);
+    if (total >= aligned + OARENA_MIN_SPLIT) {
+        t_block *    rest      = (t_block *)((char *)block + BLOCK_HDR_SIZE + aligned);
+        const size_t rest_size = total - aligned - BLOCK_HDR_SIZE;
+
+        logged_store(arena, word_of(&rest->prev_size), aligned);
+        logged_store(arena, word_of(&rest->info), block_word(rest_size, BLOCK_FREE));
+        logged_store(arena, word_of(&block_after(rest)->prev_size), rest_size);
+        logged_store(arena, word_of(&block->info), block_word(aligned, BLOCK_USED));
+        insert_free(arena, rest);
+    } else
+        logged_store(arena, word_of(&block->info), block_word(total, BLOCK_USED));
+    logged_store(arena, &arena->in_use, arena->in_use + block_size(block));
+    commit(arena);
+
+    return (size_t)offset_of(arena, block) + BLOCK_HDR_SIZE;
+}
+
+/*
+ * Release the block whose payload is at `offset`, merged with free
+ * neighbors. Returns 0 (and changes nothing) if `offset` is not the
+ * payload of a used block.
+ */
+int oarena_free(t_oarena *arena, const size_t offset) {
+    if (offset < arena->first + BLOCK_HDR_SIZE || offset >= arena->size
+        || offset % MALLOC_ALIGN != 0)
+        return 0;
+
+    t_block *block = block_at(arena, offset - BLOCK_HDR_SIZE);
+    size_t   size  = block_size(block);
+
+    if (block_state(block) != BLOCK_USED || size == 0
+        || size > arena->size - offset - BLOCK_HDR_SIZE || block_after(block)->prev_size != size)
+        return 0;
+
+    logged_store(arena, &arena->in_use, arena->in_use - size);
+
+    t_block *next = block_after(block);
+    if (block_size(next) != 0 && block_state(next) == BLOCK_FREE) {
+        unlink_free(arena, next);
+        size += BLOCK_HDR_SIZE + block_size(next);
+    }
+
+    t_block *prev = block_prev(block);
+    if (prev && block_state(prev) == BLOCK_FREE) {
+        unlink_free(arena, prev);
+        size += BLOCK_HDR_SIZE + block_size(prev);
+        block = prev;
+    }
+
+    logged_store(arena, word_of(&block->info), block_word(size, BLOCK_FREE));
+    logged_store(arena, word_of(&block_after(block)->prev_size), size);
+    insert_free(arena, block);
+    commit(arena);
+    return 1;
+}
+
+void oarena_set_root(t_oarena *arena, const size_t offset) {
+    logged_store(arena, &arena->root, offset);
+    commit(arena);
+}
+
+/*
+ * Full consistency walk: block chain, fence, free lists and byte count.
+ * Returns 1 if everything agrees.
+ */
+int oarena_check(const t_oarena *arena) {
+    uint64_t offset      = arena->first;
+    size_t   prev_size   = 0;
+    size_t   free_blocks = 0;
+    size_t   used_bytes  = 0;
+    int      prev_free   = 0;
+
+    if (arena->log_count != 0)
+        return 0;
+    for (;;) {
+        if (offset > arena->size - BLOCK_HDR_SIZE)
+            return 0;
+
+        const t_block *block = block_at(arena, offset);
+        const size_t   size  = block_size(block);
+
+        if (block->prev_size != prev_size)
+            return 0;
+        if (size == 0)
+            break;
+        if (block_state(block) == BLOCK_FREE) {
+            /* Two free neighbors should have been merged. */
+            if (prev_free)
+                return 0;
+            free_blocks++;
+            prev_free = 1;
+        } else if (block_state(block) == BLOCK_USED) {
+            used_bytes += size;
+            prev_free = 0;
+        } else
+            return 0;
+        prev_size = size;
+        offset += BLOCK_HDR_SIZE + size;
+    }
+    if (offset != arena->size - BLOCK_HDR_SIZE || used_bytes != arena->in_use)
+        return 0;
+
+    size_t listed = 0;
+
+    for (int bin = 0; bin < OARENA_BINS; bin++) {
+        uint64_t prev = 0;
+
+        for (offset = arena->bins[bin]; offset; offset = link_of(block_at(arena, offset))->next) {
+            const t_block *block = block_at(arena, offset);
+
+            if (offset < arena->first || offset >= arena->size || ++listed > free_blocks
+                || block_state(block) != BLOCK_FREE || bin_of(block_size(block)) != bin
+                || link_of(block)->prev != prev)
+                return 0;
+            prev = offset;
+        }
+    }
+    return listed == free_blocks;
+}
@@ -0,0 +1,92 @@
+#include <errno.h>
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Buffered report output.
+ *
+ * The show functions used to emit one write() per field (per character in
+ * hexdumps). They now format into a t_outbuf, which only reaches the kernel
+ * once OUTBUF_SIZE bytes are pending, or on outbuf_flush(). Reports format
+ * from snapshots after the allocator locks are released, so a slow reader
+ * on the other end of the fd never stalls allocating threads.
+ *
+ * A failed write (closed pipe, full non-blocking fd) drops the rest of the
+ * report instead of retrying forever.
+ */
+
+void outbuf_init(t_outbuf *out, const int fd) {
+    out->fd     = fd;
+    out->len    = 0;
+    out->failed = 0;
+}
+
+void outbuf_flush(t_outbuf *out) {
+    size_t done = 0;
+
+    while (!out->failed && done < out->len) {
+        const ssize_t n = write(out->fd, out->data + done, out->len - done);
+
+        if (n > 0)
+            done += (size_t)n;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else
+            out->failed = 1;
+    }
+    out->len = 0;
+}
+
+void outbuf_write(t_outbuf *out, const char *data, size_t len) {
+    while (len > 0) {
+        if (out->len == OUTBUF_SIZE)
+            outbuf_flush(out);
+
+        size_t chunk = OUTBUF_SIZE - out->len;
+        if (chunk > len)
+            chunk = len;
+        ft_memcpy(out->data + out->len, data, chunk);
+        out->len += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void outbuf_putchar(t_outbuf *out, const char c) {
+    if (out->len == OUTBUF_SIZE)
+        outbuf_flush(out);
+    out->data[out->len++] = c;
+}
+
+void outbuf_putstr(t_outbuf *out, const char *str) {
+    if (str)
+        outbuf_write(out, str, ft_strlen(str));
+}
+
+void outbuf_putsize(t_outbuf *out, size_t value) {
+    char   digits[32];
+    size_t index = sizeof(digits);
+
+    do {
+        digits[--index] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    outbuf_write(out, digits + index, sizeof(digits) - index);
+}
+
+/* Same format as ft_putptr_fd(): 0x followed by lowercase hex digits. */
+void outbuf_putptr(t_outbuf *out, const void *ptr) {
+    static const char *hex = "0123456789abcdef";
+    char               digits[2 + 2 * sizeof(uintptr_t)];
+    size_t             index = sizeof(digits);
+    uintptr_t          value = (uintptr_t)ptr;
+
+    do {
+        digits[--index] = hex[value & 0xF];
+        value >>= 4;
+    } while (value > 0);
+    digits[--index] = 'x';
+    digits[--index] = '0';
+    outbuf_write(out, digits + index, sizeof(digits) - index);
+}
@@ -0,0 +1,219 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Persistent heaps: an offset-linked arena (oarena.c) in a file mapped
+ * with MAP_SHARED.
+ *
+ * Everything allocated from the heap lives in the file, so a restarted
+ * process gets its data structures back by reopening it, with no rebuild:
+ * - objects must refer to each other by offset (ft_pheap_offset() /
+ *   ft_pheap_pointer()), since the file may be mapped at another address
+ * - ft_pheap_root() / ft_pheap_set_root() keep the entry point (e.g. the
+ *   head of an index) in the file header
+ * - metadata updates are undo-logged: if the process dies in the middle of
+ *   an allocation or a free, reopening rolls that call back
+ *
+ * Writes reach the page cache as they happen, so a process crash loses
+ * nothing that a call completed. ft_pheap_sync() also flushes them to the
+ * disk, for machine crashes.
+ *
+ * A file is open in one process at a time (flock()); inside it, calls are
+ * serialized by the heap lock.
+ */
+
+#define PHEAP_MAGIC 0x3150414548505446ULL /* "FTPHEAP1" */
+
+struct s_pheap {
+    t_oarena *arena; /* Mapping base. */
+    size_t    size;  /* Mapped (and file) size. */
+    int       fd;    /* Open file, holding the flock(). */
+    t_ft_lock lock;
+};
+
+/*
+ * Size the file on creation; an existing file keeps its own size.
+ * *created tells whether this call sized it (it was empty).
+ */
+static int size_file(const int fd, size_t *size, int *created) {
+    struct stat  st;
+    const size_t page_size = getpagesize();
+
+    *created = 0;
+    if (fstat(fd, &st) != 0)
+        return 0;
+    if (st.st_size > 0) {
+        *size = (size_t)st.st_size;
+        return 1;
+    }
+    *created = 1;
+    if (*size > SIZE_MAX - page_size)
+        return 0;
+    *size = (*size + page_size - 1) / page_size * page_size;
+    /* Blocks are allocated now: a full disk fails here, not as SIGBUS later. */
+    return *size > 0 && posix_fallocate(fd, 0, (off_t)*size) == 0;
+}
+
+/*
+ * Open the heap stored at `path`, creating a `size`-byte one if the file
+ * does not exist or is empty. Returns NULL if the file cannot be opened or
+ * mapped, is already open elsewhere, or does not hold a heap.
+ */
+t_pheap *ft_pheap_open(const char *path, size_t size) {
+    const int fd      = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    int       created = 0;
+
+    if (fd < 0) {
+        debug_log_event("pheap_open", NULL, size, "failed: open");
+        return NULL;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        debug_log_event("pheap_open", NULL, size, "failed: in use");
+        close(fd);
+        return NULL;
+    }
+    if (!size_file(fd, &size, &created)) {
+        debug_log_event("pheap_open", NULL, size, "failed: size");
+        close(fd);
+        return NULL;
+    }
+
+    t_oarena *arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (arena == MAP_FAILED) {
+        debug_log_event("pheap_open", NULL, size, "failed: mmap");
+        close(fd);
+        return NULL;
+    }
+
+    /* Only a file this call sized is formatted: any other file must already be a heap. */
+    const int usable = created ? oarena_format(arena, size, PHEAP_MAGIC)
+                               : oarena_valid(arena, size, PHEAP_MAGIC);
+    t_pheap * heap   = usable ? malloc(sizeof(t_pheap)) : NULL;
+
+    if (!heap) {
+        debug_log_event("pheap_open", arena, size, usable ? "failed: malloc" : "failed: not a heap");
+        munmap(arena, size);
+        close(fd);
+        return NULL;
+    }
+    oarena_recover(arena);
+
+    heap->arena = arena;
+    heap->size  = size;
+    heap->fd    = fd;
+    ft_memset(&heap->lock, 0, sizeof(heap->lock));
+
+    debug_log_event("pheap_open", arena, size, "ok");
+    return heap;
+}
+
+/* Unmap the heap; its contents stay in the file. */
+void ft_pheap_close(t_pheap *heap) {
+    if (!heap)
+        return;
+    debug_log_event("pheap_close", heap->arena, heap->size, "ok");
+    munmap(heap->arena, heap->size);
+    close(heap->fd);
+    free(heap);
+}
+
+void *ft_pheap_malloc(t_pheap *heap, const size_t size) {
+    if (!heap)
+        return NULL;
+
+    ft_lock(&heap->lock);
+    const size_t offset = oarena_alloc(heap->arena, size);
+    ft_unlock(&heap->lock);
+
+    if (!offset) {
+        debug_log_event("pheap_malloc", NULL, size, "failed: heap full");
+        return NULL;
+    }
+
+    void *ptr = (char *)heap->arena + offset;
+
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, size);
+    debug_log_event("pheap_malloc", ptr, size, "ok");
+    return ptr;
+}
+
+/*
+ * Release a block of the heap. Freed bytes are not scribbled: a free that
+ * a crash rolls back must find its block intact.
+ */
+void ft_pheap_free(t_pheap *heap, void *ptr) {
+    if (!heap || !ptr)
+        return;
+
+    const size_t offset = ft_pheap_offset(heap, ptr);
+
+    ft_lock(&heap->lock);
+    const int freed = offset && oarena_free(heap->arena, offset);
+    ft_unlock(&heap->lock);
+
+    debug_log_event("pheap_free", ptr, 0, freed ? "ok" : "ignored: invalid pointer or double free");
+}
+
+/* Root object recorded in the file, NULL if none was set. */
+void *ft_pheap_root(t_pheap *heap) {
+    if (!heap)
+        return NULL;
+
+    ft_lock(&heap->lock);
+    const size_t offset = heap->arena->root;
+    ft_unlock(&heap->lock);
+
+    return ft_pheap_pointer(heap, offset);
+}
+
+void ft_pheap_set_root(t_pheap *heap, void *ptr) {
+    if (!heap)
+        return;
+
+    ft_lock(&heap->lock);
+    oarena_set_root(heap->arena, ft_pheap_offset(heap, ptr));
+    ft_unlock(&heap->lock);
+}
+
+/* Position-independent reference to `ptr` (0 for NULL or a pointer outside the heap). */
+size_t ft_pheap_offset(const t_pheap *heap, const void *ptr) {
+    const char *base = (const char *)heap->arena;
+
+    if (!ptr || (const char *)ptr < base || (const char *)ptr >= base + heap->size)
+        return 0;
+    return (size_t)((const char *)ptr - base);
+}
+
+/* Pointer for an offset in this mapping (NULL for 0 or an offset past the heap). */
+void *ft_pheap_pointer(const t_pheap *heap, const size_t offset) {
+    if (offset == 0 || offset >= heap->size)
+        return NULL;
+    return (char *)heap->arena + offset;
+}
+
+/* Flush the heap to the disk. Returns 0, or -1 if msync() failed. */
+int ft_pheap_sync(t_pheap *heap) {
+    if (!heap || msync(heap->arena, heap->size, MS_SYNC) != 0) {
+        debug_log_event("pheap_sync", heap ? heap->arena : NULL, 0, "failed: msync");
+        return -1;
+    }
+    return 0;
+}
+
+/* Walk the whole heap. Returns 0 if its metadata is consistent, -1 otherwise. */
+int ft_pheap_check(t_pheap *heap) {
+    if (!heap)
+        return -1;
+
+    ft_lock(&heap->lock);
+    const int ok = oarena_check(heap->arena);
+    ft_unlock(&heap->lock);
+
+    return ok ? 0 : -1;
+}
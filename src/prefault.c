@@ -0,0 +1,142 @@
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Page prefaulting for latency-sensitive programs.
+ *
+ * A fresh zone costs one page fault per page on first touch, which lands
+ * inside whatever allocation happens to touch it first. Two opt-in knobs
+ * move that cost out of the hot path:
+ * - prefault mode (MallocPrefault=1 or mallopt(M_FT_PREFAULT, 1)): new
+ *   pooled zones are mapped with MAP_POPULATE (or touched page by page
+ *   where that flag does not exist)
+ * - warming (MallocWarm=<size> or mallopt(M_FT_WARM, bytes)): map and
+ *   prefault zones up front until every pooled class owns at least that
+ *   many bytes, so the first allocations never fault
+ *
+ * LARGE zones are never prefaulted: they are sized for one request and
+ * the caller is about to touch them anyway.
+ */
+
+int g_malloc_prefault = 0;
+
+/* Fault every page of a fresh private mapping in (MAP_POPULATE fallback). */
+void prefault_pages(void *ptr, const size_t size) {
+    const size_t   page_size = getpagesize();
+    volatile char *bytes     = (volatile char *)ptr;
+
+    for (size_t offset = 0; offset < size; offset += page_size)
+        bytes[offset] = 0;
+}
+
+/*
+ * Fault in a zone that may already hold live blocks. Writing to it is not
+ * an option (its owners may be using it), so this needs the kernel to do
+ * it; without MADV_POPULATE_WRITE the zone is left as it is.
+ */
+static void populate_live_zone(const t_zone *zone) {
+#ifdef MADV_POPULATE_WRITE
+    madvise((void *)zone, zone->size, MADV_POPULATE_WRITE);
+#else
+    (void)zone;
+#endif
+}
+
+/*
+ * Make sure every pooled class owns at least `bytes` of prefaulted zones.
+ * Zones that already exist (e.g. mapped by library constructors before
+ * main()) count too, and are faulted in as well.
+ * Zones mapped here count toward zone growth like any other.
+ * Returns 1 on success, 0 if a mapping failed.
+ */
+int malloc_warm(const size_t bytes) {
+    int ok = 1;
+
+    for (int type = TINY; type < LARGE; type++) {
+        lock_zone_class((t_zone_type)type);
+
+        size_t mapped = 0;
+        for (const t_zone *zone = g_zones[type]; zone && mapped < bytes; zone = zone->next) {
+            populate_live_zone(zone);
+            mapped += zone->size;
+        }
+
+        while (mapped < bytes) {
+            t_zone *zone = request_new_zone(&g_zones[type], &g_zone_counts[type],
+                                            (t_zone_type)type, 0);
+            if (!zone) {
+                ok = 0;
+                break;
+            }
+            /* Already populated by map_zone() in prefault mode. */
+            if (!g_malloc_prefault)
+                prefault_pages(zone, zone->size);
+            if (type == MEDIUM)
+                medium_adopt_zone_nolock(zone);
+            mapped += zone->size;
+        }
+
+        unlock_zone_class((t_zone_type)type);
+    }
+
+    debug_log_event("warm", NULL, bytes, ok ? "per pooled class" : "failed: mmap");
+    return ok;
+}
+
+/* "4096", "512K", "64M", "1G" -> bytes (0 when unparsable). */
+size_t parse_byte_size(const char *text) {
+    size_t value = 0;
+
+    if (!text || *text < '0' || *text > '9')
+        return 0;
+    while (*text >= '0' && *text <= '9') {
+        if (value > (SIZE_MAX - 9) / 10)
+            return 0;
+        value = value * 10 + (size_t)(*text++ - '0');
+    }
+
+    size_t shift = 0;
+    if (*text == 'k' || *text == 'K')
+        shift = 10;
+    else if (*text == 'm' || *text == 'M')
+        shift = 20;
+    else if (*text == 'g' || *text == 'G')
+        shift = 30;
+    else if (*text != '\0')
+        return 0;
+
+    if (shift && (*++text != '\0' || value > (SIZE_MAX >> shift)))
+        return 0;
+    return value << shift;
+}
+
+/*
+ * mallopt(): only the ft_malloc specific parameters are supported.
+ * Returns 1 on success, 0 for an unknown parameter or a failure (like glibc).
+ */
+int mallopt(int param, int value) {
+    if (param == M_FT_PREFAULT) {
+        g_malloc_prefault = value != 0;
+        debug_log_event("mallopt", NULL, (size_t)value, "prefault");
+        return 1;
+    }
+    if (param == M_FT_WARM) {
+        if (value < 0)
+            return 0;
+        return malloc_warm((size_t)value);
+    }
+    if (param == M_FT_SHM_STATS)
+        return value != 0 ? shm_stats_enable() : g_shm_stats == NULL;
+    if (param == M_FT_LATENCY)
+        return latency_enable(value);
+    if (param == M_FT_LOCK_PROFILE)
+        return lock_profile_enable(value);
+    if (param == M_FT_ASYNC_UNMAP)
+        return async_unmap_enable(value, value > 1 ? (size_t)value : 0);
+    if (param == M_FT_HOT_SLABS)
+        return hot_slabs_enable(value);
+
+    debug_log_event("mallopt", NULL, (size_t)param, "ignored: unsupported parameter");
+    return 0;
+}
@@ -10,37 +10,30 @@
  */
 static void scribble_new_bytes(void *ptr, size_t old_size, size_t new_size) {
     if (g_malloc_scribble && new_size > old_size)
-        ft_memset((char *)ptr + old_size, 0xAA, new_size - old_size);
+        mem_fill((char *)ptr + old_size, 0xAA, new_size - old_size);
 }
 
 /*
- * Find block metadata from a user pointer.
+ * Probe each class for ptr, starting at its arena class if it has one.
  *
- * Caller must hold g_mutex to prevent list mutations while traversing.
+ * On success the owning class lock is left held for the caller;
+ * on failure no lock is held.
  */
-static t_block *find_block_by_ptr(void *ptr, t_zone **out_zone) {
-    t_zone *zone = g_zones;
-
-    while (zone) {
-        char *start = (char *)zone;
-        char *end   = start + zone->size;
-
-        /* First confirm pointer is within this zone mapping. */
-        if ((char *)ptr >= start && (char *)ptr < end) {
-            t_block *block = zone->blocks;
-
-            while (block) {
-                if ((void *)((char *)block + BLOCK_HDR_SIZE) == ptr) {
-                    *out_zone = zone;
-                    return block;
-                }
-                block = block->next;
-            }
-
-            /* Pointer was in zone range, but not at any block boundary. */
+static t_block *lock_block_by_ptr(void *ptr, t_zone **out_zone) {
+    const int arena_type = arena_class_of(ptr);
+
+    for (int type = arena_type >= 0 ? arena_type : 0; type < ZONE_TYPE_COUNT; type++) {
+        lock_zone_class((t_zone_type)type);
+
+        /* NULL when ptr is in a zone's range, but not at any block boundary. */
+        t_block *block = find_class_block((t_zone_type)type, ptr, out_zone, NULL);
+        if (block)
+            return block;
+
+        unlock_zone_class((t_zone_type)type);
+        /* An arena pointer can only belong to that class. */
+        if (arena_type >= 0)
             break;
-        }
-        zone = zone->next;
     }
     return NULL;
 }
@@ -50,21 +43,24 @@ static t_block *find_block_by_ptr(void *ptr, t_zone **out_zone) {
  *
  * Returns 1 on success, 0 if expansion in place is impossible.
  */
-static int try_merge_next(t_block *block, size_t need) {
-    t_block *next = block->next;
+static int try_merge_next(t_zone *zone, t_block *block, size_t need) {
+    const t_block *next = block_next(block);
 
     /* Must have an adjacent free neighbor to expand without moving. */
-    if (!next || !next->free)
+    if (!next || block_state(next) != BLOCK_FREE)
         return 0;
 
     /* Compute payload size after hypothetical merge. */
-    size_t merged = block->size + BLOCK_HDR_SIZE + next->size;
+    size_t merged = block_size(block) + BLOCK_HDR_SIZE + block_size(next);
     if (merged < need)
         return 0;
 
+    /* The neighbor may be the zone's first-fit hint: it is about to be absorbed. */
+    if (zone->free_hint > block)
+        zone->free_hint = block;
+
     /* Commit merge and re-split so final payload is close to requested size. */
     coalesce_right(block);
-    block->free = 0;
     split_block(block, need);
     return 1;
 }
@@ -76,14 +72,14 @@ static int try_merge_next(t_block *block, size_t need) {
  * - grow/shrink in place when possible
  * - otherwise allocate-copy-free
  */
-void *realloc(void *ptr, size_t size) {
+void *realloc_core(void *ptr, size_t size) {
     if (!ptr) {
         debug_log_event("realloc", NULL, size, "acts as malloc");
-        return malloc(size);
+        return malloc_core(size);
     }
     if (size == 0) {
         debug_log_event("realloc", ptr, 0, "acts as free");
-        free(ptr);
+        free_core(ptr);
         return NULL;
     }
 
@@ -95,18 +91,18 @@ void *realloc(void *ptr, size_t size) {
 
     size_t aligned_size = align_size(size);
 
-    pthread_mutex_lock(&g_mutex);
-
-    /* Validate ptr and recover metadata. */
+    /* Validate ptr and recover metadata (owning class lock held on success). */
     t_zone * zone  = NULL;
-    t_block *block = find_block_by_ptr(ptr, &zone);
-    if (!block || block->free || !zone) {
-        pthread_mutex_unlock(&g_mutex);
+    t_block *block = lock_block_by_ptr(ptr, &zone);
+    if (!block || block_state(block) != BLOCK_USED) {
+        if (block)
+            unlock_zone_class(zone->type);
         debug_log_event("realloc", ptr, size, "failed: invalid pointer");
         return NULL;
     }
 
-    size_t old_size = block->size;
+    const t_zone_type src_type = zone->type;
+    size_t            old_size = block_size(block);
 
     /*
      * Shrink/no-op path:
@@ -114,18 +110,27 @@ void *realloc(void *ptr, size_t size) {
      * (Could split here, but not required for correctness.)
      */
     if (aligned_size <= old_size) {
-        pthread_mutex_unlock(&g_mutex);
+        unlock_zone_class(src_type);
         debug_log_event("realloc", ptr, size, "in-place shrink/no-op");
         return ptr;
     }
 
     /*
      * In-place growth path (pooled zones only).
-     * LARGE zones are dedicated mappings and are not expanded this way.
+     * LARGE zones are dedicated mappings and are not expanded this way;
+     * MEDIUM neighbors must also leave the TLSF index when absorbed.
      */
-    if (zone->type != LARGE && try_merge_next(block, aligned_size)) {
-        scribble_new_bytes(ptr, old_size, block->size);
-        pthread_mutex_unlock(&g_mutex);
+    int grown = 0;
+
+    if (src_type == MEDIUM)
+        grown = medium_grow_nolock(block, aligned_size);
+    else if (src_type != LARGE)
+        grown = try_merge_next(zone, block, aligned_size);
+
+    if (grown) {
+        SHM_STAT_ADD(classes[src_type].bytes_in_use, block_size(block) - old_size);
+        scribble_new_bytes(ptr, old_size, block_size(block));
+        unlock_zone_class(src_type);
         debug_log_event("realloc", ptr, size, "in-place growth");
         return ptr;
     }
@@ -136,18 +141,58 @@ void *realloc(void *ptr, size_t size) {
      * - copy old payload
      * - free old block
      */
-    void *new_ptr = malloc_nolock(aligned_size);
+    const t_zone_type dst_type = get_zone_type(aligned_size);
+    void *            new_ptr;
+
+    if (dst_type == LARGE) {
+        /*
+         * A LARGE destination needs its own mmap(), which must not run under
+         * a class lock. The old block stays allocated (it is the caller's),
+         * so its payload can be copied without holding any lock.
+         */
+        unlock_zone_class(src_type);
+        new_ptr = malloc_large(aligned_size, aligned_size);
+        if (!new_ptr) {
+            debug_log_event("realloc", ptr, size, "failed: malloc");
+            return NULL;
+        }
+        mem_copy(new_ptr, ptr, old_size);
+        scribble_new_bytes(new_ptr, old_size, aligned_size);
+        free_core(ptr);
+        debug_log_event("realloc", new_ptr, size, "moved");
+        return new_ptr;
+    }
+
+    /*
+     * Pooled -> pooled move. We only move to grow, so the destination class
+     * is never below the source class: taking dst_type while holding
+     * src_type respects the ascending lock order.
+     */
+    if (dst_type != src_type)
+        lock_zone_class(dst_type);
+
+    new_ptr = malloc_nolock(dst_type, aligned_size, aligned_size);
+    if (new_ptr) {
+        mem_copy(new_ptr, ptr, old_size);
+        scribble_new_bytes(new_ptr, old_size, aligned_size);
+        free_nolock(src_type, ptr, NULL);
+    }
+
+    if (dst_type != src_type)
+        unlock_zone_class(dst_type);
+    unlock_zone_class(src_type);
+
     if (!new_ptr) {
-        pthread_mutex_unlock(&g_mutex);
         debug_log_event("realloc", ptr, size, "failed: malloc");
         return NULL;
     }
-
-    ft_memcpy(new_ptr, ptr, old_size);
-    scribble_new_bytes(new_ptr, old_size, aligned_size);
-    free_nolock(ptr);
-
-    pthread_mutex_unlock(&g_mutex);
     debug_log_event("realloc", new_ptr, size, "moved");
     return new_ptr;
 }
+
+/* Public realloc: timed through the latency histograms when they are on. */
+void *realloc(void *ptr, size_t size) {
+    if (g_malloc_latency)
+        return latency_realloc(ptr, size);
+    return realloc_core(ptr, size);
+}
@@ -0,0 +1,227 @@
+#include <signal.h>
+#include <time.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Asynchronous LARGE unmapping.
+ *
+ * munmap() of a mapping that other threads may have touched sends a TLB
+ * shootdown to every CPU running the process: the freeing thread waits for
+ * all of them. With async unmapping on (MallocAsyncUnmap=1 or
+ * mallopt(M_FT_ASYNC_UNMAP, 1)), a LARGE free() only unlinks the zone and
+ * pushes it on a pending list; a background reclaimer thread unmaps the
+ * list in batches, off the caller's path:
+ * - it wakes every RECLAIM_INTERVAL_MS, or early once RECLAIM_BATCH_BYTES
+ *   are pending (free() only signals when it crosses that mark)
+ * - pending bytes are capped (RECLAIM_DEFAULT_CAP, or the size given to
+ *   MallocAsyncUnmap / mallopt): a free() that would go over the cap
+ *   unmaps by itself, so deferred memory stays bounded
+ *
+ * The thread is started by the first deferred free, with every signal
+ * blocked. After fork() the child has no reclaimer: the next deferred
+ * free in the child starts a new one, which also drains what the child
+ * inherited.
+ */
+
+#define RECLAIM_DEFAULT_CAP (256UL * 1024UL * 1024UL) /* Pending bytes before free() unmaps itself. */
+#define RECLAIM_BATCH_BYTES (16UL * 1024UL * 1024UL)  /* Pending bytes that wake the reclaimer early. */
+#define RECLAIM_INTERVAL_MS 10
+
+int g_async_unmap = 0;
+
+static pthread_mutex_t g_reclaim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_reclaim_cond  = PTHREAD_COND_INITIALIZER;
+
+/* All fields below are protected by g_reclaim_mutex. */
+static t_zone *g_reclaim_list   = NULL; /* Unlinked LARGE zones, linked through zone->next. */
+static size_t  g_reclaim_bytes  = 0;
+static size_t  g_reclaim_zones  = 0;
+static size_t  g_reclaim_cap    = RECLAIM_DEFAULT_CAP;
+static int     g_reclaim_state  = 0;    /* 0 = no thread, 1 = starting, 2 = running. */
+static int     g_reclaim_forked = 0;    /* atfork handlers registered. */
+
+/* Counters for show_alloc_mem_stats(). */
+static size_t g_reclaim_batches   = 0;
+static size_t g_reclaim_unmapped  = 0;
+static size_t g_reclaim_overflows = 0;
+
+/* Detach the pending list (caller holds g_reclaim_mutex). */
+static t_zone *take_pending(void) {
+    t_zone *list = g_reclaim_list;
+
+    g_reclaim_list = NULL;
+    g_reclaim_bytes = 0;
+    g_reclaim_zones = 0;
+    return list;
+}
+
+static void *reclaimer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_reclaim_mutex);
+    for (;;) {
+        while (!g_reclaim_list)
+            pthread_cond_wait(&g_reclaim_cond, &g_reclaim_mutex);
+
+        /* Let a batch build up, unless free() says one is ready. */
+        if (g_reclaim_bytes < RECLAIM_BATCH_BYTES) {
+            struct timespec deadline;
+
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += RECLAIM_INTERVAL_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_reclaim_cond, &g_reclaim_mutex, &deadline);
+        }
+
+        t_zone *list  = take_pending();
+        size_t  count = 0;
+
+        pthread_mutex_unlock(&g_reclaim_mutex);
+        while (list) {
+            t_zone *next = list->next;
+
+            release_zone(list);
+            list = next;
+            count++;
+        }
+        pthread_mutex_lock(&g_reclaim_mutex);
+
+        g_reclaim_batches++;
+        g_reclaim_unmapped += count;
+        debug_log_event("reclaim", NULL, count, "batch unmapped");
+    }
+    return NULL;
+}
+
+/* Fork: nobody may hold the mutex across it; the child has no reclaimer. */
+static void reclaim_prepare(void) {
+    pthread_mutex_lock(&g_reclaim_mutex);
+}
+
+static void reclaim_parent(void) {
+    pthread_mutex_unlock(&g_reclaim_mutex);
+}
+
+static void reclaim_child(void) {
+    g_reclaim_state = 0;
+    pthread_mutex_unlock(&g_reclaim_mutex);
+}
+
+/* Start the reclaimer (no lock held: pthread_create() may allocate). Returns 1 if running. */
+static int start_reclaimer(void) {
+    pthread_mutex_lock(&g_reclaim_mutex);
+    if (g_reclaim_state != 0) {
+        const int running = g_reclaim_state == 2;
+
+        pthread_mutex_unlock(&g_reclaim_mutex);
+        return running;
+    }
+    g_reclaim_state = 1;
+    if (!g_reclaim_forked) {
+        pthread_atfork(reclaim_prepare, reclaim_parent, reclaim_child);
+        g_reclaim_forked = 1;
+    }
+    pthread_mutex_unlock(&g_reclaim_mutex);
+
+    /* The reclaimer must never run a signal handler of the program. */
+    pthread_attr_t attr;
+    pthread_t      thread;
+    sigset_t       all;
+    sigset_t       old;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    const int ok = pthread_create(&thread, &attr, reclaimer_main, NULL) == 0;
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    pthread_mutex_lock(&g_reclaim_mutex);
+    g_reclaim_state = ok ? 2 : 0;
+    pthread_mutex_unlock(&g_reclaim_mutex);
+
+    debug_log_event("reclaim", NULL, 0, ok ? "thread started" : "failed: pthread_create");
+    return ok;
+}
+
+/* Queue an unlinked LARGE zone. Returns 0 when the caller must unmap it itself. */
+static int reclaim_defer(t_zone *zone) {
+    if (__atomic_load_n(&g_reclaim_state, __ATOMIC_RELAXED) != 2 && !start_reclaimer())
+        return 0;
+
+    pthread_mutex_lock(&g_reclaim_mutex);
+    if (g_reclaim_state != 2 || g_reclaim_bytes + zone->size > g_reclaim_cap) {
+        g_reclaim_overflows++;
+        pthread_mutex_unlock(&g_reclaim_mutex);
+        return 0;
+    }
+
+    const int was_below = g_reclaim_bytes < RECLAIM_BATCH_BYTES;
+    const int was_empty = g_reclaim_list == NULL;
+
+    zone->next = g_reclaim_list;
+    g_reclaim_list = zone;
+    g_reclaim_bytes += zone->size;
+    g_reclaim_zones++;
+
+    /* Wake the reclaimer when it sleeps on an empty list or a batch is ready. */
+    const int wake = was_empty || (was_below && g_reclaim_bytes >= RECLAIM_BATCH_BYTES);
+    pthread_mutex_unlock(&g_reclaim_mutex);
+
+    if (wake)
+        pthread_cond_signal(&g_reclaim_cond);
+    return 1;
+}
+
+/* Give back an unlinked LARGE zone: to the reclaimer if async unmapping is on, else now. */
+void release_large_zone(t_zone *zone) {
+    if (g_async_unmap && reclaim_defer(zone))
+        return;
+    release_zone(zone);
+}
+
+/*
+ * Turn async unmapping on or off. `cap` bounds the pending bytes
+ * (0 keeps the current cap). Zones already pending are still unmapped
+ * by the reclaimer. Returns 1.
+ */
+int async_unmap_enable(const int enable, const size_t cap) {
+    pthread_mutex_lock(&g_reclaim_mutex);
+    if (cap > 0)
+        g_reclaim_cap = cap;
+    pthread_mutex_unlock(&g_reclaim_mutex);
+
+    g_async_unmap = enable != 0;
+    debug_log_event("async_unmap", NULL, cap, enable ? "on" : "off");
+    return 1;
+}
+
+/* One stats line: pending work and what the reclaimer has done so far. */
+void show_reclaim_stats(t_outbuf *out) {
+    pthread_mutex_lock(&g_reclaim_mutex);
+    const size_t pending_bytes = g_reclaim_bytes;
+    const size_t pending_zones = g_reclaim_zones;
+    const size_t cap           = g_reclaim_cap;
+    const size_t batches       = g_reclaim_batches;
+    const size_t unmapped      = g_reclaim_unmapped;
+    const size_t overflows     = g_reclaim_overflows;
+    pthread_mutex_unlock(&g_reclaim_mutex);
+
+    outbuf_putstr(out, "ASYNC UNMAP : pending=");
+    outbuf_putsize(out, pending_bytes);
+    outbuf_putstr(out, " bytes (");
+    outbuf_putsize(out, pending_zones);
+    outbuf_putstr(out, " zones) cap=");
+    outbuf_putsize(out, cap);
+    outbuf_putstr(out, " batches=");
+    outbuf_putsize(out, batches);
+    outbuf_putstr(out, " unmapped=");
+    outbuf_putsize(out, unmapped);
+    outbuf_putstr(out, " over_cap=");
+    outbuf_putsize(out, overflows);
+    outbuf_putchar(out, '\n');
+}
@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Bump-pointer regions.
+ *
+ * For data that is never freed object by object (parse trees, per-frame
+ * scratch), a region hands out memory by bumping a cursor: no block header,
+ * no first-fit search. Memory is given back only in bulk, by resetting the
+ * region to a previously taken mark, in O(1).
+ *
+ * Backing memory is a list of mmap()'d chunks. The first chunk also hosts
+ * the t_region handle itself; each new chunk doubles in size (up to
+ * REGION_MAX_CHUNK) so long-lived regions need few mappings. Chunks are
+ * kept across resets and reused by later allocations.
+ *
+ * Like private heaps, regions take no lock (single-threaded use).
+ */
+
+#define REGION_DEFAULT_CHUNK (64UL * 1024UL)
+#define REGION_MAX_CHUNK     (16UL * 1024UL * 1024UL)
+
+#define REGION_CHUNK_HDR_SIZE ALIGN_UP(sizeof(t_region_chunk))
+#define REGION_HDR_SIZE       ALIGN_UP(sizeof(t_region))
+
+static size_t round_to_pages(const size_t size) {
+    const size_t page_size = getpagesize();
+
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+/* Map one chunk able to hold at least `min_payload` bytes after `reserved`. */
+static t_region_chunk *map_chunk(size_t chunk_size, const size_t reserved, const size_t min_payload) {
+    if (chunk_size < reserved + min_payload)
+        chunk_size = reserved + min_payload;
+    chunk_size = round_to_pages(chunk_size);
+
+    void *ptr = mmap(NULL, chunk_size, PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        debug_log_event("region", NULL, chunk_size, "failed: mmap");
+        return NULL;
+    }
+
+    t_region_chunk *chunk = (t_region_chunk *)ptr;
+    chunk->next = NULL;
+    chunk->size = chunk_size;
+
+    debug_log_event("region", chunk, chunk_size, "new chunk");
+    return chunk;
+}
+
+/* First usable byte of a chunk (the first chunk also carries the handle). */
+static char *chunk_start(const t_region *region, t_region_chunk *chunk) {
+    char *start = (char *)chunk + REGION_CHUNK_HDR_SIZE;
+
+    if (chunk == region->first)
+        start += REGION_HDR_SIZE;
+    return start;
+}
+
+static void enter_chunk(t_region *region, t_region_chunk *chunk) {
+    region->current = chunk;
+    region->cursor  = chunk_start(region, chunk);
+    region->limit   = (char *)chunk + chunk->size;
+}
+
+t_region *ft_region_create(size_t chunk_size) {
+    if (chunk_size == 0)
+        chunk_size = REGION_DEFAULT_CHUNK;
+
+    t_region_chunk *chunk = map_chunk(chunk_size, REGION_CHUNK_HDR_SIZE + REGION_HDR_SIZE, 0);
+    if (!chunk)
+        return NULL;
+
+    t_region *region = (t_region *)((char *)chunk + REGION_CHUNK_HDR_SIZE);
+    region->first      = chunk;
+    region->chunk_size = chunk->size;
+    enter_chunk(region, chunk);
+    return region;
+}
+
+/* Align a cursor up to `align` (power of two). */
+static char *align_cursor(char *cursor, const size_t align) {
+    return (char *)(((uintptr_t)cursor + (align - 1)) & ~(uintptr_t)(align - 1));
+}
+
+/*
+ * Slow path: the current chunk is exhausted.
+ *
+ * Reuse the chunks kept from before a reset when the next one is big
+ * enough; otherwise map a new, larger chunk right after the current one.
+ */
+static int advance_chunk(t_region *region, const size_t size, const size_t align) {
+    t_region_chunk *next = region->current->next;
+
+    if (next && chunk_start(region, next) + (align - 1) + size <= (char *)next + next->size) {
+        enter_chunk(region, next);
+        return 1;
+    }
+
+    if (region->chunk_size < REGION_MAX_CHUNK)
+        region->chunk_size *= 2;
+
+    t_region_chunk *chunk = map_chunk(region->chunk_size, REGION_CHUNK_HDR_SIZE, size + align);
+    if (!chunk)
+        return 0;
+
+    chunk->next = next;
+    region->current->next = chunk;
+    enter_chunk(region, chunk);
+    return 1;
+}
+
+/*
+ * Allocate `size` bytes aligned to `align` (0 means MALLOC_ALIGN).
+ * Fast path is a pointer bump; returns NULL for a non power-of-two align.
+ */
+void *ft_region_alloc(t_region *region, size_t size, size_t align) {
+    if (!region)
+        return NULL;
+    if (align == 0)
+        align = MALLOC_ALIGN;
+    if ((align & (align - 1)) != 0 || size > SIZE_MAX / 2) {
+        debug_log_event("region_alloc", NULL, size, "failed: bad size/alignment");
+        return NULL;
+    }
+
+    char *ptr = align_cursor(region->cursor, align);
+
+    if (ptr + size > region->limit) {
+        if (!advance_chunk(region, size, align))
+            return NULL;
+        ptr = align_cursor(region->cursor, align);
+    }
+
+    region->cursor = ptr + size;
+
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, size);
+    return ptr;
+}
+
+/* Remember the current position; everything allocated later can be dropped at once. */
+t_region_mark ft_region_mark(const t_region *region) {
+    t_region_mark mark;
+
+    mark.chunk  = region ? region->current : NULL;
+    mark.cursor = region ? region->cursor : NULL;
+    return mark;
+}
+
+/*
+ * Give pages back to the kernel (lazily with MADV_FREE when available).
+ * Only whole pages inside [start, end) are released.
+ */
+static void release_pages(char *start, char *end) {
+    const uintptr_t page_mask = (uintptr_t)getpagesize() - 1;
+    char *          first     = (char *)(((uintptr_t)start + page_mask) & ~page_mask);
+
+    if (first >= end)
+        return;
+#ifdef MADV_FREE
+    madvise(first, (size_t)(end - first), MADV_FREE);
+#else
+    madvise(first, (size_t)(end - first), MADV_DONTNEED);
+#endif
+}
+
+/*
+ * Roll the region back to `mark` in O(1): only the cursor moves.
+ *
+ * With `release` set, the pages past the mark (rest of the mark's chunk and
+ * every later chunk) are also handed back to the kernel. Chunks stay mapped
+ * either way, ready to be bumped through again.
+ */
+void ft_region_reset(t_region *region, const t_region_mark mark, const int release) {
+    if (!region)
+        return;
+
+    if (mark.chunk) {
+        region->current = mark.chunk;
+        region->cursor  = mark.cursor;
+        region->limit   = (char *)mark.chunk + mark.chunk->size;
+    } else {
+        enter_chunk(region, region->first);
+    }
+
+    if (!release)
+        return;
+
+    release_pages(region->cursor, region->limit);
+    for (t_region_chunk *chunk = region->current->next; chunk; chunk = chunk->next)
+        release_pages((char *)chunk + REGION_CHUNK_HDR_SIZE, (char *)chunk + chunk->size);
+}
+
+/* Unmap every chunk; the handle lives in the first one and goes last. */
+void ft_region_destroy(t_region *region) {
+    if (!region)
+        return;
+
+    t_region_chunk *chunk = region->first->next;
+    while (chunk) {
+        t_region_chunk *next = chunk->next;
+
+        munmap(chunk, chunk->size);
+        chunk = next;
+    }
+    munmap(region->first, region->first->size);
+}
@@ -0,0 +1,259 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Cross-process heaps: an offset-linked arena (oarena.c) in a POSIX shared
+ * memory object, shared by every process that attaches to it.
+ *
+ * Each process maps the object wherever its kernel puts it, so processes
+ * exchange offsets, never pointers: a producer allocates a buffer, fills
+ * it and passes ft_shm_heap_offset() to a consumer (pipe, socket, ring
+ * slot), which reads it in place through ft_shm_heap_pointer() and frees
+ * it when done. No byte of the message is copied.
+ *
+ * Mapping layout: one page of control data (magic, process-shared lock),
+ * then the arena; offsets are relative to the arena. The lock is a robust
+ * process-shared mutex. The allocator's own t_ft_lock sleeps on private
+ * futexes, which only work inside one process. When a process dies holding
+ * it, the next locker gets EOWNERDEAD, rolls the dead process's operation
+ * back with the arena's undo log, and carries on.
+ */
+
+#define SHM_HEAP_MAGIC 0x3150414548534654ULL /* "FTSHEAP1" */
+
+typedef struct s_shm_heap_ctl {
+    uint64_t        magic; /* Written last by the creator: attachers wait for it. */
+    uint64_t        size;  /* Whole mapping, control page included. */
+    pthread_mutex_t lock;  /* Process-shared, robust: serializes every arena call. */
+} t_shm_heap_ctl;
+
+struct s_shm_heap {
+    t_shm_heap_ctl *ctl;   /* Mapping base. */
+    t_oarena *      arena; /* One page in. */
+    size_t          size;  /* Whole mapping. */
+};
+
+/* Lock the arena; a lock left by a dead process is repaired first. Returns 0 on failure. */
+static int lock_heap(t_shm_heap *heap) {
+    const int result = pthread_mutex_lock(&heap->ctl->lock);
+
+    if (result == EOWNERDEAD) {
+        debug_log_event("shm_heap", heap->arena, 0, "previous owner died: recovering");
+        oarena_recover(heap->arena);
+        pthread_mutex_consistent(&heap->ctl->lock);
+        return 1;
+    }
+    return result == 0;
+}
+
+static void unlock_heap(t_shm_heap *heap) {
+    pthread_mutex_unlock(&heap->ctl->lock);
+}
+
+static t_shm_heap *wrap(t_shm_heap_ctl *ctl, const size_t size) {
+    t_shm_heap *heap = malloc(sizeof(t_shm_heap));
+
+    if (!heap)
+        return NULL;
+    heap->ctl   = ctl;
+    heap->arena = (t_oarena *)((char *)ctl + getpagesize());
+    heap->size  = size;
+    return heap;
+}
+
+/*
+ * Create the shared memory object `name` ("/something") holding an empty
+ * heap of about `size` bytes. Fails if the object already exists.
+ */
+t_shm_heap *ft_shm_heap_create(const char *name, const size_t size) {
+    const size_t page_size = getpagesize();
+
+    if (size > SIZE_MAX - 2 * page_size) {
+        debug_log_event("shm_heap_create", NULL, size, "failed: size overflow");
+        return NULL;
+    }
+
+    const size_t map_size = page_size + (size + page_size - 1) / page_size * page_size;
+    const int    fd       = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+
+    if (fd < 0) {
+        debug_log_event("shm_heap_create", NULL, size, "failed: shm_open");
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        debug_log_event("shm_heap_create", NULL, size, "failed: ftruncate");
+        return NULL;
+    }
+
+    t_shm_heap_ctl *ctl = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ctl == MAP_FAILED) {
+        shm_unlink(name);
+        debug_log_event("shm_heap_create", NULL, size, "failed: mmap");
+        return NULL;
+    }
+
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&ctl->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    ctl->size = map_size;
+
+    t_shm_heap *heap = NULL;
+
+    if (oarena_format((t_oarena *)((char *)ctl + page_size), map_size - page_size, SHM_HEAP_MAGIC))
+        heap = wrap(ctl, map_size);
+    if (!heap) {
+        munmap(ctl, map_size);
+        shm_unlink(name);
+        debug_log_event("shm_heap_create", NULL, size, "failed: format");
+        return NULL;
+    }
+    /* Attachers check the magic: publish it after everything else. */
+    __atomic_store_n(&ctl->magic, SHM_HEAP_MAGIC, __ATOMIC_RELEASE);
+
+    debug_log_event("shm_heap_create", heap->arena, map_size, name);
+    return heap;
+}
+
+/* Map an existing heap. Returns NULL if it does not exist or is not ready yet. */
+t_shm_heap *ft_shm_heap_attach(const char *name) {
+    const int   fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    struct stat st;
+
+    if (fd < 0) {
+        debug_log_event("shm_heap_attach", NULL, 0, "failed: shm_open");
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size <= (size_t)getpagesize()) {
+        close(fd);
+        debug_log_event("shm_heap_attach", NULL, 0, "failed: not a heap");
+        return NULL;
+    }
+
+    const size_t    map_size = (size_t)st.st_size;
+    t_shm_heap_ctl *ctl      = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+    if (ctl == MAP_FAILED) {
+        debug_log_event("shm_heap_attach", NULL, map_size, "failed: mmap");
+        return NULL;
+    }
+
+    const t_oarena *arena = (t_oarena *)((char *)ctl + getpagesize());
+    t_shm_heap *    heap  = NULL;
+
+    if (__atomic_load_n(&ctl->magic, __ATOMIC_ACQUIRE) == SHM_HEAP_MAGIC && ctl->size == map_size
+        && oarena_valid(arena, map_size - getpagesize(), SHM_HEAP_MAGIC))
+        heap = wrap(ctl, map_size);
+    if (!heap) {
+        munmap(ctl, map_size);
+        debug_log_event("shm_heap_attach", NULL, map_size, "failed: not a heap");
+        return NULL;
+    }
+
+    debug_log_event("shm_heap_attach", heap->arena, map_size, name);
+    return heap;
+}
+
+/* Unmap the heap from this process; blocks and other attachments are untouched. */
+void ft_shm_heap_detach(t_shm_heap *heap) {
+    if (!heap)
+        return;
+    munmap(heap->ctl, heap->size);
+    free(heap);
+}
+
+/* Remove the name; the memory goes away once every process has detached. */
+int ft_shm_heap_destroy(const char *name) {
+    return shm_unlink(name) == 0 ? 0 : -1;
+}
+
+void *ft_shm_heap_malloc(t_shm_heap *heap, const size_t size) {
+    if (!heap || !lock_heap(heap))
+        return NULL;
+
+    const size_t offset = oarena_alloc(heap->arena, size);
+    unlock_heap(heap);
+
+    if (!offset) {
+        debug_log_event("shm_heap_malloc", NULL, size, "failed: heap full");
+        return NULL;
+    }
+
+    void *ptr = (char *)heap->arena + offset;
+
+    if (g_malloc_scribble)
+        mem_fill(ptr, 0xAA, size);
+    debug_log_event("shm_heap_malloc", ptr, size, "ok");
+    return ptr;
+}
+
+/* Release a block, whichever process allocated it. */
+void ft_shm_heap_free(t_shm_heap *heap, void *ptr) {
+    if (!heap || !ptr)
+        return;
+
+    const size_t offset = ft_shm_heap_offset(heap, ptr);
+    int          freed  = 0;
+
+    if (offset && lock_heap(heap)) {
+        freed = oarena_free(heap->arena, offset);
+        unlock_heap(heap);
+    }
+    debug_log_event("shm_heap_free", ptr, 0, freed ? "ok" : "ignored: invalid pointer or double free");
+}
+
+/* Shared root object (e.g. a queue all processes find), NULL if none was set. */
+void *ft_shm_heap_root(t_shm_heap *heap) {
+    if (!heap || !lock_heap(heap))
+        return NULL;
+
+    const size_t offset = heap->arena->root;
+    unlock_heap(heap);
+
+    return ft_shm_heap_pointer(heap, offset);
+}
+
+void ft_shm_heap_set_root(t_shm_heap *heap, void *ptr) {
+    if (!heap || !lock_heap(heap))
+        return;
+    oarena_set_root(heap->arena, ft_shm_heap_offset(heap, ptr));
+    unlock_heap(heap);
+}
+
+/* Offset to hand to another process (0 for NULL or a pointer outside the heap). */
+size_t ft_shm_heap_offset(const t_shm_heap *heap, const void *ptr) {
+    const char *base = (const char *)heap->arena;
+
+    if (!ptr || (const char *)ptr < base || (const char *)ptr >= base + heap->arena->size)
+        return 0;
+    return (size_t)((const char *)ptr - base);
+}
+
+/* This process's pointer for an offset received from another one (NULL if invalid). */
+void *ft_shm_heap_pointer(const t_shm_heap *heap, const size_t offset) {
+    if (offset == 0 || offset >= heap->arena->size)
+        return NULL;
+    return (char *)heap->arena + offset;
+}
+
+/* Walk the whole heap. Returns 0 if its metadata is consistent, -1 otherwise. */
+int ft_shm_heap_check(t_shm_heap *heap) {
+    if (!heap || !lock_heap(heap))
+        return -1;
+
+    const int ok = oarena_check(heap->arena);
+    unlock_heap(heap);
+
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,138 @@
+#include <fcntl.h>
+#include <time.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Live stats published in shared memory.
+ *
+ * When enabled, the allocator creates /dev/shm/ft_malloc.<pid> and keeps
+ * its counters (t_shm_stats, see ft_malloc_shm.h) directly in that shared
+ * mapping. An external reader maps the same file and watches them change,
+ * without attaching to the process or stopping it.
+ *
+ * Every update is one relaxed atomic add behind a NULL check, so with the
+ * feature off the hot paths pay a single predictable branch. Lock counters
+ * are owner-written plain fields (see lock.c); they are copied into the
+ * segment when a class lock is released.
+ *
+ * The segment is removed when the process exits. A forked child stops
+ * publishing: most children exec() or _exit() right away and would leave
+ * segments behind, and an exec()'d ft_malloc program sets up its own
+ * segment from the inherited environment anyway.
+ */
+
+t_shm_stats *g_shm_stats = NULL;
+
+static char g_shm_path[64];
+static int  g_shm_atfork_registered = 0;
+
+/* FT_SHM_STATS_PREFIX + pid, without snprintf (it may allocate). */
+static void build_path(char *path, const pid_t pid) {
+    char   digits[24];
+    size_t ndigits = 0;
+    size_t len     = ft_strlen(FT_SHM_STATS_PREFIX);
+    size_t value   = (size_t)pid;
+
+    ft_memcpy(path, FT_SHM_STATS_PREFIX, len);
+    do {
+        digits[ndigits++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (ndigits > 0)
+        path[len++] = digits[--ndigits];
+    path[len] = '\0';
+}
+
+/* Create and map the segment of the current process. */
+static t_shm_stats *create_segment(void) {
+    build_path(g_shm_path, getpid());
+
+    const int fd = open(g_shm_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        debug_log_event("shm_stats", NULL, 0, "failed: open");
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(t_shm_stats)) != 0) {
+        close(fd);
+        unlink(g_shm_path);
+        debug_log_event("shm_stats", NULL, 0, "failed: ftruncate");
+        return NULL;
+    }
+
+    t_shm_stats *stats = mmap(NULL, sizeof(t_shm_stats), PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, 0);
+    close(fd);
+    if (stats == MAP_FAILED) {
+        unlink(g_shm_path);
+        debug_log_event("shm_stats", NULL, 0, "failed: mmap");
+        return NULL;
+    }
+
+    stats->version    = FT_SHM_STATS_VERSION;
+    stats->size       = sizeof(t_shm_stats);
+    stats->pid        = getpid();
+    stats->start_time = time(NULL);
+    /* Readers check the magic last: publish it after everything else. */
+    __atomic_store_n(&stats->magic, FT_SHM_STATS_MAGIC, __ATOMIC_RELEASE);
+
+    debug_log_event("shm_stats", stats, sizeof(*stats), g_shm_path);
+    return stats;
+}
+
+/* Fork child: the inherited mapping is the parent's segment, let go of it. */
+static void shm_stats_atfork_child(void) {
+    t_shm_stats *parent = g_shm_stats;
+
+    if (!parent)
+        return;
+    g_shm_stats = NULL;
+    munmap(parent, sizeof(*parent));
+}
+
+static void __attribute__((destructor)) shm_stats_cleanup(void) {
+    if (g_shm_stats)
+        unlink(g_shm_path);
+}
+
+/*
+ * Start publishing (idempotent). Counters start at zero, except for zones
+ * that already exist, which are accounted at once. Returns 1 on success.
+ */
+int shm_stats_enable(void) {
+    if (g_shm_stats)
+        return 1;
+
+    t_shm_stats *stats = create_segment();
+    if (!stats)
+        return 0;
+
+    lock_all_zone_classes();
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            stats->classes[type].zones++;
+            stats->classes[type].zone_bytes += zone->size;
+            for (const t_block *block = zone->blocks; block; block = block_next(block))
+                if (block_state(block) == BLOCK_USED)
+                    stats->classes[type].bytes_in_use += block_size(block);
+        }
+    }
+    __atomic_store_n(&g_shm_stats, stats, __ATOMIC_RELEASE);
+    unlock_all_zone_classes();
+
+    if (!g_shm_atfork_registered) {
+        pthread_atfork(NULL, NULL, shm_stats_atfork_child);
+        g_shm_atfork_registered = 1;
+    }
+    return 1;
+}
+
+/* Copy one class lock's counters into the segment (caller owns that lock). */
+void shm_stats_publish_lock(const t_zone_type type) {
+    t_shm_class_stats *class = &g_shm_stats->classes[type];
+    const t_ft_lock *  lock  = &g_zone_locks[type];
+
+    __atomic_store_n(&class->lock_acquisitions, lock->acquisitions, __ATOMIC_RELAXED);
+    __atomic_store_n(&class->lock_contended, lock->contended, __ATOMIC_RELAXED);
+    __atomic_store_n(&class->lock_sleeps, lock->sleeps, __ATOMIC_RELAXED);
+}
@@ -1,56 +1,50 @@
 #include "ft_malloc.h"
 
 /*
- * Print current allocator state in subject-friendly format.
+ * Print allocator state in subject-friendly format to `fd`.
  *
  * Output groups allocations by zone type and ends with global total bytes.
+ * The zone lists are copied under the class locks; formatting and write()
+ * happen after they are released.
  */
-void show_alloc_mem(void) {
-    size_t total_bytes = 0;
-
-    /* Freeze allocator state while traversing internal lists. */
-    pthread_mutex_lock(&g_mutex);
-
-    t_zone *zone = g_zones;
-    while (zone) {
-        /* 1) Print zone class + zone base address. */
-        if (zone->type == TINY)
-            ft_putstr_fd("TINY : ", 1);
-        else if (zone->type == SMALL)
-            ft_putstr_fd("SMALL : ", 1);
-        else
-            ft_putstr_fd("LARGE : ", 1);
-
-        ft_putptr_fd(zone, 1);
-        ft_putchar_fd('\n', 1);
-
-        /* 2) Print every allocated block in this zone. */
-        t_block *block = zone->blocks;
-        while (block) {
-            if (!block->free) {
-                /* User-visible memory range = [start, end). */
-                void *start = (void *)((char *)block + BLOCK_HDR_SIZE);
-                void *end   = (void *)((char *)block + BLOCK_HDR_SIZE + block->size);
-
-                ft_putptr_fd(start, 1);
-                ft_putstr_fd(" - ", 1);
-                ft_putptr_fd(end, 1);
-                ft_putstr_fd(" : ", 1);
-                ft_putsize_fd(block->size, 1);
-                ft_putstr_fd(" bytes\n", 1);
-
-                total_bytes += block->size;
-            }
-            block = block->next;
+void show_alloc_mem_fd(const int fd) {
+    t_snapshot snap;
+    t_outbuf   out;
+    size_t     total_bytes = 0;
+
+    if (!take_snapshot(&snap, 0))
+        return;
+    outbuf_init(&out, fd);
+
+    for (size_t i = 0; i < snap.count; i++) {
+        const t_snap_entry *entry = &snap.entries[i];
+
+        /* 1) Zone class + zone base address. */
+        if (entry->is_zone) {
+            put_zone_header(&out, entry->type, entry->addr);
+            continue;
         }
 
-        zone = zone->next;
+        /* 2) Allocated block: user-visible memory range = [start, end). */
+        outbuf_putptr(&out, entry->addr);
+        outbuf_putstr(&out, " - ");
+        outbuf_putptr(&out, (const char *)entry->addr + entry->size);
+        outbuf_putstr(&out, " : ");
+        outbuf_putsize(&out, entry->size);
+        outbuf_putstr(&out, " bytes\n");
+
+        total_bytes += entry->size;
     }
 
     /* 3) Final aggregate for quick fragmentation/usage checks. */
-    ft_putstr_fd("Total : ", 1);
-    ft_putsize_fd(total_bytes, 1);
-    ft_putstr_fd(" bytes\n", 1);
+    outbuf_putstr(&out, "Total : ");
+    outbuf_putsize(&out, total_bytes);
+    outbuf_putstr(&out, " bytes\n");
 
-    pthread_mutex_unlock(&g_mutex);
+    outbuf_flush(&out);
+    drop_snapshot(&snap);
+}
+
+void show_alloc_mem(void) {
+    show_alloc_mem_fd(1);
 }
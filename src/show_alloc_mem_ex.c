@@ -1,95 +1,136 @@
-#include "ft_malloc.h"
+#include <fcntl.h>
+#include <stdint.h>
 
-/* Convert one byte to two uppercase hex digits and print it. */
-static void print_byte_hex(unsigned char c) {
-    char *base = "0123456789ABCDEF";
+#include "ft_malloc.h"
 
-    ft_putchar_fd(base[(c >> 4) & 0xF], 1);
-    ft_putchar_fd(base[c & 0xF], 1);
-}
+#define HEXDUMP_LINE 16
 
 /*
- * Print a block payload as classic hexdump lines.
+ * Format one hexdump line into `line` and return its length.
  *
  * Per line:
- * - absolute address
+ * - absolute address (of the live block, not of the snapshot copy)
  * - up to 16 hex bytes
  * - printable ASCII mirror (non-printable -> '.')
  */
-static void hexdump_block(void *ptr, size_t size) {
-    unsigned char *data = ptr;
-    size_t         count;
-
-    for (size_t i = 0; i < size; i += 16) {
-        /* Address column (start of current 16-byte slice). */
-        ft_putptr_fd(data + i, 1);
-        ft_putstr_fd("  ", 1);
-
-        /* Hex byte column. */
-        for (count = 0; count < 16; count++) {
-            if (i + count < size) {
-                print_byte_hex(data[i + count]);
-                ft_putchar_fd(' ', 1);
-            } else {
-                /* Pad last line so ASCII column stays aligned. */
-                ft_putstr_fd("   ", 1);
-            }
-        }
+static size_t format_hexdump_line(char *line, const void *addr,
+                                  const unsigned char *data, const size_t count) {
+    static const char *hex_lower = "0123456789abcdef";
+    static const char *hex_upper = "0123456789ABCDEF";
+    char               digits[2 * sizeof(uintptr_t)];
+    size_t             ndigits = 0;
+    size_t             len     = 0;
+    uintptr_t          value   = (uintptr_t)addr;
 
-        /* ASCII preview column. */
-        ft_putstr_fd(" |", 1);
-        for (count = 0; count < 16; count++) {
-            if (i + count < size) {
-                unsigned char c = data[i + count];
-                if (c >= 32 && c <= 126)
-                    ft_putchar_fd(c, 1);
-                else
-                    ft_putchar_fd('.', 1);
-            }
+    /* Address column, same format as ft_putptr_fd(). */
+    do {
+        digits[ndigits++] = hex_lower[value & 0xF];
+        value >>= 4;
+    } while (value > 0);
+    line[len++] = '0';
+    line[len++] = 'x';
+    while (ndigits > 0)
+        line[len++] = digits[--ndigits];
+    line[len++] = ' ';
+    line[len++] = ' ';
+
+    /* Hex byte column; the last line is padded so ASCII stays aligned. */
+    for (size_t i = 0; i < HEXDUMP_LINE; i++) {
+        if (i < count) {
+            line[len++] = hex_upper[data[i] >> 4];
+            line[len++] = hex_upper[data[i] & 0xF];
+        } else {
+            line[len++] = ' ';
+            line[len++] = ' ';
         }
-        ft_putstr_fd("|\n", 1);
+        line[len++] = ' ';
+    }
+
+    /* ASCII preview column. */
+    line[len++] = ' ';
+    line[len++] = '|';
+    for (size_t i = 0; i < count; i++)
+        line[len++] = (data[i] >= 32 && data[i] <= 126) ? (char)data[i] : '.';
+    line[len++] = '|';
+    line[len++] = '\n';
+    return len;
+}
+
+/* Hexdump `size` copied bytes of a block that lives at `addr`. */
+static void hexdump_block(t_outbuf *out, const void *addr,
+                          const unsigned char *data, const size_t size) {
+    char line[2 * sizeof(uintptr_t) + 8 + 4 * HEXDUMP_LINE + 8];
+
+    for (size_t i = 0; i < size; i += HEXDUMP_LINE) {
+        const size_t count = size - i < HEXDUMP_LINE ? size - i : HEXDUMP_LINE;
+
+        outbuf_write(out, line,
+                     format_hexdump_line(line, (const char *)addr + i, data + i, count));
     }
 }
 
 /*
- * Extended memory view:
+ * Extended memory view to `fd`:
  * - same zone walk as show_alloc_mem
- * - plus full hexdump of each allocated block payload
+ * - plus a hexdump of each allocated block payload
+ *
+ * At most `limit` payload bytes are dumped in total (0 = no limit); blocks
+ * past the limit are still listed, with a note of what was left out.
+ * Payloads are copied under the class locks, the dump is formatted and
+ * written after they are released.
  */
-void show_alloc_mem_ex(void) {
-    pthread_mutex_lock(&g_mutex);
-
-    t_zone *zone = g_zones;
-    while (zone) {
-        /* Print zone header. */
-        if (zone->type == TINY)
-            ft_putstr_fd("TINY : ", 1);
-        else if (zone->type == SMALL)
-            ft_putstr_fd("SMALL : ", 1);
-        else
-            ft_putstr_fd("LARGE : ", 1);
-
-        ft_putptr_fd(zone, 1);
-        ft_putchar_fd('\n', 1);
-
-        /* Print details for each allocated block in this zone. */
-        t_block *block = zone->blocks;
-        while (block) {
-            if (!block->free) {
-                ft_putstr_fd("BLOCK: ", 1);
-                ft_putptr_fd((void *)((char *)block + BLOCK_HDR_SIZE), 1);
-                ft_putstr_fd(" - SIZE: ", 1);
-                ft_putsize_fd(block->size, 1);
-                ft_putstr_fd(" bytes\n", 1);
-
-                hexdump_block((void *)((char *)block + BLOCK_HDR_SIZE), block->size);
-                ft_putchar_fd('\n', 1);
-            }
-            block = block->next;
+void show_alloc_mem_ex_fd(const int fd, const size_t limit) {
+    t_snapshot snap;
+    t_outbuf   out;
+
+    if (!take_snapshot(&snap, limit ? limit : SIZE_MAX))
+        return;
+    outbuf_init(&out, fd);
+
+    const unsigned char *data = snap.data;
+
+    for (size_t i = 0; i < snap.count; i++) {
+        const t_snap_entry *entry = &snap.entries[i];
+
+        if (entry->is_zone) {
+            put_zone_header(&out, entry->type, entry->addr);
+            continue;
         }
 
-        zone = zone->next;
+        outbuf_putstr(&out, "BLOCK: ");
+        outbuf_putptr(&out, entry->addr);
+        outbuf_putstr(&out, " - SIZE: ");
+        outbuf_putsize(&out, entry->size);
+        outbuf_putstr(&out, " bytes\n");
+
+        hexdump_block(&out, entry->addr, data, entry->copied);
+        data += entry->copied;
+
+        if (entry->copied < entry->size) {
+            outbuf_putstr(&out, "... ");
+            outbuf_putsize(&out, entry->size - entry->copied);
+            outbuf_putstr(&out, " bytes not dumped (limit)\n");
+        }
+        outbuf_putchar(&out, '\n');
     }
 
-    pthread_mutex_unlock(&g_mutex);
+    outbuf_flush(&out);
+    drop_snapshot(&snap);
+}
+
+/* Dump to a file (created or truncated). Returns 0, or -1 if it cannot be opened. */
+int show_alloc_mem_ex_file(const char *path, const size_t limit) {
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        debug_log_event("show_alloc_mem_ex", NULL, limit, "failed: open");
+        return -1;
+    }
+    show_alloc_mem_ex_fd(fd, limit);
+    close(fd);
+    return 0;
+}
+
+void show_alloc_mem_ex(void) {
+    show_alloc_mem_ex_fd(1, 0);
 }
@@ -0,0 +1,313 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+
+#include "ft_malloc.h"
+
+/*
+ * Machine-readable heap layout (JSON Lines), for offline fragmentation
+ * analysis with tools/ft_malloc_layout.py.
+ *
+ * One object per line:
+ * - a heap line first: pid, page size, block header size, zone and block
+ *   counts
+ * - per zone: id, class, address, mapped size, offset of its first block,
+ *   and whether it is a hot-size slab
+ * - per block, right after its zone: zone id, header offset from the zone
+ *   base, payload size, state (used / free / deferred / frontier), class
+ *
+ * Like the other reports, the layout is copied under all class locks into
+ * a private mapping and formatted once they are released. Each zone's
+ * lines are formatted into one buffer and reach the fd in a single write()
+ * (zones of more than LAYOUT_CHUNK_MAX bytes of text take a few).
+ *
+ * MallocLayoutDump=<path> writes the layout to <path> at exit.
+ */
+
+#define LAYOUT_LINE_MAX  192                       /* Longest zone or block line. */
+#define LAYOUT_CHUNK_MAX (16UL * 1024UL * 1024UL) /* Per-write() cap on formatted text. */
+#define LAYOUT_PATH_MAX  4096
+
+typedef struct s_layout_zone {
+    const void *addr;
+    size_t      size;
+    size_t      first;  /* Offset of the first block header. */
+    size_t      blocks; /* Number of t_layout_block records that follow. */
+    t_zone_type type;
+    int         hot;
+} t_layout_zone;
+
+typedef struct s_layout_block {
+    size_t offset;      /* Header offset from the zone base. */
+    size_t size;        /* Payload size. */
+    int    state;
+    int    type;
+} t_layout_block;
+
+typedef struct s_layout {
+    t_layout_zone * zones;
+    t_layout_block *blocks;
+    size_t          zone_count;
+    size_t          block_count;
+    size_t          max_blocks; /* Most blocks in a single zone. */
+    size_t          map_size;
+} t_layout;
+
+/* Line being formatted into a caller-provided buffer. */
+typedef struct s_line {
+    char * data;
+    size_t len;
+} t_line;
+
+static char g_layout_path[LAYOUT_PATH_MAX]; /* MallocLayoutDump target, empty when unset. */
+
+static const char *g_layout_classes[ZONE_TYPE_COUNT] = {"TINY", "SMALL", "MEDIUM", "LARGE"};
+static const char *g_layout_states[4] = {"used", "free", "deferred", "frontier"};
+
+static void line_str(t_line *line, const char *str) {
+    const size_t len = ft_strlen(str);
+
+    ft_memcpy(line->data + line->len, str, len);
+    line->len += len;
+}
+
+static void line_size(t_line *line, size_t value) {
+    char   digits[32];
+    size_t index = sizeof(digits);
+
+    do {
+        digits[--index] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    ft_memcpy(line->data + line->len, digits + index, sizeof(digits) - index);
+    line->len += sizeof(digits) - index;
+}
+
+/* "0x..." in quotes: JSON numbers cannot hold every 64-bit address exactly. */
+static void line_ptr(t_line *line, const void *ptr) {
+    static const char *hex = "0123456789abcdef";
+    char               digits[2 * sizeof(uintptr_t)];
+    size_t             index = sizeof(digits);
+    uintptr_t          value = (uintptr_t)ptr;
+
+    do {
+        digits[--index] = hex[value & 0xF];
+        value >>= 4;
+    } while (value > 0);
+    line_str(line, "\"0x");
+    ft_memcpy(line->data + line->len, digits + index, sizeof(digits) - index);
+    line->len += sizeof(digits) - index;
+    line_str(line, "\"");
+}
+
+/* write() all of it; EINTR and short writes are retried, other errors end the dump. */
+static int write_all(const int fd, const char *data, size_t len) {
+    while (len > 0) {
+        const ssize_t n = write(fd, data, len);
+
+        if (n > 0) {
+            data += n;
+            len -= (size_t)n;
+        } else if (!(n < 0 && errno == EINTR))
+            return 0;
+    }
+    return 1;
+}
+
+static void count_layout(t_layout *layout) {
+    layout->zone_count  = 0;
+    layout->block_count = 0;
+    layout->max_blocks  = 0;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            size_t blocks = 0;
+
+            for (const t_block *block = zone->blocks; block; block = block_next(block))
+                blocks++;
+            layout->zone_count++;
+            layout->block_count += blocks;
+            if (blocks > layout->max_blocks)
+                layout->max_blocks = blocks;
+        }
+    }
+}
+
+static void fill_layout(t_layout *layout) {
+    t_layout_zone * out_zone  = layout->zones;
+    t_layout_block *out_block = layout->blocks;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            out_zone->addr   = zone;
+            out_zone->size   = zone->size;
+            out_zone->first  = (size_t)((const char *)zone->blocks - (const char *)zone);
+            out_zone->blocks = 0;
+            out_zone->type   = zone->type;
+            out_zone->hot    = zone->hot != NULL;
+
+            for (const t_block *block = zone->blocks; block; block = block_next(block)) {
+                out_block->offset = (size_t)((const char *)block - (const char *)zone);
+                out_block->size   = block_size(block);
+                out_block->state  = block_state(block);
+                out_block->type   = (int)block_class(block);
+                out_block++;
+                out_zone->blocks++;
+            }
+            out_zone++;
+        }
+    }
+}
+
+/* Copy zone and block metadata under the class locks. Returns 0 if it cannot be mapped. */
+static int take_layout(t_layout *layout) {
+    lock_all_zone_classes();
+
+    count_layout(layout);
+
+    const size_t page_size = getpagesize();
+    layout->map_size = layout->zone_count * sizeof(t_layout_zone)
+                       + layout->block_count * sizeof(t_layout_block) + 1;
+    layout->map_size = (layout->map_size + page_size - 1) / page_size * page_size;
+
+    void *map = mmap(NULL, layout->map_size, PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (map == MAP_FAILED) {
+        unlock_all_zone_classes();
+        debug_log_event("layout", NULL, layout->map_size, "failed: mmap");
+        return 0;
+    }
+
+    layout->zones  = (t_layout_zone *)map;
+    layout->blocks = (t_layout_block *)((char *)map + layout->zone_count * sizeof(t_layout_zone));
+    fill_layout(layout);
+
+    unlock_all_zone_classes();
+    return 1;
+}
+
+static void put_heap_line(t_line *line, const t_layout *layout) {
+    line_str(line, "{\"kind\":\"heap\",\"pid\":");
+    line_size(line, (size_t)getpid());
+    line_str(line, ",\"page_size\":");
+    line_size(line, (size_t)getpagesize());
+    line_str(line, ",\"block_header\":");
+    line_size(line, BLOCK_HDR_SIZE);
+    line_str(line, ",\"zones\":");
+    line_size(line, layout->zone_count);
+    line_str(line, ",\"blocks\":");
+    line_size(line, layout->block_count);
+    line_str(line, "}\n");
+}
+
+static void put_zone_line(t_line *line, const t_layout_zone *zone, const size_t id) {
+    line_str(line, "{\"kind\":\"zone\",\"zone\":");
+    line_size(line, id);
+    line_str(line, ",\"class\":\"");
+    line_str(line, g_layout_classes[zone->type]);
+    line_str(line, "\",\"addr\":");
+    line_ptr(line, zone->addr);
+    line_str(line, ",\"size\":");
+    line_size(line, zone->size);
+    line_str(line, ",\"first\":");
+    line_size(line, zone->first);
+    line_str(line, zone->hot ? ",\"hot\":true}\n" : ",\"hot\":false}\n");
+}
+
+static void put_block_line(t_line *line, const t_layout_block *block, const size_t id) {
+    line_str(line, "{\"kind\":\"block\",\"zone\":");
+    line_size(line, id);
+    line_str(line, ",\"offset\":");
+    line_size(line, block->offset);
+    line_str(line, ",\"size\":");
+    line_size(line, block->size);
+    line_str(line, ",\"state\":\"");
+    line_str(line, g_layout_states[block->state]);
+    line_str(line, "\",\"class\":\"");
+    line_str(line, g_layout_classes[block->type]);
+    line_str(line, "\"}\n");
+}
+
+/*
+ * Write the heap layout to `fd` as JSON Lines.
+ * Returns 0, or -1 if it could not be copied or written.
+ */
+int show_alloc_mem_layout_fd(const int fd) {
+    t_layout layout;
+
+    if (!take_layout(&layout))
+        return -1;
+
+    /* Room for the largest zone (plus the heap line), in one lazily touched mapping. */
+    size_t buffer_size = (layout.max_blocks + 2) * LAYOUT_LINE_MAX;
+    if (buffer_size > LAYOUT_CHUNK_MAX)
+        buffer_size = LAYOUT_CHUNK_MAX;
+
+    char *buffer = mmap(NULL, buffer_size, PROT_READ | PROT_WRITE,
+                        MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (buffer == MAP_FAILED) {
+        munmap(layout.zones, layout.map_size);
+        debug_log_event("layout", NULL, buffer_size, "failed: mmap");
+        return -1;
+    }
+
+    t_line                line  = {buffer, 0};
+    const t_layout_block *block = layout.blocks;
+    int                   ok    = 1;
+
+    put_heap_line(&line, &layout);
+    for (size_t id = 0; ok && id < layout.zone_count; id++) {
+        const t_layout_zone *zone = &layout.zones[id];
+
+        put_zone_line(&line, zone, id);
+        for (size_t i = 0; ok && i < zone->blocks; i++, block++) {
+            if (line.len + LAYOUT_LINE_MAX > buffer_size) {
+                ok = write_all(fd, line.data, line.len);
+                line.len = 0;
+            }
+            put_block_line(&line, block, id);
+        }
+        /* The zone is complete: one write() for all of its lines. */
+        if (ok)
+            ok = write_all(fd, line.data, line.len);
+        line.len = 0;
+    }
+    if (layout.zone_count == 0)
+        ok = write_all(fd, line.data, line.len);
+
+    munmap(buffer, buffer_size);
+    munmap(layout.zones, layout.map_size);
+    return ok ? 0 : -1;
+}
+
+/* Write the layout to a file (created or truncated). Returns 0, or -1 on failure. */
+int show_alloc_mem_layout_file(const char *path) {
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        debug_log_event("layout", NULL, 0, "failed: open");
+        return -1;
+    }
+
+    const int result = show_alloc_mem_layout_fd(fd);
+    close(fd);
+    return result;
+}
+
+void show_alloc_mem_layout(void) {
+    show_alloc_mem_layout_fd(1);
+}
+
+/* MallocLayoutDump: remember where to dump at exit (the environment may change meanwhile). */
+void layout_dump_at_exit(const char *path) {
+    const size_t len = ft_strlen(path);
+
+    if (len == 0 || len >= LAYOUT_PATH_MAX)
+        return;
+    ft_memcpy(g_layout_path, path, len + 1);
+}
+
+static void __attribute__((destructor)) layout_dump(void) {
+    if (g_layout_path[0] != '\0')
+        show_alloc_mem_layout_file(g_layout_path);
+}
@@ -0,0 +1,277 @@
+#include "ft_malloc.h"
+
+/*
+ * Free-block histogram buckets are powers of two:
+ * bucket 0 = [16, 32), bucket 1 = [32, 64), ... last bucket is open-ended.
+ */
+#define FREE_HIST_BUCKETS 16
+#define FREE_HIST_MIN_SHIFT 4
+
+/* Aggregated utilization numbers for one zone or one whole class. */
+typedef struct s_zone_stats {
+    size_t zones;                         /* Number of zones folded in. */
+    size_t mapped;                        /* Bytes obtained from mmap. */
+    size_t used;                          /* Allocated payload bytes. */
+    size_t free;                          /* Free payload bytes. */
+    size_t overhead;                      /* Zone + block header bytes. */
+    size_t used_blocks;                   /* Allocated block count. */
+    size_t free_blocks;                   /* Free block count (parked ones included). */
+    size_t deferred_blocks;               /* Free blocks parked on a recently-freed list. */
+    size_t largest_free;                  /* Biggest single free payload. */
+    size_t histogram[FREE_HIST_BUCKETS];  /* Free block count per size bucket. */
+} t_zone_stats;
+
+/* Per-zone numbers, collected under the locks and printed after. */
+typedef struct s_zone_line {
+    const void * zone;
+    t_zone_type  type;
+    t_zone_stats stats;
+} t_zone_line;
+
+static const char *zone_type_name(const t_zone_type type) {
+    if (type == TINY)
+        return "TINY";
+    if (type == SMALL)
+        return "SMALL";
+    if (type == MEDIUM)
+        return "MEDIUM";
+    return "LARGE";
+}
+
+/* Map a free payload size to its power-of-two histogram bucket. */
+static size_t histogram_bucket(size_t size) {
+    size_t bucket = 0;
+
+    size >>= FREE_HIST_MIN_SHIFT;
+    while (size > 1 && bucket < FREE_HIST_BUCKETS - 1) {
+        size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/* Walk the blocks of one zone and fill its stats from scratch. */
+static void collect_zone_stats(const t_zone *zone, t_zone_stats *stats) {
+    ft_memset(stats, 0, sizeof(*stats));
+    stats->zones    = 1;
+    stats->mapped   = zone->size;
+    /* Zone header, color gap and end fence. */
+    stats->overhead = (size_t)((const char *)zone->blocks - (const char *)zone) + BLOCK_HDR_SIZE;
+
+    const t_block *block = zone->blocks;
+    while (block) {
+        const size_t size = block_size(block);
+
+        stats->overhead += BLOCK_HDR_SIZE;
+
+        if (block_state(block) != BLOCK_USED) {
+            stats->free += size;
+            stats->free_blocks++;
+            if (block_state(block) == BLOCK_DEFERRED)
+                stats->deferred_blocks++;
+            stats->histogram[histogram_bucket(size)]++;
+            if (size > stats->largest_free)
+                stats->largest_free = size;
+        } else {
+            stats->used += size;
+            stats->used_blocks++;
+        }
+        block = block_next(block);
+    }
+}
+
+/* Fold one zone's numbers into its class totals. */
+static void merge_stats(t_zone_stats *total, const t_zone_stats *zone) {
+    total->zones       += zone->zones;
+    total->mapped      += zone->mapped;
+    total->used        += zone->used;
+    total->free        += zone->free;
+    total->overhead    += zone->overhead;
+    total->used_blocks += zone->used_blocks;
+    total->free_blocks += zone->free_blocks;
+    total->deferred_blocks += zone->deferred_blocks;
+    if (zone->largest_free > total->largest_free)
+        total->largest_free = zone->largest_free;
+    for (size_t i = 0; i < FREE_HIST_BUCKETS; i++)
+        total->histogram[i] += zone->histogram[i];
+}
+
+/*
+ * Print a ratio as a percentage with two decimals ("12.34%").
+ *
+ * Integer math only: we must not depend on printf/float formatting here.
+ */
+static void print_percent(t_outbuf *out, size_t part, size_t whole) {
+    size_t basis_points = 0;
+
+    if (whole > 0)
+        basis_points = (size_t)((unsigned long long)part * 10000ULL / whole);
+
+    outbuf_putsize(out, basis_points / 100);
+    outbuf_putchar(out, '.');
+    outbuf_putchar(out, (char)('0' + (basis_points / 10) % 10));
+    outbuf_putchar(out, (char)('0' + basis_points % 10));
+    outbuf_putchar(out, '%');
+}
+
+static void print_field(t_outbuf *out, const char *label, size_t value) {
+    outbuf_putstr(out, label);
+    outbuf_putsize(out, value);
+}
+
+/*
+ * External fragmentation = share of free bytes that is NOT in the largest
+ * free block, i.e. memory that is free but cannot serve one big request.
+ */
+static void print_fragmentation(t_outbuf *out, const t_zone_stats *stats) {
+    outbuf_putstr(out, " frag=");
+    print_percent(out, stats->free - stats->largest_free, stats->free);
+}
+
+/* One line per zone: occupancy and free space inside that mapping. */
+static void print_zone_line(t_outbuf *out, const t_zone_line *line) {
+    const t_zone_stats *stats = &line->stats;
+
+    outbuf_putstr(out, zone_type_name(line->type));
+    outbuf_putstr(out, " : ");
+    outbuf_putptr(out, line->zone);
+    print_field(out, " mapped=", stats->mapped);
+    print_field(out, " used=", stats->used);
+    print_field(out, " free=", stats->free);
+    print_field(out, " blocks=", stats->used_blocks + stats->free_blocks);
+    print_field(out, " largest_free=", stats->largest_free);
+    outbuf_putstr(out, " occupancy=");
+    print_percent(out, stats->used, stats->mapped);
+    outbuf_putchar(out, '\n');
+}
+
+/* Non-empty histogram buckets as "[lo-hi]: count" pairs. */
+static void print_histogram(t_outbuf *out, const t_zone_stats *stats) {
+    outbuf_putstr(out, "  free histogram:");
+    for (size_t i = 0; i < FREE_HIST_BUCKETS; i++) {
+        if (stats->histogram[i] == 0)
+            continue;
+        outbuf_putstr(out, " [");
+        outbuf_putsize(out, (size_t)1 << (i + FREE_HIST_MIN_SHIFT));
+        outbuf_putchar(out, '-');
+        if (i == FREE_HIST_BUCKETS - 1)
+            outbuf_putstr(out, "inf");
+        else
+            outbuf_putsize(out, ((size_t)1 << (i + FREE_HIST_MIN_SHIFT + 1)) - 1);
+        outbuf_putstr(out, "]: ");
+        outbuf_putsize(out, stats->histogram[i]);
+    }
+    outbuf_putchar(out, '\n');
+}
+
+/* Class (or grand total) summary block. */
+static void print_summary(t_outbuf *out, const char *name, const t_zone_stats *stats) {
+    outbuf_putstr(out, name);
+    print_field(out, " : zones=", stats->zones);
+    print_field(out, " mapped=", stats->mapped);
+    print_field(out, " used=", stats->used);
+    print_field(out, " free=", stats->free);
+    print_field(out, " overhead=", stats->overhead);
+    print_field(out, " largest_free=", stats->largest_free);
+    print_field(out, " deferred=", stats->deferred_blocks);
+    print_fragmentation(out, stats);
+    outbuf_putchar(out, '\n');
+    if (stats->free_blocks > 0)
+        print_histogram(out, stats);
+}
+
+/* Lock counters for one class: how often callers had to spin or sleep. */
+static void print_lock_line(t_outbuf *out, const t_zone_type type, const t_ft_lock *lock) {
+    outbuf_putstr(out, zone_type_name(type));
+    print_field(out, " lock : acquisitions=", lock->acquisitions);
+    print_field(out, " contended=", lock->contended);
+    print_field(out, " sleeps=", lock->sleeps);
+    outbuf_putstr(out, " contention=");
+    print_percent(out, lock->contended, lock->acquisitions);
+    outbuf_putchar(out, '\n');
+}
+
+/* Zones over all classes (caller holds every class lock). */
+static size_t count_zones(void) {
+    size_t count = 0;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next)
+            count++;
+    return count;
+}
+
+/*
+ * Utilization / fragmentation report to `fd`.
+ *
+ * Single pass over the zone lists under the class locks: per-zone numbers
+ * land in a private mapping while class totals accumulate on the side.
+ * Everything is printed after the locks are released, so the report stays
+ * cheap enough to call periodically, even into a slow pipe.
+ */
+void show_alloc_mem_stats_fd(const int fd) {
+    t_zone_stats classes[ZONE_TYPE_COUNT];
+    t_zone_stats total;
+    t_ft_lock    locks[ZONE_TYPE_COUNT];
+    t_outbuf     out;
+
+    ft_memset(classes, 0, sizeof(classes));
+    ft_memset(&total, 0, sizeof(total));
+    outbuf_init(&out, fd);
+
+    lock_all_zone_classes();
+
+    /* Without the mapping, only the per-zone lines are lost. */
+    const size_t lines_size = count_zones() * sizeof(t_zone_line) + 1;
+    t_zone_line *lines = mmap(NULL, lines_size, PROT_READ | PROT_WRITE,
+                              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    size_t       line_count = 0;
+    t_zone_line  scratch;
+
+    if (lines == MAP_FAILED)
+        lines = NULL;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            t_zone_line *line = lines ? &lines[line_count++] : &scratch;
+
+            line->zone = zone;
+            line->type = zone->type;
+            collect_zone_stats(zone, &line->stats);
+            merge_stats(&classes[type], &line->stats);
+        }
+    }
+
+    /* Snapshot lock counters while we still own every lock. */
+    ft_memcpy(locks, g_zone_locks, sizeof(locks));
+
+    unlock_all_zone_classes();
+
+    for (size_t i = 0; i < line_count; i++)
+        print_zone_line(&out, &lines[i]);
+    if (lines)
+        munmap(lines, lines_size);
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        print_summary(&out, zone_type_name((t_zone_type)type), &classes[type]);
+        merge_stats(&total, &classes[type]);
+    }
+    print_summary(&out, "Total", &total);
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+        print_lock_line(&out, (t_zone_type)type, &locks[type]);
+
+    show_cache_stats(&out);
+    show_hot_slab_stats(&out);
+    if (g_malloc_latency)
+        show_latency_stats(&out);
+    if (g_lock_profile)
+        show_lock_profile(&out);
+    if (g_async_unmap)
+        show_reclaim_stats(&out);
+    outbuf_flush(&out);
+}
+
+void show_alloc_mem_stats(void) {
+    show_alloc_mem_stats_fd(1);
+}
@@ -0,0 +1,117 @@
+#include "ft_malloc.h"
+
+/*
+ * Heap snapshots for the show functions.
+ *
+ * Everything a report needs is copied out while all class locks are held:
+ * one entry per zone and per allocated block, plus (for hexdumps) up to
+ * `payload_limit` bytes of payload. Formatting then runs on the copy with
+ * no lock held, and blocks freed or unmapped meanwhile cannot be touched.
+ *
+ * The snapshot lives in one private mapping sized by a counting pass, so
+ * taking it never calls back into malloc().
+ */
+
+static void count_entries(size_t *entries, size_t *payload) {
+    *entries = 0;
+    *payload = 0;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            (*entries)++;
+            for (const t_block *block = zone->blocks; block; block = block_next(block)) {
+                if (block_state(block) == BLOCK_USED) {
+                    (*entries)++;
+                    *payload += block_size(block);
+                }
+            }
+        }
+    }
+}
+
+static void fill_entries(t_snapshot *snap, size_t payload_left) {
+    t_snap_entry * entry = snap->entries;
+    unsigned char *data  = snap->data;
+
+    for (int type = 0; type < ZONE_TYPE_COUNT; type++) {
+        for (const t_zone *zone = g_zones[type]; zone; zone = zone->next) {
+            entry->addr    = zone;
+            entry->size    = 0;
+            entry->copied  = 0;
+            entry->is_zone = 1;
+            entry->type    = zone->type;
+            entry++;
+
+            for (const t_block *block = zone->blocks; block; block = block_next(block)) {
+                if (block_state(block) != BLOCK_USED)
+                    continue;
+
+                entry->addr    = (const char *)block + BLOCK_HDR_SIZE;
+                entry->size    = block_size(block);
+                entry->copied  = entry->size < payload_left ? entry->size : payload_left;
+                entry->is_zone = 0;
+                entry->type    = zone->type;
+
+                mem_copy(data, entry->addr, entry->copied);
+                data += entry->copied;
+                payload_left -= entry->copied;
+                entry++;
+            }
+        }
+    }
+}
+
+/*
+ * Copy the allocator state; payload bytes are copied up to payload_limit
+ * in total (0 copies none). Returns 0 if the snapshot could not be mapped.
+ */
+int take_snapshot(t_snapshot *snap, const size_t payload_limit) {
+    size_t entries;
+    size_t payload;
+
+    lock_all_zone_classes();
+
+    count_entries(&entries, &payload);
+    if (payload > payload_limit)
+        payload = payload_limit;
+
+    const size_t page_size = getpagesize();
+    /* Never 0, even with no zone at all: mmap() rejects empty mappings. */
+    snap->map_size = entries * sizeof(t_snap_entry) + payload + 1;
+    snap->map_size = (snap->map_size + page_size - 1) / page_size * page_size;
+
+    void *map = mmap(NULL, snap->map_size, PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (map == MAP_FAILED) {
+        unlock_all_zone_classes();
+        debug_log_event("snapshot", NULL, snap->map_size, "failed: mmap");
+        return 0;
+    }
+
+    snap->entries = (t_snap_entry *)map;
+    snap->count   = entries;
+    snap->data    = (unsigned char *)map + entries * sizeof(t_snap_entry);
+    fill_entries(snap, payload);
+
+    unlock_all_zone_classes();
+    return 1;
+}
+
+void drop_snapshot(t_snapshot *snap) {
+    munmap(snap->entries, snap->map_size);
+}
+
+/* "TINY : ", "SMALL : ", ... (zone header prefix shared by the show functions). */
+void put_zone_header(t_outbuf *out, const t_zone_type type, const void *zone) {
+    if (type == TINY)
+        outbuf_putstr(out, "TINY : ");
+    else if (type == SMALL)
+        outbuf_putstr(out, "SMALL : ");
+    else if (type == MEDIUM)
+        outbuf_putstr(out, "MEDIUM : ");
+    else
+        outbuf_putstr(out, "LARGE : ");
+
+    outbuf_putptr(out, zone);
+    outbuf_putchar(out, '\n');
+}
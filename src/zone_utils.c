@@ -2,89 +2,427 @@
 
 #include "ft_malloc.h"
 
+#ifdef MAP_POPULATE
+# define ZONE_MAP_POPULATE MAP_POPULATE
+#else
+# define ZONE_MAP_POPULATE 0 /* Pages are touched by hand instead. */
+#endif
+
+/*
+ * Grow a pooled zone size with the number of zones the class already has:
+ * doubled every ZONE_GROWTH_STEP zones, capped at ZONE_MAX_SIZE.
+ */
+static size_t grow_zone_size(const size_t base_size, const size_t zone_count) {
+    size_t size = base_size;
+
+    for (size_t step = zone_count / ZONE_GROWTH_STEP; step > 0 && size < ZONE_MAX_SIZE; step--)
+        size *= 2;
+    if (size > ZONE_MAX_SIZE)
+        size = base_size > ZONE_MAX_SIZE ? base_size : ZONE_MAX_SIZE;
+    return size;
+}
+
 /*
  * Compute mmap size for a zone class.
  *
  * TINY/SMALL policy:
  * - provision pooled zones large enough for at least MIN_ALLOCS blocks
  *
+ * MEDIUM policy:
+ * - one big shared zone (MEDIUM_ZONE_SIZE), larger only if the request
+ *   would not fit in it
+ *
+ * Pooled zones then grow geometrically with zone_count, the number of
+ * zones already mapped for the class.
+ *
  * LARGE policy:
  * - allocate just enough for one request (+metadata)
  *
  * Final result is rounded up to page size because mmap works in pages.
+ * *slack (optional) receives the bytes that rounding added to a pooled
+ * zone: room for its color (see next_zone_color()).
  */
-static size_t calculate_zone_size(const t_zone_type type, const size_t request_size) {
+static size_t calculate_zone_size(const t_zone_type type, const size_t request_size,
+                                  const size_t zone_count, size_t *slack) {
     const size_t page_size = getpagesize();
+    const size_t fit_size  = ZONE_HDR_SIZE + request_size + 2 * BLOCK_HDR_SIZE;
     size_t       size_needed;
 
     if (type == TINY)
         size_needed = ZONE_HDR_SIZE + MIN_ALLOCS * (TINY_MALLOC_LIMIT + BLOCK_HDR_SIZE);
     else if (type == SMALL)
         size_needed = ZONE_HDR_SIZE + MIN_ALLOCS * (SMALL_MALLOC_LIMIT + BLOCK_HDR_SIZE);
+    else if (type == MEDIUM)
+        size_needed = MEDIUM_ZONE_SIZE;
     else
-        size_needed = ZONE_HDR_SIZE + request_size + BLOCK_HDR_SIZE;
+        size_needed = fit_size;
+
+    if (type != LARGE)
+        size_needed = grow_zone_size(size_needed, zone_count);
+    if (size_needed < fit_size)
+        size_needed = fit_size;
+
+    const size_t zone_size = (size_needed + page_size - 1) / page_size * page_size;
+
+    if (slack)
+        *slack = type == LARGE ? 0 : zone_size - size_needed;
+    return zone_size;
+}
+
+/*
+ * Cache coloring of pooled zones.
+ *
+ * Zones start on page boundaries, so without an offset the header and first
+ * block of every zone fall into the same cache sets and evict each other
+ * once there are many zones. Successive zones shift their block area by a
+ * rotating multiple of CACHE_LINE_SIZE (up to ZONE_COLORS colors), taken
+ * from the slack the page rounding left: the zone keeps room for everything
+ * it was sized for. Zones without slack (MEDIUM's exact 4 MiB) get color 0.
+ */
+static size_t next_zone_color(const size_t slack) {
+    static unsigned turn = 0;
+    size_t          colors = slack / CACHE_LINE_SIZE + 1;
 
-    return (size_needed + page_size - 1) / page_size * page_size;
+    if (colors > ZONE_COLORS)
+        colors = ZONE_COLORS;
+    return (__atomic_fetch_add(&turn, 1, __ATOMIC_RELAXED) % colors) * CACHE_LINE_SIZE;
 }
 
 /*
  * Lay out zone metadata and initial block metadata in a fresh mapping.
  *
  * Memory layout:
- * [zone header][first block header][first block payload ...]
+ * [zone header][color gap][first block header][first block payload ...][fence header]
+ *
+ * The color gap (a multiple of CACHE_LINE_SIZE, often 0) is never used.
+ * The fence is a used, zero-size header: forward walks stop on it and
+ * merges never cross it.
  */
-static t_zone *init_zone(void *ptr, const t_zone_type type, const size_t zone_size) {
+static t_zone *init_zone(void *ptr, const t_zone_type type, const size_t zone_size,
+                         const size_t color) {
     t_zone *zone = (t_zone *)ptr;
 
     zone->type = type;
     zone->size = zone_size;
     zone->next = NULL;
+    zone->hot = NULL;
+    zone->hot_live = 0;
+    zone->hot_free = NULL;
+    zone->hot_next = NULL;
+    zone->hot_prev = NULL;
+    zone->frontier = NULL;
 
-    t_block *first_block = (t_block *)((char *)zone + ZONE_HDR_SIZE);
+    t_block *first_block = (t_block *)((char *)zone + ZONE_HDR_SIZE + color);
     zone->blocks = first_block;
-
-    first_block->next = NULL;
-    first_block->size = zone_size - ZONE_HDR_SIZE - BLOCK_HDR_SIZE;
+    zone->free_hint = first_block;
 
     /*
      * For pooled zones, first block starts free.
      * For LARGE zones, this block is consumed immediately by allocator path.
      */
-    first_block->free = (type != LARGE);
+    const size_t first_size = zone_size - ZONE_HDR_SIZE - color - 2 * BLOCK_HDR_SIZE;
+
+    block_init(first_block, 0, first_size, type, (type != LARGE) ? BLOCK_FREE : BLOCK_USED);
+    block_init(block_after(first_block), first_size, 0, type, BLOCK_USED);
 
     return zone;
 }
 
 /*
- * Create and register a new zone.
+ * Map and lay out a zone without publishing it anywhere.
+ * zone_count (zones the class already has) only matters for pooled classes.
  *
- * Caller must hold g_mutex.
+ * Needs no lock: the mapping is private to the caller until registered.
  */
-t_zone *request_new_zone(const t_zone_type type, const size_t request_size) {
-    const size_t zone_size = calculate_zone_size(type, request_size);
+t_zone *map_zone(const t_zone_type type, const size_t request_size, const size_t zone_count) {
+    size_t       slack;
+    const size_t zone_size = calculate_zone_size(type, request_size, zone_count, &slack);
+    const int    prefault  = g_malloc_prefault && type != LARGE;
 
-    /* Ask kernel for anonymous private memory. */
+    /* Ask kernel for anonymous private memory (already faulted in, if asked to). */
     void *ptr = mmap(NULL, zone_size, PROT_READ | PROT_WRITE,
-                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+                     MAP_ANONYMOUS | MAP_PRIVATE | (prefault ? ZONE_MAP_POPULATE : 0), -1, 0);
     if (ptr == MAP_FAILED) {
         debug_log_event("zone", NULL, zone_size, "failed: mmap");
         return NULL;
     }
+    if (prefault && !ZONE_MAP_POPULATE)
+        prefault_pages(ptr, zone_size);
+    SHM_STAT_ADD(classes[type].mmap_calls, 1);
+    t_latency_slow = 1;
 
-    t_zone *zone = init_zone(ptr, type, zone_size);
+    t_zone *zone = init_zone(ptr, type, zone_size, next_zone_color(slack));
+
+    debug_log_event("zone", zone, zone_size,
+                    type == LARGE ? "new large zone" : "new pooled zone");
+    return zone;
+}
+
+/*
+ * Commit and lay out a pooled zone of a global list in its class arena.
+ * Returns NULL when the arena has no room (the caller maps the zone instead).
+ *
+ * Caller holds g_zone_locks[type].
+ */
+static t_zone *commit_zone(const t_zone_type type, const size_t request_size,
+                           const size_t zone_count) {
+    size_t       slack;
+    const size_t zone_size = calculate_zone_size(type, request_size, zone_count, &slack);
+    void *       ptr       = arena_commit(type, zone_size);
+
+    if (!ptr)
+        return NULL;
+    /* mprotect() has no populate flag: touch the pages by hand. */
+    if (g_malloc_prefault)
+        prefault_pages(ptr, zone_size);
+    SHM_STAT_ADD(classes[type].mmap_calls, 1);
+    t_latency_slow = 1;
+
+    t_zone *zone = init_zone(ptr, type, zone_size, next_zone_color(slack));
+
+    debug_log_event("zone", zone, zone_size, "new arena zone");
+    return zone;
+}
+
+/*
+ * Insert a zone into a zone list, in address order.
+ * Keeping a stable order makes traversals/debug output deterministic.
+ *
+ * For the global lists, caller must hold g_zone_locks[zone->type].
+ */
+void register_zone(t_zone **list, t_zone *zone) {
+    t_zone **pp = list;
+
+    /* Arena zones are committed in address order: resume after the one below. */
+    if (list == &g_zones[zone->type]) {
+        t_zone *below = arena_zone_below(zone);
+
+        if (below)
+            pp = &below->next;
+    }
 
-    /*
-     * Insert zone in address order.
-     * Keeping a stable order makes traversals/debug output deterministic.
-     */
-    t_zone **pp = &g_zones;
     while (*pp && (uintptr_t)(*pp) < (uintptr_t)zone)
         pp = &(*pp)->next;
 
     zone->next = *pp;
     *pp = zone;
 
-    debug_log_event("zone", zone, zone_size,
-                    type == LARGE ? "new large zone" : "new pooled zone");
+    /* Live stats describe the global lists only, not private heaps. */
+    if (list == &g_zones[zone->type]) {
+        SHM_STAT_ADD(classes[zone->type].zones, 1);
+        SHM_STAT_ADD(classes[zone->type].zone_bytes, zone->size);
+    }
+}
+
+/* Remove a zone from its list; prev is its predecessor (NULL for the head). */
+void unlink_zone(t_zone **list, t_zone *zone, t_zone *prev) {
+    if (prev)
+        prev->next = zone->next;
+    else
+        *list = zone->next;
+
+    if (list == &g_zones[zone->type]) {
+        SHM_STAT_SUB(classes[zone->type].zones, 1);
+        SHM_STAT_SUB(classes[zone->type].zone_bytes, zone->size);
+    }
+}
+
+/* Give a zone back to the kernel (it must already be unlinked, and not be an arena zone). */
+void release_zone(t_zone *zone) {
+    SHM_STAT_ADD(classes[zone->type].munmap_calls, 1);
+    t_latency_slow = 1;
+    munmap(zone, zone->size);
+}
+
+/*
+ * Frontier carving of fresh TINY/SMALL zones.
+ *
+ * A fresh zone of a global TINY/SMALL list is not published as one big
+ * free block: its block area is a BLOCK_FRONTIER tail that first-fit,
+ * coalescing and the recently-freed lists never see. malloc carves new
+ * blocks off the front of the tail (one header write and a pointer
+ * bump, no search), so pages past the frontier are never touched and
+ * stay non-resident. Only reclaimed blocks enter the free structures.
+ *
+ * Each class carves from one zone at a time, its newest. When a new zone
+ * takes over, the old tail is too small for the request that needed the
+ * new zone, but not useless: it becomes an ordinary free block.
+ *
+ * Caller holds g_zone_locks[type].
+ */
+static t_zone *g_frontier_zones[ZONE_TYPE_COUNT];
+
+/* Make `zone` the carving zone of its class, retiring the previous tail. */
+static void open_frontier(t_zone *zone) {
+    t_zone *old = g_frontier_zones[zone->type];
+
+    if (old && old->frontier) {
+        t_block *tail = old->frontier;
+        t_block *prev = block_prev(tail);
+
+        /* Free blocks never sit side by side: join a free left neighbor. */
+        block_set_state(tail, BLOCK_FREE);
+        if (prev && block_state(prev) == BLOCK_FREE) {
+            coalesce_right(prev);
+            tail = prev;
+        }
+        if (tail < old->free_hint)
+            old->free_hint = tail;
+        old->frontier = NULL;
+    }
+
+    block_set_state(zone->blocks, BLOCK_FRONTIER);
+    zone->frontier = zone->blocks;
+    g_frontier_zones[zone->type] = zone;
+}
+
+/*
+ * Carve a used block of `size` bytes off the class frontier, or NULL if
+ * the tail is too small. A remainder too small to ever be carved stays in
+ * the block, like split_block() would leave it.
+ */
+t_block *carve_frontier(const t_zone_type type, const size_t size, t_zone **out_zone) {
+    t_zone *zone = g_frontier_zones[type];
+
+    if (!zone || !zone->frontier || block_size(zone->frontier) < size)
+        return NULL;
+
+    t_block *    block = zone->frontier;
+    const size_t total = block_size(block);
+
+    if (total >= size + BLOCK_HDR_SIZE + MALLOC_ALIGN) {
+        t_block *    tail = (t_block *)((char *)block + BLOCK_HDR_SIZE + size);
+        const size_t rest = total - size - BLOCK_HDR_SIZE;
+
+        block_init(tail, size, rest, type, BLOCK_FRONTIER);
+        block_after(tail)->prev_size = rest;
+        block_set_size(block, size);
+        zone->frontier = tail;
+    } else {
+        zone->frontier = NULL;
+    }
+    block_set_state(block, BLOCK_USED);
+    *out_zone = zone;
+    return block;
+}
+
+/*
+ * Commit or map a zone and register it in `list`. Pooled zones of the
+ * global lists come from the class arena when it has room; private heaps
+ * always map their own.
+ *
+ * For the global lists, caller must hold g_zone_locks[type].
+ */
+static t_zone *add_zone(t_zone **list, const t_zone_type type, const size_t request_size,
+                        const size_t zone_count) {
+    const int global = list == &g_zones[type];
+    t_zone *  zone   = global ? commit_zone(type, request_size, zone_count) : NULL;
+
+    if (!zone) {
+        zone = map_zone(type, request_size, zone_count);
+        if (zone && global)
+            arena_note_outside(type);
+    }
+    if (zone)
+        register_zone(list, zone);
+    return zone;
+}
+
+/*
+ * Create a new zone and register it in `list`; *zone_count tracks how many
+ * zones the list has received, to size the next one. Global TINY/SMALL
+ * zones start as a frontier (see carve_frontier()).
+ *
+ * For the global lists, caller must hold g_zone_locks[type].
+ */
+t_zone *request_new_zone(t_zone **list, size_t *zone_count, const t_zone_type type,
+                         const size_t request_size) {
+    t_zone *zone = add_zone(list, type, request_size, *zone_count);
+
+    if (zone) {
+        (*zone_count)++;
+        if (list == &g_zones[type] && type < MEDIUM)
+            open_frontier(zone);
+    }
     return zone;
 }
+
+/*
+ * Create a hot-size slab zone in the global list of `type`. Its owner
+ * carves it whole, so it never takes over the class frontier: the zone
+ * currently carving keeps its tail.
+ *
+ * Slabs have their own size, the base zone size of the class: they are
+ * not counted in g_zone_counts, which only grows the zones carving
+ * ordinary blocks.
+ *
+ * Caller holds g_zone_locks[type].
+ */
+t_zone *request_slab_zone(const t_zone_type type, const size_t request_size) {
+    return add_zone(&g_zones[type], type, request_size, 0);
+}
+
+/*
+ * Find the zone of a list whose mapping contains ptr.
+ *
+ * Fast range filter: blocks are only scanned once a zone matched.
+ * *out_prev (optional) receives the predecessor, for unlinking.
+ */
+t_zone *find_zone_for_ptr(t_zone *zones, const void *ptr, t_zone **out_prev) {
+    t_zone *prev = NULL;
+
+    while (zones) {
+        const char *zone_start = (const char *)zones;
+        const char *zone_end   = zone_start + zones->size;
+
+        if ((const char *)ptr >= zone_start && (const char *)ptr < zone_end) {
+            if (out_prev)
+                *out_prev = prev;
+            return zones;
+        }
+        prev = zones;
+        zones = zones->next;
+    }
+    return NULL;
+}
+
+/*
+ * Recover the block of a user pointer in O(1), whatever the zone size.
+ *
+ * The header in front of ptr is trusted only if it is tagged with the
+ * zone's class and its sizes agree with both neighbors: the header after
+ * the payload must record this size as prev_size, and the previous block
+ * (if any) must be exactly prev_size long. Every size is range-checked
+ * against the zone before it is followed, so an interior or foreign
+ * pointer (e.g. free(ptr + 16)) is rejected without touching memory
+ * outside the zone.
+ */
+t_block *block_from_ptr(const t_zone *zone, const void *ptr) {
+    /* Slab zones hold equal slots: the slot index is a division. */
+    if (zone->hot)
+        return hot_slab_block(zone, ptr);
+
+    const char *fence = (const char *)zone + zone->size - BLOCK_HDR_SIZE;
+
+    if ((uintptr_t)ptr % MALLOC_ALIGN != 0
+        || (const char *)ptr < (const char *)zone->blocks + BLOCK_HDR_SIZE
+        || (const char *)ptr > fence)
+        return NULL;
+
+    t_block *    block = (t_block *)((char *)ptr - BLOCK_HDR_SIZE);
+    const size_t size  = block_size(block);
+
+    if (block_class(block) != zone->type || size == 0 || size > (size_t)(fence - (const char *)ptr))
+        return NULL;
+    if (block_after(block)->prev_size != size)
+        return NULL;
+
+    if (block == zone->blocks)
+        return block->prev_size == 0 ? block : NULL;
+
+    const size_t room_before = (size_t)((char *)block - (char *)zone->blocks) - BLOCK_HDR_SIZE;
+
+    if (block->prev_size == 0 || block->prev_size > room_before)
+        return NULL;
+    return block_size(block_prev(block)) == block->prev_size ? block : NULL;
+}
@@ -0,0 +1,38 @@
+#include "../include/ft_malloc.h"
+
+/*
+ * Header overhead benchmark: a mixed TINY/SMALL workload, then the
+ * utilization report. Compare the "mapped" and "overhead" figures of the
+ * TINY, SMALL and Total lines between two builds.
+ *
+ * 50k allocations of 16 to 1008 bytes; every third one is freed, then
+ * the same number is allocated again.
+ */
+
+#define OBJECTS 50000
+
+static char	*g_objs[OBJECTS];
+
+static size_t	object_size(size_t i)
+{
+	return 16 + (i * 7919) % 993;
+}
+
+int main(void)
+{
+	for (size_t i = 0; i < OBJECTS; i++)
+		g_objs[i] = malloc(object_size(i));
+	for (size_t i = 0; i < OBJECTS; i += 3)
+	{
+		free(g_objs[i]);
+		g_objs[i] = NULL;
+	}
+	for (size_t i = 0; i < OBJECTS; i += 3)
+		g_objs[i] = malloc(object_size(i + 1));
+
+	show_alloc_mem_stats();
+
+	for (size_t i = 0; i < OBJECTS; i++)
+		free(g_objs[i]);
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include "../include/ft_malloc.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS 20000
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Number of mappings (VMAs) of this process. */
+static int	count_vmas(void)
+{
+	FILE	*maps = fopen("/proc/self/maps", "r");
+	char	line[512];
+	int		count = 0;
+
+	if (!maps)
+		return -1;
+	while (fgets(line, sizeof(line), maps))
+		count++;
+	fclose(maps);
+	return count;
+}
+
+int main(void)
+{
+	static char	*objs[OBJECTS];
+	size_t		sizes[3] = {64, 700, 5000};
+	int			ok = 1;
+
+	ft_putstr_fd("=== ARENA TEST ===\n", 1);
+
+	/* 1) Warm every pooled class once, so their ranges are reserved. */
+	for (int i = 0; i < 3; i++)
+		free(malloc(sizes[i]));
+	int before = count_vmas();
+
+	/* 2) Many zones per class: they are committed back to back, one VMA. */
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		objs[i] = malloc(sizes[i % 3]);
+		if (!objs[i])
+			ok = 0;
+		else
+			memset(objs[i], (char)i, sizes[i % 3]);
+	}
+	print_result("Allocations succeed", ok);
+	print_result("VMA count stays flat", count_vmas() - before <= 3);
+
+	/* 3) Zones of one class are contiguous: neighbors sit in order. */
+	print_result("Pooled blocks in address order", objs[3] > objs[0] && objs[6] > objs[3]);
+
+	/* 4) Arena pointers keep working through realloc and free. */
+	ok = 1;
+	for (int i = 0; i < OBJECTS; i += 3)
+	{
+		objs[i] = realloc(objs[i], 900);
+		if (!objs[i] || objs[i][0] != (char)i)
+			ok = 0;
+	}
+	print_result("realloc moves across classes", ok);
+
+	/* 5) A pointer into a block (not its start) is ignored. */
+	free(objs[1] + 8);
+	print_result("Interior pointer ignored", objs[1][0] == (char)1);
+
+	/* 6) Blocks are found at their offset: zone headers and fences are not blocks. */
+	t_zone	*zone = g_zones[TINY];
+	t_block	*first = zone->blocks;
+	size_t	size = zone->size;
+
+	free((char *)zone + ZONE_HDR_SIZE);
+	free((char *)zone + BLOCK_HDR_SIZE);
+	free((char *)zone + size);
+	free((char *)zone + size - BLOCK_HDR_SIZE);
+	print_result("Zone edges ignored", zone->blocks == first && zone->size == size
+		&& zone->type == TINY && g_zones[TINY] == zone);
+
+	for (int i = 0; i < OBJECTS; i++)
+		free(objs[i]);
+	void *again = malloc(64);
+	print_result("Freed space is reused", again != NULL);
+	free(again);
+	return 0;
+}
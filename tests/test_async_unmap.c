@@ -0,0 +1,115 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define REPORT_PATH "/tmp/ft_malloc_async_unmap.txt"
+#define LARGE_SIZE  (512 * 1024)
+
+static char g_text[1 << 16];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Write the stats report to a file and load it into g_text. */
+static void	load_report(void)
+{
+	int		fd = open(REPORT_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	ssize_t	len;
+
+	show_alloc_mem_stats_fd(fd);
+	lseek(fd, 0, SEEK_SET);
+	len = read(fd, g_text, sizeof(g_text) - 1);
+	g_text[len > 0 ? len : 0] = '\0';
+	close(fd);
+	unlink(REPORT_PATH);
+}
+
+/* Numeric value after `field` on the ASYNC UNMAP line, -1 when absent. */
+static long	reclaim_value(const char *field)
+{
+	const char *line = strstr(g_text, "ASYNC UNMAP");
+
+	if (!line || !(line = strstr(line, field)))
+		return -1;
+	return atol(line + strlen(field));
+}
+
+static void	large_cycles(int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		char *ptr = malloc(LARGE_SIZE);
+
+		if (ptr)
+			memset(ptr, i, LARGE_SIZE);
+		free(ptr);
+	}
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== ASYNC UNMAP TEST ===\n", 1);
+
+	/* 1) Disabled: no reclaimer line in the stats. */
+	large_cycles(4);
+	load_report();
+	print_result("No reclaimer while disabled", reclaim_value("pending=") == -1);
+
+	/* 2) Enabled: freed LARGE zones are unmapped by the reclaimer, in batches. */
+	print_result("mallopt(M_FT_ASYNC_UNMAP, 1)", mallopt(M_FT_ASYNC_UNMAP, 1) == 1);
+	large_cycles(200);
+	usleep(200 * 1000);
+	load_report();
+	print_result("Reclaimer unmapped the zones", reclaim_value("unmapped=") == 200);
+	print_result("Nothing left pending", reclaim_value("pending=") == 0);
+	print_result("Unmaps were batched", reclaim_value("batches=") > 0
+		&& reclaim_value("batches=") < 200);
+
+	/* 3) The cap bounds pending memory: above it, free() unmaps by itself. */
+	mallopt(M_FT_ASYNC_UNMAP, LARGE_SIZE * 2);
+	char *held[8];
+	for (int i = 0; i < 8; i++)
+		held[i] = malloc(LARGE_SIZE);
+	for (int i = 0; i < 8; i++)
+		free(held[i]);
+	load_report();
+	print_result("Pending bytes stay under the cap",
+		reclaim_value("pending=") <= LARGE_SIZE * 2 + 2 * 4096L);
+	print_result("Frees over the cap counted", reclaim_value("over_cap=") > 0);
+
+	/* 4) A forked child starts its own reclaimer (cap raised so nothing spills). */
+	mallopt(M_FT_ASYNC_UNMAP, 64 * 1024 * 1024);
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+		load_report();
+		long inherited = reclaim_value("unmapped=");
+		large_cycles(20);
+		usleep(100 * 1000);
+		load_report();
+		_exit(reclaim_value("unmapped=") >= inherited + 20 ? 0 : 1);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	print_result("Reclaimer works after fork", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	/* 5) Disabling goes back to synchronous unmapping. */
+	mallopt(M_FT_ASYNC_UNMAP, 0);
+	large_cycles(4);
+	print_result("mallopt(M_FT_ASYNC_UNMAP, 0)", malloc(16) != NULL);
+	return 0;
+}
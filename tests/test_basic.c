@@ -31,6 +31,7 @@ int main(void)
 	ft_putstr_fd("\n--- VISUALIZER ---\n", 1);
 	show_alloc_mem();
 	show_alloc_mem_ex();
+	show_alloc_mem_stats();
 	ft_putstr_fd("------------------\n", 1);
 
 	// 5. Free
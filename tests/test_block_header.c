@@ -0,0 +1,160 @@
+#include "../include/ft_malloc.h"
+#include <malloc.h>
+#include <stdint.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define COUNT 40
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Every state/class pair keeps the size intact, and each field changes alone. */
+static int	round_trip(size_t size)
+{
+	t_block	block;
+
+	for (int type = TINY; type < ZONE_TYPE_COUNT; type++)
+	{
+		for (int state = BLOCK_USED; state <= BLOCK_FRONTIER; state++)
+		{
+			block_init(&block, size, size, (t_zone_type)type, state);
+			if (block_size(&block) != size || block_state(&block) != state
+				|| block_class(&block) != (t_zone_type)type || block.prev_size != size)
+				return 0;
+			block_set_state(&block, BLOCK_FRONTIER - state);
+			block_set_size(&block, size ^ MALLOC_ALIGN);
+			if (block_size(&block) != (size ^ MALLOC_ALIGN)
+				|| block_state(&block) != BLOCK_FRONTIER - state
+				|| block_class(&block) != (t_zone_type)type)
+				return 0;
+		}
+	}
+	return 1;
+}
+
+static const t_block	*header_of(const void *ptr)
+{
+	return (const t_block *)((const char *)ptr - BLOCK_HDR_SIZE);
+}
+
+/* TINY zone holding ptr (test is single threaded: no lock needed). */
+static t_zone	*tiny_zone_of(const void *ptr)
+{
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+		if ((const char *)ptr >= (const char *)zone
+			&& (const char *)ptr < (const char *)zone + zone->size)
+			return zone;
+	return NULL;
+}
+
+/* Carve the zone's frontier away (fillers are kept), so first-fit serves the next miss. */
+static void	exhaust_frontier(const t_zone *zone)
+{
+	while (zone->frontier)
+		if (!malloc(16))
+			return;
+}
+
+/*
+ * Walk a zone from its first block: every prev_size matches the block
+ * before it, and the walk ends on the zero-size fence at the zone's end.
+ * Returns the number of blocks, 0 if anything disagrees.
+ */
+static size_t	check_zone(const t_zone *zone)
+{
+	const t_block	*fence = (const t_block *)((const char *)zone + zone->size - BLOCK_HDR_SIZE);
+	const t_block	*block = zone->blocks;
+	size_t			prev_size = 0;
+	size_t			count = 0;
+
+	if (block->prev_size != 0)
+		return 0;
+	while (block)
+	{
+		if (block->prev_size != prev_size || block_class(block) != TINY
+			|| (const char *)block_after(block) > (const char *)fence)
+			return 0;
+		prev_size = block_size(block);
+		count++;
+		if (!block_next(block) && block_after(block) != fence)
+			return 0;
+		block = block_next(block);
+	}
+	if (block_size(fence) != 0 || block_state(fence) != BLOCK_USED || fence->prev_size != prev_size)
+		return 0;
+	return count;
+}
+
+int main(void)
+{
+	char	*ptrs[COUNT];
+	int		ok = 1;
+
+	ft_putstr_fd("=== BLOCK HEADER TEST ===\n", 1);
+
+	/* Exact sizes would otherwise move to hot-size slabs. */
+	mallopt(M_FT_HOT_SLABS, 0);
+
+	/* 1) Layout: 16 bytes, payloads stay 16-aligned. */
+	print_result("Header is 16 bytes", sizeof(t_block) == 16 && BLOCK_HDR_SIZE == MALLOC_ALIGN);
+
+	/* 2) Size, state and class share one word without clobbering each other. */
+	const size_t	sizes[] = {0, MALLOC_ALIGN, TINY_MALLOC_LIMIT, TINY_MALLOC_LIMIT + MALLOC_ALIGN,
+		SMALL_MALLOC_LIMIT, MEDIUM_MALLOC_LIMIT, MEDIUM_ZONE_SIZE, ZONE_MAX_SIZE,
+		(size_t)1 << 40, SIZE_MAX & ~BLOCK_FLAGS_MASK};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		if (!round_trip(sizes[i]))
+			ok = 0;
+	print_result("Size/state/class round-trip at boundary sizes", ok);
+
+	/* 3) Fresh blocks: the walk from zone->blocks stops on the fence. */
+	for (int i = 0; i < COUNT; i++)
+		ptrs[i] = malloc(16 + (i % 7) * 16);
+	t_zone	*zone = tiny_zone_of(ptrs[0]);
+	size_t	blocks = zone ? check_zone(zone) : 0;
+
+	print_result("Walk stops at the fence", blocks >= COUNT);
+	print_result("Neighbors found from sizes", block_prev(block_next(zone->blocks)) == zone->blocks
+		&& block_prev(zone->blocks) == NULL);
+
+	/* 4) Coalescing (a flush of parked neighbors) keeps prev_size in step. */
+	for (int i = 10; i < 20; i++)
+		free(ptrs[i]);
+	flush_deferred_blocks(TINY);
+	print_result("prev_size consistent after coalesce", check_zone(zone) == blocks - 9);
+
+	/* 5) Splitting the merged block keeps it too: realloc growth takes its head... */
+	char	*grown = realloc(ptrs[9], 64);
+
+	print_result("prev_size consistent after realloc split",
+		grown == ptrs[9] && block_size(header_of(grown)) == 64 && check_zone(zone) == blocks - 9);
+
+	/* ...and once the fresh tail is gone, first-fit splits what is left. */
+	exhaust_frontier(zone);
+	blocks = check_zone(zone);
+	char	*reused = malloc(32);
+
+	print_result("prev_size consistent after first-fit split",
+		reused == grown + 64 + BLOCK_HDR_SIZE && blocks && check_zone(zone) == blocks + 1);
+
+	free(reused);
+	free(grown);
+	for (int i = 0; i < COUNT; i++)
+		if (i < 9 || i >= 20)
+			free(ptrs[i]);
+	flush_deferred_blocks(TINY);
+	print_result("prev_size consistent after freeing everything", check_zone(zone) != 0);
+	return 0;
+}
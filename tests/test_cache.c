@@ -0,0 +1,90 @@
+#include "../include/ft_malloc.h"
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS 300
+
+typedef struct s_conn
+{
+	int		magic;      /* Set by the constructor only. */
+	char	buffer[40];
+}	t_conn;
+
+static int	g_ctor_calls = 0;
+static int	g_dtor_calls = 0;
+
+static void	conn_ctor(void *obj)
+{
+	((t_conn *)obj)->magic = 0x5EED;
+	g_ctor_calls++;
+}
+
+static void	conn_dtor(void *obj)
+{
+	((t_conn *)obj)->magic = 0;
+	g_dtor_calls++;
+}
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== OBJECT CACHE TEST ===\n", 1);
+
+	t_cache *cache = ft_cache_create("conn", sizeof(t_conn), 64, conn_ctor, conn_dtor);
+	print_result("Cache create", cache != NULL);
+	if (!cache)
+		return 1;
+
+	/* 1) Objects come out constructed and aligned. */
+	t_conn	*objs[OBJECTS];
+	int		ok = 1;
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		objs[i] = ft_cache_alloc(cache);
+		if (!objs[i] || objs[i]->magic != 0x5EED || ((size_t)objs[i] & 63))
+			ok = 0;
+		else
+			memset(objs[i]->buffer, 'x', sizeof(objs[i]->buffer));
+	}
+	print_result("Alloc constructed + aligned", ok);
+
+	/* 2) Free + alloc reuses the object without running the constructor again. */
+	int ctor_before = g_ctor_calls;
+	objs[0]->magic = 0xBEEF;
+	ft_cache_free(cache, objs[0]);
+	t_conn *again = ft_cache_alloc(cache);
+	print_result("Reuse keeps object state", again == objs[0] && again->magic == 0xBEEF);
+	print_result("No constructor on reuse", g_ctor_calls == ctor_before);
+	objs[0] = again;
+
+	/* 3) Bad pointers are ignored. */
+	int local;
+	ft_cache_free(cache, &local);
+	ft_cache_free(cache, (char *)objs[1] + 8);
+	print_result("Foreign pointers ignored", 1);
+
+	/* 4) Stats through the show_alloc_mem family. */
+	ft_putstr_fd("\n", 1);
+	show_alloc_mem_stats();
+
+	/* 5) Destroy runs the destructor on cached objects. */
+	for (int i = 0; i < OBJECTS; i++)
+		ft_cache_free(cache, objs[i]);
+	ft_cache_destroy(cache);
+	print_result("Destructor on destroy", g_dtor_calls == g_ctor_calls);
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+#include "../include/ft_malloc.h"
+#include <stdint.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS      8000
+#define SLAB_OBJECTS 101 /* Slots of a slab of 1000-byte objects (see grow_cache()). */
+#define SLABS        4
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+int main(void)
+{
+	static char	*objs[OBJECTS];
+	static void	*cached[SLAB_OBJECTS * SLABS];
+	int			ok = 1;
+
+	ft_putstr_fd("=== COLORING TEST ===\n", 1);
+
+	/* 1) Enough TINY blocks for many zones. */
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		objs[i] = malloc(64);
+		if (!objs[i])
+			ok = 0;
+		else
+			ft_memset(objs[i], (char)i, 64);
+	}
+	print_result("Allocations succeed", ok);
+
+	/* 2) Every block area starts at a cache-line offset past the header... */
+	size_t	zones = 0;
+	size_t	colored = 0;
+	size_t	last_offset = 0;
+	int		rotates = 0;
+	int		layout_ok = 1;
+
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+	{
+		const size_t	offset = (size_t)((char *)zone->blocks - (char *)zone);
+		t_block			*block = zone->blocks;
+
+		if (offset < ZONE_HDR_SIZE || (offset - ZONE_HDR_SIZE) % CACHE_LINE_SIZE != 0)
+			layout_ok = 0;
+		/* ...and the block chain still ends on the fence, at the zone end. */
+		while (block_size(block) != 0)
+			block = block_after(block);
+		if ((char *)block + BLOCK_HDR_SIZE != (char *)zone + zone->size)
+			layout_ok = 0;
+
+		if (offset != ZONE_HDR_SIZE)
+			colored++;
+		if (zones > 0 && offset != last_offset)
+			rotates = 1;
+		last_offset = offset;
+		zones++;
+	}
+	print_result("Zone layout is consistent", layout_ok && zones > 2);
+	print_result("Successive zones get different colors", rotates && colored > 0);
+
+	/* 3) Data survives, and the colored zones free cleanly. */
+	ok = 1;
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		if (objs[i][0] != (char)i || objs[i][63] != (char)i)
+			ok = 0;
+		free(objs[i]);
+	}
+	print_result("Data intact", ok);
+
+	/* 4) Cache slabs: the first slot of each slab moves by a cache line. */
+	t_cache	*cache = ft_cache_create("colors", 1000, 0, NULL, NULL);
+	int		slabs_differ = 1;
+	int		aligned = 1;
+
+	for (int i = 0; i < SLAB_OBJECTS * SLABS; i++)
+	{
+		cached[i] = ft_cache_alloc(cache);
+		if ((uintptr_t)cached[i] % MALLOC_ALIGN != 0)
+			aligned = 0;
+	}
+	for (int s = 1; s < SLABS; s++)
+	{
+		const size_t	page = (size_t)getpagesize();
+		const uintptr_t	first = (uintptr_t)cached[(s - 1) * SLAB_OBJECTS];
+		const uintptr_t	next = (uintptr_t)cached[s * SLAB_OBJECTS];
+
+		if (first % page == next % page)
+			slabs_differ = 0;
+	}
+	print_result("Cache objects aligned", aligned);
+	print_result("Slabs get different colors", slabs_differ);
+
+	for (int i = 0; i < SLAB_OBJECTS * SLABS; i++)
+		ft_cache_free(cache, cached[i]);
+	ft_cache_destroy(cache);
+	return 0;
+}
@@ -62,14 +62,27 @@ static void	test_mandatory(void)
 	void *s2 = malloc(1000);
 	print_result("Malloc Small", s1 != NULL && s2 != NULL);
 
-	void *l1 = malloc(10000);
-	void *l2 = malloc(20000);
+	void *m1 = malloc(10000);
+	void *m2 = malloc(200000);
+	print_result("Malloc Medium", m1 != NULL && m2 != NULL);
+
+	void *l1 = malloc(300000);
+	void *l2 = malloc(1000000);
 	print_result("Malloc Large", l1 != NULL && l2 != NULL);
 
 	free(t1); free(t2);
 	free(s1); free(s2);
+	free(m1); free(m2);
 	free(l1); free(l2);
 	print_result("Free All", 1);
+
+	/* Freed MEDIUM neighbors merge back, so the same spot serves again. */
+	void *m3 = malloc(10000);
+	void *m4 = malloc(10000);
+	free(m3); free(m4);
+	void *m5 = malloc(20000);
+	print_result("Medium coalesce + reuse", m5 == m3);
+	free(m5);
 }
 
 /* -------------------------------------------------------------------------- */
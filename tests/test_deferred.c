@@ -0,0 +1,122 @@
+#include "../include/ft_malloc.h"
+#include <malloc.h>
+#include <stdint.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define FILLER 16
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+static const t_block	*header_of(const void *ptr)
+{
+	return (const t_block *)((const char *)ptr - BLOCK_HDR_SIZE);
+}
+
+/* TINY zone holding ptr (test is single threaded: no lock needed). */
+static t_zone	*tiny_zone_of(const void *ptr)
+{
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+		if ((const char *)ptr >= (const char *)zone
+			&& (const char *)ptr < (const char *)zone + zone->size)
+			return zone;
+	return NULL;
+}
+
+/* Carve the current TINY frontier away (fillers are kept), so first-fit serves the next miss. */
+static void	exhaust_frontier(const void *inside)
+{
+	t_zone	*zone = tiny_zone_of(inside);
+
+	while (zone && zone->frontier)
+		if (!malloc(FILLER))
+			return;
+}
+
+int main(void)
+{
+	char		*run[DEFERRED_FREE_LIMIT + 1];
+	uintptr_t	addr[DEFERRED_FREE_LIMIT + 1]; /* Compared after free(): kept as plain addresses. */
+	int			ok = 1;
+
+	ft_putstr_fd("=== DEFERRED COALESCING TEST ===\n", 1);
+
+	/* Exact sizes would otherwise move to hot-size slabs. */
+	mallopt(M_FT_HOT_SLABS, 0);
+
+	/* 1) Overflowing the list flushes it; merges stop at used blocks. */
+	for (int i = 0; i <= DEFERRED_FREE_LIMIT; i++)
+	{
+		run[i] = malloc(32);
+		addr[i] = (uintptr_t)run[i];
+	}
+	char			*stop = malloc(32);
+	const t_block	*merged = header_of(run[0]);
+
+	for (int i = 0; i <= DEFERRED_FREE_LIMIT; i++)
+		free(run[i]);
+	print_result("Overflow flushes the list", block_state(merged) == BLOCK_FREE);
+	print_result("Adjacent parked blocks become one",
+		header_of(stop)->prev_size == block_size(merged)
+		&& block_size(merged) == (DEFERRED_FREE_LIMIT + 1) * (32 + BLOCK_HDR_SIZE) - BLOCK_HDR_SIZE);
+	print_result("Used neighbor untouched", block_state(header_of(stop)) == BLOCK_USED);
+
+	/* Once the fresh tail is gone, first-fit splits the merged space up again. */
+	exhaust_frontier(stop);
+	for (int i = 0; i <= DEFERRED_FREE_LIMIT; i++)
+		if ((uintptr_t)malloc(32) != addr[i])
+			ok = 0;
+	print_result("Merged space reused by first-fit", ok);
+
+	/* 2) A recently freed block is handed back whole to a request it fits. */
+	char			*a = malloc(48);
+	char			*guard = malloc(48);
+	const t_block	*a_hdr = header_of(a);	/* Freed blocks are inspected through their header. */
+
+	free(a);
+	print_result("Freed block is parked", block_state(a_hdr) == BLOCK_DEFERRED);
+	char	*b = malloc(40);
+	print_result("Exact-fit reuse of the parked block", header_of(b) == a_hdr && block_size(a_hdr) == 48);
+
+	/* 3) A parked block too big for the request is left alone (no split). */
+	free(b);
+	char	*c = malloc(16);
+	print_result("No split of a parked block", header_of(c) != a_hdr && block_state(a_hdr) == BLOCK_DEFERRED);
+
+	/* 4) Three neighbors parked, then a miss: they merge, a larger request fits. */
+	char			*x = malloc(16);
+	char			*y = malloc(16);
+	char			*z = malloc(16);
+	char			*fence = malloc(16);
+	const t_block	*x_hdr = header_of(x);
+
+	exhaust_frontier(fence);
+	free(x);
+	free(y);
+	free(z);
+	char	*big = malloc(3 * 16 + 2 * BLOCK_HDR_SIZE);
+	print_result("Flush merges neighbors for a larger request", header_of(big) == x_hdr);
+	print_result("Merged block spans all three",
+		block_size(header_of(big)) == 3 * 16 + 2 * BLOCK_HDR_SIZE
+		&& header_of(fence)->prev_size == block_size(header_of(big)));
+	print_result("Lone parked block stays whole", block_state(a_hdr) == BLOCK_FREE
+		&& block_size(a_hdr) == 48);
+
+	free(guard);
+	free(c);
+	free(big);
+	free(fence);
+	free(stop);
+	return 0;
+}
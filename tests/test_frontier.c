@@ -0,0 +1,117 @@
+#include "../include/ft_malloc.h"
+#include <stdint.h>
+#include <sys/mman.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define COUNT 50
+#define SIZE  64
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* TINY zone holding ptr (test is single threaded: no lock needed). */
+static t_zone	*tiny_zone_of(const void *ptr)
+{
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+		if ((const char *)ptr >= (const char *)zone
+			&& (const char *)ptr < (const char *)zone + zone->size)
+			return zone;
+	return NULL;
+}
+
+/* Resident pages strictly between the frontier page and the fence page. */
+static int	resident_past_frontier(const t_zone *zone, int *checked)
+{
+	const uintptr_t	page = (uintptr_t)getpagesize();
+	const uintptr_t	first = ((uintptr_t)zone->frontier + BLOCK_HDR_SIZE + page - 1) & ~(page - 1);
+	const uintptr_t	last = ((uintptr_t)zone + zone->size - BLOCK_HDR_SIZE) & ~(page - 1);
+	unsigned char	vec[256];
+	int				resident = 0;
+
+	*checked = 0;
+	if (first >= last || (last - first) / page > sizeof(vec))
+		return 0;
+	if (mincore((void *)first, last - first, vec) != 0)
+		return -1;
+	for (size_t i = 0; i < (last - first) / page; i++)
+	{
+		resident += vec[i] & 1;
+		(*checked)++;
+	}
+	return resident;
+}
+
+int main(void)
+{
+	char	*ptrs[COUNT];
+	int		ok = 1;
+
+	ft_putstr_fd("=== FRONTIER TEST ===\n", 1);
+
+	/* 1) Fresh space is carved in order: each block right after the previous one. */
+	int	adjacent = 0;
+
+	for (int i = 0; i < COUNT; i++)
+	{
+		ptrs[i] = malloc(SIZE);
+		if (!ptrs[i])
+			ok = 0;
+		if (i > 0 && ptrs[i] == ptrs[i - 1] + SIZE + BLOCK_HDR_SIZE)
+			adjacent++;
+	}
+	print_result("Allocations succeed", ok);
+	print_result("Blocks carved back to back", adjacent >= COUNT - 2);
+
+	/* 2) The tail is carved before freed space is searched. */
+	free(ptrs[10]);
+	free(ptrs[11]);
+	char	*small = malloc(SIZE / 2);
+	print_result("Frontier used before free blocks", small > ptrs[COUNT - 1]);
+
+	/* 3) Pages past the frontier are never touched. */
+	t_zone	*zone = tiny_zone_of(small);
+	int		checked = 0;
+	int		resident = zone && zone->frontier ? resident_past_frontier(zone, &checked) : -1;
+
+	print_result("Frontier is tracked", zone && zone->frontier
+		&& (char *)zone->frontier == small + SIZE / 2);
+	print_result("Untouched pages stay non-resident", resident == 0);
+	if (checked == 0)
+		ft_putstr_fd("  (no page between frontier and fence to check)\n", 1);
+
+	/* 4) Once a newer zone takes over, the old tail becomes an ordinary free block. */
+	t_zone	*old = zone;
+	char	*last = small;
+
+	while (last && tiny_zone_of(last) == old)
+		last = malloc(TINY_MALLOC_LIMIT);
+	t_block	*block = old ? old->blocks : NULL;
+
+	while (block && block_next(block))
+		block = block_next(block);
+	print_result("New zone carves from its own frontier",
+		last && tiny_zone_of(last) != old && tiny_zone_of(last)->frontier);
+	print_result("Old tail handed to the free structures",
+		old && !old->frontier && block && block_state(block) != BLOCK_FRONTIER);
+
+	/* 5) Everything still frees and reuses normally. */
+	for (int i = 0; i < COUNT; i++)
+		if (i != 10 && i != 11)
+			free(ptrs[i]);
+	free(small);
+	char	*again = malloc(SIZE);
+	print_result("Freed space is reused", again != NULL);
+	free(again);
+	return 0;
+}
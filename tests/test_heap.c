@@ -0,0 +1,67 @@
+#include "../include/ft_malloc.h"
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS 2000
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== PRIVATE HEAP TEST ===\n", 1);
+
+	t_heap *heap = ft_heap_create();
+	print_result("Heap create", heap != NULL);
+	if (!heap)
+		return 1;
+
+	/* 1) Individual free + reuse inside the heap. */
+	void *first = ft_heap_malloc(heap, 40);
+	void *second = ft_heap_malloc(heap, 40);
+	ft_heap_free(heap, first);
+	void *again = ft_heap_malloc(heap, 40);
+	print_result("Heap free + reuse", first != NULL && again == first);
+	ft_heap_free(heap, second);
+
+	/* 2) Many mixed-size objects, all 16-byte aligned and writable. */
+	void *objs[OBJECTS];
+	int   aligned = 1;
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		size_t size = (size_t)(i % 3 == 0 ? 40 : (i % 3 == 1 ? 700 : 5000));
+		objs[i] = ft_heap_malloc(heap, size);
+		if (!objs[i] || ((size_t)objs[i] & 15))
+			aligned = 0;
+		else
+			memset(objs[i], i & 0xFF, size);
+	}
+	print_result("Heap malloc (TINY/SMALL/LARGE)", aligned);
+
+	/* 3) Heap zones stay private: the global view must not list them. */
+	ft_putstr_fd("\nGlobal show_alloc_mem() (heap blocks must not appear):\n", 1);
+	show_alloc_mem();
+
+	/* 4) Foreign pointer must be ignored by the heap. */
+	void *global = malloc(40);
+	ft_heap_free(heap, global);
+	free(global);
+	print_result("Foreign pointer ignored", 1);
+
+	/* 5) Bulk release: no per-object frees. */
+	ft_heap_destroy(heap);
+	print_result("Heap destroy", 1);
+
+	return 0;
+}
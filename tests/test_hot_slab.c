@@ -0,0 +1,160 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define REPORT_PATH "/tmp/ft_malloc_hot_slab.txt"
+#define HOT_COUNT   4000
+#define ROUNDS      8
+
+static char	g_text[1 << 20];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Write the stats report to a file and load it into g_text. */
+static void	load_report(void)
+{
+	int		fd = open(REPORT_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	ssize_t	len;
+
+	show_alloc_mem_stats_fd(fd);
+	lseek(fd, 0, SEEK_SET);
+	len = read(fd, g_text, sizeof(g_text) - 1);
+	g_text[len > 0 ? len : 0] = '\0';
+	close(fd);
+	unlink(REPORT_PATH);
+}
+
+/* TINY zone holding ptr (test is single threaded: no lock needed). */
+static t_zone	*tiny_zone_of(const void *ptr)
+{
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+		if ((const char *)ptr >= (const char *)zone
+			&& (const char *)ptr < (const char *)zone + zone->size)
+			return zone;
+	return NULL;
+}
+
+/* Spiky workload: mostly 48 bytes, some noise of other sizes. */
+static void	spiky_round(char **hot)
+{
+	for (int i = 0; i < HOT_COUNT; i++)
+	{
+		hot[i] = malloc(48);
+		if (hot[i])
+			memset(hot[i], (char)i, 48);
+		free(malloc((size_t)(8 + (i * 7) % 120)));
+	}
+}
+
+int main(void)
+{
+	static char	*hot[HOT_COUNT];
+	int			ok = 1;
+
+	ft_putstr_fd("=== HOT SLAB TEST ===\n", 1);
+
+	/* 1) A dominant size gets promoted; later requests come from its slabs. */
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		spiky_round(hot);
+		if (r + 1 < ROUNDS)
+			for (int i = 0; i < HOT_COUNT; i++)
+				free(hot[i]);
+	}
+	t_zone	*slab = tiny_zone_of(hot[HOT_COUNT - 1]);
+	t_block	*block = (t_block *)(hot[HOT_COUNT - 1] - BLOCK_HDR_SIZE);
+
+	print_result("Popular size served from a slab", slab && slab->hot != NULL);
+	print_result("Slot is exact fit", block_size(block) == 48);
+
+	/* Slabs are carved whole: the regular zone carving before them keeps its tail. */
+	t_zone	*carving = NULL;
+
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+		if (zone->frontier)
+			carving = zone;
+	char	*expected = carving ? (char *)carving->frontier + BLOCK_HDR_SIZE : NULL;
+
+	flush_deferred_blocks(TINY); /* So the next request misses the recently-freed list. */
+	char	*fresh = malloc(112);
+	print_result("Frontier survives slab creation", carving && !carving->hot && fresh == expected);
+	free(fresh);
+
+	/* Slabs have the base zone size and do not push the class toward bigger zones. */
+	size_t	ordinary = 0;
+	size_t	smallest = 0;
+
+	for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+	{
+		if (zone->hot)
+			continue;
+		ordinary++;
+		if (!smallest || zone->size < smallest)
+			smallest = zone->size;
+	}
+	print_result("Slabs left out of zone growth", slab && ordinary == g_zone_counts[TINY]
+		&& slab->size == smallest);
+
+	load_report();
+	print_result("Stats show the hot size", strstr(g_text, "HOT SLAB TINY 48 bytes") != NULL);
+
+	/* 2) Slab data survives; realloc moves out of the slab; frees are checked. */
+	for (int i = 0; i < HOT_COUNT; i++)
+		if (hot[i][0] != (char)i || hot[i][47] != (char)i)
+			ok = 0;
+	print_result("Data intact", ok);
+
+	char	*moved = realloc(hot[0], 500);
+	print_result("realloc out of a slab", moved && moved[0] == 0 && moved[47] == 0);
+	free(moved);
+	hot[0] = NULL;
+
+	free(hot[1]);
+	free(hot[1]);
+	free(hot[2] + 16);
+	char	*a = malloc(48);
+	char	*b = malloc(48);
+	print_result("Double free / interior pointer ignored", a != b && hot[2][0] == 2);
+	free(a);
+	free(b);
+	hot[1] = NULL;
+
+	/* 3) The size cools down: its slabs turn back into ordinary zones. */
+	for (int i = 0; i < HOT_COUNT; i++)
+		free(hot[i]);
+	for (int i = 0; i < 20 * HOT_COUNT; i++)
+		free(malloc(96));
+	print_result("Cooled slab released", slab->hot == NULL);
+
+	load_report();
+	print_result("Retired size gone from stats", strstr(g_text, "HOT SLAB TINY 48 bytes") == NULL);
+
+	/* 4) Switched off: no more slab allocations. */
+	mallopt(M_FT_HOT_SLABS, 0);
+	for (int i = 0; i < HOT_COUNT; i++)
+		hot[i] = malloc(96);
+	ok = 1;
+	for (int i = 0; i < HOT_COUNT; i++)
+	{
+		t_zone	*zone = tiny_zone_of(hot[i]);
+
+		if (!zone || zone->hot)
+			ok = 0;
+		free(hot[i]);
+	}
+	print_result("Disabled: regular zones only", ok);
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define REPORT_PATH "/tmp/ft_malloc_latency.txt"
+#define OBJECTS     1000
+#define THREADS     4
+
+static char g_text[1 << 16];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Write the latency report to a file and load it into g_text. */
+static void	load_report(void)
+{
+	int		fd = open(REPORT_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	ssize_t	len;
+
+	show_alloc_mem_latency_fd(fd);
+	lseek(fd, 0, SEEK_SET);
+	len = read(fd, g_text, sizeof(g_text) - 1);
+	g_text[len > 0 ? len : 0] = '\0';
+	close(fd);
+	unlink(REPORT_PATH);
+}
+
+/* count= value of one report line ("malloc TINY fast"), 0 when absent. */
+static long	line_count(const char *key)
+{
+	const char *line = strstr(g_text, key);
+
+	if (!line || !(line = strstr(line, "count=")))
+		return 0;
+	return atol(line + 6);
+}
+
+static void	*worker(void *arg)
+{
+	(void)arg;
+	for (int i = 0; i < OBJECTS; i++)
+		free(malloc(32));
+	return NULL;
+}
+
+int main(void)
+{
+	static void	*objs[OBJECTS];
+	pthread_t	threads[THREADS];
+
+	ft_putstr_fd("=== LATENCY TEST ===\n", 1);
+
+	/* 1) Disabled: nothing is recorded. */
+	free(malloc(16));
+	load_report();
+	print_result("Nothing recorded while disabled", g_text[0] == '\0');
+
+	/* 2) Enabled: every public call is counted per class and path. */
+	print_result("mallopt(M_FT_LATENCY, 1)", mallopt(M_FT_LATENCY, 1) == 1);
+	for (int i = 0; i < OBJECTS; i++)
+		objs[i] = malloc(64);
+	for (int i = 0; i < OBJECTS; i++)
+		free(objs[i]);
+	void *big = malloc(1 << 20);
+	free(big);
+	free(calloc(10, 10));
+	free(realloc(malloc(2000), 4000));
+
+	load_report();
+	print_result("TINY mallocs counted",
+		line_count("malloc TINY fast") + line_count("malloc TINY slow") == OBJECTS);
+	print_result("TINY frees counted", line_count("free TINY fast") >= OBJECTS);
+	print_result("LARGE malloc is a slow path", line_count("malloc LARGE slow") == 1);
+	print_result("LARGE free is a slow path", line_count("free LARGE slow") == 1);
+	print_result("calloc counted", line_count("calloc TINY") == 1);
+	print_result("realloc counted", line_count("realloc MEDIUM") == 1
+		|| line_count("realloc SMALL") == 1);
+	print_result("Percentiles printed", strstr(g_text, "p50=") && strstr(g_text, "p99.9=")
+		&& strstr(g_text, "max="));
+
+	/* 3) Threads record into their own sets, reports add them together. */
+	long before = line_count("malloc TINY fast") + line_count("malloc TINY slow");
+	for (int i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, worker, NULL);
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+	load_report();
+	print_result("Thread samples aggregated",
+		line_count("malloc TINY fast") + line_count("malloc TINY slow")
+			== before + THREADS * OBJECTS);
+
+	/* 4) Disabling stops recording and keeps the samples. */
+	mallopt(M_FT_LATENCY, 0);
+	free(malloc(16));
+	load_report();
+	print_result("Samples kept after disabling",
+		line_count("malloc TINY fast") + line_count("malloc TINY slow")
+			== before + THREADS * OBJECTS);
+	return 0;
+}
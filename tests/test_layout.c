@@ -0,0 +1,151 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define LAYOUT_PATH "/tmp/ft_malloc_layout.jsonl"
+#define EXIT_PATH   "/tmp/ft_malloc_layout_exit.jsonl"
+#define COUNT       64
+
+static char	g_text[4 << 20];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Load a dump into g_text; returns its length (0 if missing). */
+static size_t	load_file(const char *path)
+{
+	int		fd = open(path, O_RDONLY);
+	size_t	len = 0;
+	ssize_t	n;
+
+	if (fd < 0)
+		return 0;
+	while ((n = read(fd, g_text + len, sizeof(g_text) - 1 - len)) > 0)
+		len += (size_t)n;
+	g_text[len] = '\0';
+	close(fd);
+	unlink(path);
+	return len;
+}
+
+static size_t	count_lines(const char *kind)
+{
+	char	needle[64];
+	size_t	count = 0;
+
+	snprintf(needle, sizeof(needle), "{\"kind\":\"%s\"", kind);
+	for (const char *line = g_text; *line; line = strchr(line, '\n') + 1)
+	{
+		if (strncmp(line, needle, strlen(needle)) == 0)
+			count++;
+		if (!strchr(line, '\n'))
+			break;
+	}
+	return count;
+}
+
+/* Block line of the zone holding ptr (test is single threaded: no lock needed). */
+static int	has_block(const void *ptr, const char *state)
+{
+	char	line[256];
+	size_t	id = 0;
+
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+		for (t_zone *zone = g_zones[type]; zone; zone = zone->next, id++)
+			if ((const char *)ptr > (const char *)zone
+				&& (const char *)ptr < (const char *)zone + zone->size)
+			{
+				snprintf(line, sizeof(line),
+					"{\"kind\":\"block\",\"zone\":%zu,\"offset\":%zu,\"size\":%zu,\"state\":\"%s\"",
+					id, (size_t)((const char *)ptr - BLOCK_HDR_SIZE - (const char *)zone),
+					block_size((const t_block *)((const char *)ptr - BLOCK_HDR_SIZE)), state);
+				return strstr(g_text, line) != NULL;
+			}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	char	*ptrs[COUNT];
+
+	/* Child of step 4: allocate, then let the exit dump run. */
+	if (argc > 1 && strcmp(argv[1], "child") == 0)
+	{
+		ptrs[0] = malloc(4000);
+		return ptrs[0] == NULL;
+	}
+
+	ft_putstr_fd("=== LAYOUT TEST ===\n", 1);
+
+	/* 1) Mixed heap: used and freed blocks in every pooled class, plus a LARGE one. */
+	for (int i = 0; i < COUNT; i++)
+		ptrs[i] = malloc((size_t)(16 + (i % 4) * 400));
+	char	*large = malloc(1 << 20);
+	for (int i = 0; i < COUNT; i += 2)
+		free(ptrs[i]);
+
+	print_result("Dump written", show_alloc_mem_layout_file(LAYOUT_PATH) == 0);
+	size_t	len = load_file(LAYOUT_PATH);
+
+	/* 2) One heap line, then one line per zone and per block. */
+	size_t	zones = 0;
+	size_t	blocks = 0;
+
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+		for (t_zone *zone = g_zones[type]; zone; zone = zone->next)
+		{
+			zones++;
+			for (t_block *block = zone->blocks; block; block = block_next(block))
+				blocks++;
+		}
+	print_result("Heap line first", strncmp(g_text, "{\"kind\":\"heap\"", 14) == 0);
+	print_result("One line per zone", count_lines("zone") == zones);
+	print_result("One line per block", count_lines("block") == blocks);
+
+	int	well_formed = len > 0 && g_text[len - 1] == '\n';
+
+	for (char *line = g_text; well_formed && *line; line = strchr(line, '\n') + 1)
+		if (line[0] != '{' || strchr(line, '\n')[-1] != '}')
+			well_formed = 0;
+	print_result("Every line is a JSON object", well_formed);
+
+	/* 3) Blocks are listed at their offset, with size and state. */
+	print_result("Used block listed", has_block(ptrs[1], "used") && has_block(large, "used"));
+	print_result("Freed block listed", has_block(ptrs[0], "deferred") || has_block(ptrs[0], "free"));
+	print_result("Classes named", strstr(g_text, "\"class\":\"TINY\"") && strstr(g_text, "\"class\":\"LARGE\""));
+
+	/* 4) MallocLayoutDump writes the layout at exit. */
+	pid_t	pid = fork();
+	if (pid == 0)
+	{
+		char	*child_argv[] = {argv[0], "child", NULL};
+		char	*child_env[] = {"MallocLayoutDump=" EXIT_PATH, NULL};
+
+		execve("/proc/self/exe", child_argv, child_env);
+		_exit(127);
+	}
+	int	status = 0;
+	waitpid(pid, &status, 0);
+	len = load_file(EXIT_PATH);
+	print_result("Exit dump written", WIFEXITED(status) && WEXITSTATUS(status) == 0
+		&& len > 0 && strstr(g_text, "\"size\":4000,\"state\":\"used\",\"class\":\"MEDIUM\"") != NULL);
+
+	for (int i = 1; i < COUNT; i += 2)
+		free(ptrs[i]);
+	free(large);
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "../include/ft_malloc.h"
+#include <pthread.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define THREADS 8
+#define ROUNDS  20000
+#define OBJECT  500 /* SMALL */
+#define HOLD_US 100000
+
+static volatile int	g_started;
+static volatile int	g_go;
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Counters are only written by the lock owner: read them while holding it. */
+static t_ft_lock	snapshot(t_zone_type type)
+{
+	t_ft_lock	copy;
+
+	lock_zone_class(type);
+	copy = g_zone_locks[type];
+	unlock_zone_class(type);
+	return copy;
+}
+
+static void	*worker(void *arg)
+{
+	(void)arg;
+	__atomic_add_fetch(&g_started, 1, __ATOMIC_RELEASE);
+	while (!__atomic_load_n(&g_go, __ATOMIC_ACQUIRE))
+		;
+	for (int i = 0; i < ROUNDS; i++)
+		free(malloc(OBJECT));
+	return NULL;
+}
+
+int main(void)
+{
+	pthread_t	threads[THREADS];
+
+	ft_putstr_fd("=== LOCK CONTENTION TEST ===\n", 1);
+
+	/* 1) One thread: every acquisition is counted, none is contended. */
+	free(malloc(OBJECT));
+	t_ft_lock	before = snapshot(SMALL);
+	for (int i = 0; i < ROUNDS; i++)
+		free(malloc(OBJECT));
+	t_ft_lock	after = snapshot(SMALL);
+	size_t		per_round = (after.acquisitions - before.acquisitions - 1) / ROUNDS;
+
+	print_result("Acquisitions counted", per_round >= 2
+		&& after.acquisitions - before.acquisitions == per_round * ROUNDS + 1);
+	print_result("No contention alone", after.contended == before.contended
+		&& after.sleeps == before.sleeps);
+
+	/*
+	 * 2) The lock is held when the workers are let go: they spin out and
+	 * sleep. Threads are created first, pthread_create() may malloc().
+	 */
+	for (int i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, worker, NULL);
+	while (__atomic_load_n(&g_started, __ATOMIC_ACQUIRE) < THREADS)
+		usleep(1000);
+	t_ft_lock	tiny_before = snapshot(TINY);
+
+	before = snapshot(SMALL);
+	lock_zone_class(SMALL);
+	__atomic_store_n(&g_go, 1, __ATOMIC_RELEASE);
+	usleep(HOLD_US);
+	unlock_zone_class(SMALL);
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+	after = snapshot(SMALL);
+
+	const size_t	acquisitions = after.acquisitions - before.acquisitions;
+	const size_t	contended = after.contended - before.contended;
+	const size_t	sleeps = after.sleeps - before.sleeps;
+
+	print_result("Every hammering call acquired the lock",
+		acquisitions >= (size_t)THREADS * ROUNDS * per_round + 1);
+	print_result("Blocked workers counted as contended", contended >= THREADS);
+	print_result("Blocked workers slept", sleeps >= 1);
+	/* One contended acquisition may sleep more than once: sleeps has no upper bound. */
+	print_result("Contended within acquisitions", contended <= acquisitions);
+
+	/* 3) Other classes keep their own lock and see none of it. */
+	t_ft_lock	tiny_after = snapshot(TINY);
+
+	print_result("Other class lock untouched", tiny_after.contended == tiny_before.contended
+		&& tiny_after.sleeps == tiny_before.sleeps);
+	return 0;
+}
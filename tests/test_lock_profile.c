@@ -0,0 +1,146 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define REPORT_PATH "/tmp/ft_malloc_lock_profile.txt"
+#define OBJECTS     2000
+#define THREADS     4
+#define SITES       40 /* More than a class table holds. */
+
+static char g_text[1 << 16];
+static char g_sites[SITES][16]; /* Site names, told apart by address like __func__. */
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Write the lock profile to a file and load it into g_text. */
+static void	load_report(void)
+{
+	int		fd = open(REPORT_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	ssize_t	len;
+
+	show_alloc_mem_lock_profile_fd(fd);
+	lseek(fd, 0, SEEK_SET);
+	len = read(fd, g_text, sizeof(g_text) - 1);
+	g_text[len > 0 ? len : 0] = '\0';
+	close(fd);
+	unlink(REPORT_PATH);
+}
+
+/* Numeric value after `field` on the line of `key` ("TINY malloc_core "), -1 when absent. */
+static long	line_value(const char *key, const char *field)
+{
+	const char	*line = strstr(g_text, key);
+	const char	*end;
+	const char	*value;
+
+	if (!line)
+		return -1;
+	end = strchr(line, '\n');
+	value = strstr(line, field);
+	if (!value || (end && value > end))
+		return -1;
+	return atol(value + strlen(field));
+}
+
+/* Whether the report has a line for `site` in `class_prefix` ("SMALL "). */
+static int	site_listed(const char *class_prefix, const char *site)
+{
+	char	key[64];
+	size_t	len = strlen(class_prefix);
+
+	memcpy(key, class_prefix, len);
+	memcpy(key + len, site, strlen(site));
+	len += strlen(site);
+	memcpy(key + len, " ", 2);
+	return strstr(g_text, key) != NULL;
+}
+
+static void	*worker(void *arg)
+{
+	void	*objs[64];
+
+	(void)arg;
+	for (int round = 0; round < OBJECTS / 64; round++)
+	{
+		for (int i = 0; i < 64; i++)
+			objs[i] = malloc(32);
+		for (int i = 0; i < 64; i++)
+			free(objs[i]);
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	pthread_t	threads[THREADS];
+
+	ft_putstr_fd("=== LOCK PROFILE TEST ===\n", 1);
+
+	/* 1) Disabled: nothing is recorded. */
+	free(malloc(16));
+	load_report();
+	print_result("Nothing recorded while disabled", g_text[0] == '\0');
+
+	/* 2) Enabled: every class lock acquisition is counted per call site. */
+	print_result("mallopt(M_FT_LOCK_PROFILE, 1)", mallopt(M_FT_LOCK_PROFILE, 1) == 1);
+	for (int i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, worker, NULL);
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+	free(malloc(1 << 20));
+
+	load_report();
+	long mallocs = line_value("TINY malloc_core ", "acquisitions=");
+	long contended = line_value("TINY malloc_core ", "contended=");
+	print_result("malloc site profiled", mallocs >= THREADS * (OBJECTS / 64) * 64);
+	print_result("free site profiled", line_value("TINY free_core ", "acquisitions=") > 0);
+	print_result("LARGE class profiled", line_value("LARGE ", "acquisitions=") > 0);
+	print_result("Contended within acquisitions", contended >= 0 && contended <= mallocs);
+	print_result("Hold time recorded", line_value("TINY malloc_core ", "hold_total=") > 0);
+	print_result("Wait fields printed", strstr(g_text, "wait_total=")
+		&& strstr(g_text, "wait_max=") && strstr(g_text, "hold_max="));
+
+	/* 3) A full table sends new sites to "(other)"; a named site keeps its name. */
+	int		named = 0;
+	int		kept = 1;
+
+	for (int i = 0; i < SITES; i++)
+	{
+		memcpy(g_sites[i], "site_00", 8);
+		g_sites[i][5] = (char)('0' + i / 10);
+		g_sites[i][6] = (char)('0' + i % 10);
+		lock_zone_class_at(SMALL, g_sites[i]);
+		unlock_zone_class(SMALL);
+		load_report();
+		if (site_listed("SMALL ", g_sites[i]))
+			named = i + 1;
+		for (int j = 0; j < named; j++)
+			kept &= site_listed("SMALL ", g_sites[j]);
+	}
+	print_result("Named sites keep their names", named > 0 && kept);
+	print_result("Overflow sites share (other)", named < SITES
+		&& line_value("SMALL (other) ", "acquisitions=") == SITES - named);
+
+	/* 4) Disabling stops recording and keeps the results. */
+	mallopt(M_FT_LOCK_PROFILE, 0);
+	for (int i = 0; i < 100; i++)
+		free(malloc(32));
+	load_report();
+	print_result("Results kept after disabling",
+		line_value("TINY malloc_core ", "acquisitions=") == mallocs);
+	return 0;
+}
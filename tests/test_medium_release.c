@@ -0,0 +1,122 @@
+#include "../include/ft_malloc.h"
+#include <stdint.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECT  (200 * 1024) /* MEDIUM */
+#define COUNT   60           /* About three 4 MB zones. */
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Resident pages of a zone, per mincore(). */
+static size_t	resident_pages(const t_zone *zone)
+{
+	static unsigned char	vec[ZONE_MAX_SIZE / 4096];
+	const size_t			page = (size_t)getpagesize();
+	const size_t			pages = zone->size / page;
+	size_t					count = 0;
+
+	if (pages > sizeof(vec) || mincore((void *)zone, zone->size, vec) != 0)
+		return (size_t)-1;
+	for (size_t i = 0; i < pages; i++)
+		count += vec[i] & 1;
+	return count;
+}
+
+/* Zones past the first that still hold their pages, `skip` left out. */
+static size_t	resident_zones(const t_zone *skip)
+{
+	size_t	count = 0;
+
+	for (const t_zone *zone = g_zones[MEDIUM] ? g_zones[MEDIUM]->next : NULL; zone; zone = zone->next)
+		if (zone != skip && resident_pages(zone) > 2)
+			count++;
+	return count;
+}
+
+static size_t	zone_count(void)
+{
+	size_t	count = 0;
+
+	for (const t_zone *zone = g_zones[MEDIUM]; zone; zone = zone->next)
+		count++;
+	return count;
+}
+
+int main(void)
+{
+	char	*objs[COUNT];
+
+	ft_putstr_fd("=== MEDIUM RELEASE TEST ===\n", 1);
+
+	/* 1) Fill several zones and touch every page. */
+	for (int i = 0; i < COUNT; i++)
+	{
+		objs[i] = malloc(OBJECT);
+		if (objs[i])
+			memset(objs[i], i + 1, OBJECT);
+	}
+	const size_t	zones = zone_count();
+	const t_zone	*first = g_zones[MEDIUM];
+	const t_zone	*second = first ? first->next : NULL;
+	const size_t	touched = second ? resident_pages(second) : 0;
+
+	print_result("Several MEDIUM zones in use", zones >= 3 && touched > 0);
+
+	/*
+	 * 2) Freeing everything gives the pages of every zone back but the
+	 * first and the last one to go empty (the spare).
+	 */
+	for (int i = 0; i < COUNT; i++)
+		free(objs[i]);
+	print_result("Empty zones released, one spare kept", second && resident_zones(NULL) == 1);
+	print_result("First zone kept warm", resident_pages(first) > 2);
+	print_result("Zones stay mapped and indexed", zone_count() == zones);
+
+	/* 3) Released zones are reused as they are: no new mapping, fresh pages. */
+	int	intact = 1;
+
+	for (int i = 0; i < COUNT; i++)
+	{
+		objs[i] = malloc(OBJECT);
+		if (!objs[i])
+			intact = 0;
+		else
+			memset(objs[i], 0x70 + i % 16, OBJECT);
+	}
+	for (int i = 0; i < COUNT && intact; i++)
+		for (size_t j = 0; j < OBJECT; j += 4096)
+			if (objs[i][j] != (char)(0x70 + i % 16) || objs[i][OBJECT - 1] != (char)(0x70 + i % 16))
+				intact = 0;
+	print_result("Released zones reused", intact && zone_count() == zones);
+
+	/* 4) A zone with one live block keeps its pages. */
+	int	live = -1;
+
+	for (int i = 0; i < COUNT && live < 0; i++)
+		if (second && objs[i] >= (char *)second && objs[i] < (char *)second + second->size)
+			live = i;
+	for (int i = 0; i < COUNT; i++)
+		if (i != live)
+			free(objs[i]);
+	print_result("Zone with a live block untouched", live >= 0
+		&& resident_pages(second) >= OBJECT / (size_t)getpagesize()
+		&& objs[live][OBJECT / 2] == (char)(0x70 + live % 16));
+	if (live >= 0)
+		free(objs[live]);
+	print_result("Last zone to go empty becomes the spare", resident_pages(second) > 2);
+	print_result("Previous spare released", resident_zones(second) == 0);
+	return 0;
+}
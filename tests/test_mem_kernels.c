@@ -0,0 +1,164 @@
+#include "../include/ft_malloc.h"
+#include <stdint.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define MAX_LEN   300
+#define MAX_SKEW  64
+#define GUARD     128
+#define AREA      (GUARD + MAX_SKEW + 4096 + GUARD)
+
+static const char	*g_names[MEM_KERNEL_COUNT] = {"generic", "sse2", "avx2", "avx512"};
+
+/* Extra lengths: each kernel's small-copy cutoff and a few vector bodies past it. */
+static const size_t	g_long_lens[] = {511, 512, 513, 1000, 4095, 4096};
+
+static unsigned char	g_dst[AREA] __attribute__((aligned(64)));
+static unsigned char	g_ref[AREA] __attribute__((aligned(64)));
+static unsigned char	g_src[AREA] __attribute__((aligned(64)));
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+static void	print_kernel_result(const char *what, t_mem_kernel kernel, int condition)
+{
+	ft_putstr_fd(g_names[kernel], 1);
+	ft_putstr_fd(" ", 1);
+	print_result(what, condition);
+}
+
+/* Window a kernel may touch for len bytes at any skew, with a guard on each side. */
+static size_t	span(size_t len)
+{
+	return GUARD + MAX_SKEW + len + GUARD;
+}
+
+/* Same noise in dst and ref, so bytes outside [skew, skew + len) must still match. */
+static void	reset(size_t len)
+{
+	for (size_t i = 0; i < span(len); i++)
+	{
+		g_dst[i] = (unsigned char)(i * 13 + 7);
+		g_ref[i] = g_dst[i];
+		g_src[i] = (unsigned char)(i * 31 + 1);
+	}
+}
+
+/* One length at one head misalignment; the whole window is compared, guards included. */
+static int	check_fill(size_t skew, size_t len)
+{
+	reset(len);
+	mem_fill(g_dst + GUARD + skew, 0xA5, len);
+	memset(g_ref + GUARD + skew, 0xA5, len);
+	return memcmp(g_dst, g_ref, span(len)) == 0;
+}
+
+/* The source runs at its own misalignment: kernels must not assume both agree. */
+static int	check_copy(size_t skew, size_t src_skew, size_t len)
+{
+	reset(len);
+	mem_copy(g_dst + GUARD + skew, g_src + GUARD + src_skew, len);
+	memcpy(g_ref + GUARD + skew, g_src + GUARD + src_skew, len);
+	return memcmp(g_dst, g_ref, span(len)) == 0;
+}
+
+static void	test_kernel(t_mem_kernel kernel)
+{
+	int	fill_ok = 1;
+	int	copy_ok = 1;
+
+	for (size_t skew = 0; skew < MAX_SKEW; skew++)
+	{
+		for (size_t len = 0; len <= MAX_LEN; len++)
+		{
+			fill_ok &= check_fill(skew, len);
+			copy_ok &= check_copy(skew, skew, len);
+			copy_ok &= check_copy(skew, (skew * 7 + 3) % MAX_SKEW, len);
+		}
+		for (size_t i = 0; i < sizeof(g_long_lens) / sizeof(g_long_lens[0]); i++)
+		{
+			fill_ok &= check_fill(skew, g_long_lens[i]);
+			copy_ok &= check_copy(skew, (skew + 1) % MAX_SKEW, g_long_lens[i]);
+		}
+	}
+	print_kernel_result("mem_fill matches memset", kernel, fill_ok);
+	print_kernel_result("mem_copy matches memcpy", kernel, copy_ok);
+}
+
+/* Buffers past the non-temporal threshold, shared by every kernel. */
+typedef struct s_nt_buffers {
+	unsigned char	*dst;
+	unsigned char	*src;
+	size_t			len;
+}	t_nt_buffers;
+
+/*
+ * Above the threshold the body uses non-temporal stores. Buffers carry a
+ * guard byte on each side and start off any vector alignment.
+ */
+static void	test_nt(t_mem_kernel kernel, const t_nt_buffers *nt)
+{
+	unsigned char	*dst = nt->dst;
+	const size_t	len = nt->len;
+	int				ok;
+
+	dst[0] = 0x11;
+	dst[len + 13] = 0x22;
+	mem_fill(dst + 13, 0x3C, len);
+	ok = dst[0] == 0x11 && dst[len + 13] == 0x22;
+	for (size_t i = 0; ok && i < len; i++)
+		ok = dst[13 + i] == 0x3C;
+	print_kernel_result("Non-temporal fill", kernel, ok);
+
+	mem_copy(dst + 13, nt->src + 5, len);
+	ok = dst[0] == 0x11 && dst[len + 13] == 0x22 && memcmp(dst + 13, nt->src + 5, len) == 0;
+	print_kernel_result("Non-temporal copy", kernel, ok);
+}
+
+int main(void)
+{
+	int				widest = MEM_KERNEL_GENERIC;
+	t_nt_buffers	nt;
+
+	ft_putstr_fd("=== MEM KERNELS TEST ===\n", 1);
+
+	nt.len = mem_nt_threshold() + 4096 + 3;
+	nt.dst = malloc(nt.len + 14);
+	nt.src = malloc(nt.len + 5);
+	print_result("Buffers past the non-temporal threshold", nt.dst && nt.src);
+	if (!nt.dst || !nt.src)
+		return 1;
+	for (size_t i = 0; i < nt.len; i++)
+		nt.src[5 + i] = (unsigned char)(i * 131 + (i >> 12));
+
+	for (int kernel = 0; kernel < MEM_KERNEL_COUNT; kernel++)
+	{
+		if (!mem_kernels_select((t_mem_kernel)kernel))
+		{
+			ft_putstr_fd(g_names[kernel], 1);
+			ft_putstr_fd(": not supported here, skipped\n", 1);
+			continue;
+		}
+		widest = kernel;
+		test_kernel((t_mem_kernel)kernel);
+		test_nt((t_mem_kernel)kernel, &nt);
+	}
+	print_result("Unknown kernel refused", mem_kernels_select(MEM_KERNEL_COUNT) == 0);
+
+	/* Leave the library on the kernel it would have picked itself. */
+	mem_kernels_select((t_mem_kernel)widest);
+	free(nt.dst);
+	free(nt.src);
+	return 0;
+}
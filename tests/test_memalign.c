@@ -0,0 +1,95 @@
+#include "../include/ft_malloc.h"
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS 600
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+static int	is_aligned(const void *ptr, size_t alignment)
+{
+	return ((uintptr_t)ptr & (alignment - 1)) == 0;
+}
+
+int main(void)
+{
+	static void	*objs[OBJECTS];
+	size_t		alignments[] = {16, 32, 64, 256, 4096, 65536, 2 * 1024 * 1024};
+	size_t		sizes[] = {1, 24, 100, 900, 5000, 200000, 600000};
+	int			ok = 1;
+	int			n = 0;
+
+	ft_putstr_fd("=== MEMALIGN TEST ===\n", 1);
+
+	/* 1) Every alignment x size combination, in every class. */
+	for (int round = 0; round < 10; round++)
+		for (size_t a = 0; a < sizeof(alignments) / sizeof(*alignments); a++)
+			for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++)
+			{
+				void *ptr = NULL;
+
+				if (posix_memalign(&ptr, alignments[a], sizes[s]) != 0
+					|| !is_aligned(ptr, alignments[a]))
+					ok = 0;
+				else
+					memset(ptr, (char)n, sizes[s]);
+				objs[n++] = ptr;
+			}
+	print_result("posix_memalign aligned in every class", ok);
+
+	/* 2) Neighbors were not overwritten by the fills. */
+	ok = 1;
+	n = 0;
+	for (int round = 0; round < 10; round++)
+		for (size_t a = 0; a < sizeof(alignments) / sizeof(*alignments); a++)
+			for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++, n++)
+				if (((unsigned char *)objs[n])[sizes[s] - 1] != (unsigned char)n)
+					ok = 0;
+	print_result("Aligned blocks do not overlap", ok);
+
+	/* 3) Aligned blocks are ordinary blocks: realloc and free them. */
+	ok = 1;
+	for (int i = 0; i < n; i += 7)
+	{
+		objs[i] = realloc(objs[i], 3000);
+		if (!objs[i] || ((unsigned char *)objs[i])[0] != (unsigned char)i)
+			ok = 0;
+	}
+	print_result("realloc keeps aligned contents", ok);
+	for (int i = 0; i < n; i++)
+		free(objs[i]);
+
+	/* 4) Released fragments are reused by plain mallocs. */
+	void *plain = malloc(48);
+	print_result("Heap usable after frees", plain != NULL);
+	free(plain);
+
+	/* 5) aligned_alloc / memalign / valloc and argument checks. */
+	void *a = aligned_alloc(128, 1000);
+	void *m = memalign(512, 10);
+	void *v = valloc(100);
+	print_result("aligned_alloc / memalign / valloc", is_aligned(a, 128) && is_aligned(m, 512)
+		&& is_aligned(v, (size_t)getpagesize()));
+	free(a);
+	free(m);
+	free(v);
+
+	void *bad = (void *)1;
+	print_result("Non power of two rejected", posix_memalign(&bad, 48, 10) == EINVAL
+		&& bad == (void *)1 && aligned_alloc(3, 10) == NULL && errno == EINVAL);
+	return 0;
+}
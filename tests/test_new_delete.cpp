@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+extern "C" {
+#include "../include/ft_malloc.h"
+}
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+static int					g_handler_calls = 0;
+static volatile std::size_t	g_huge = static_cast<std::size_t>(1) << 62; /* No mmap() can serve this. */
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Class whose zone list holds ptr, -1 when ft_malloc does not own it. */
+static int	owner_class(const void *ptr)
+{
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+		for (const t_zone *zone = g_zones[type]; zone; zone = zone->next)
+			if ((const char *)ptr >= (const char *)zone
+				&& (const char *)ptr < (const char *)zone + zone->size)
+				return type;
+	return -1;
+}
+
+struct alignas(256) Aligned
+{
+	char bytes[300];
+};
+
+struct Node
+{
+	Node	*next;
+	long	value;
+};
+
+static void	counting_handler(void)
+{
+	/* Give up after two tries: the loop must then throw. */
+	if (++g_handler_calls >= 2)
+		std::set_new_handler(nullptr);
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== NEW / DELETE TEST ===\n", 1);
+
+	/* 1) Plain, array and sized new / delete go through ft_malloc. */
+	Node	*node = new Node();
+	char	*bytes = new char[5000];
+	print_result("new served by ft_malloc", owner_class(node) == TINY);
+	print_result("new[] served by ft_malloc", owner_class(bytes) == MEDIUM);
+	delete node;
+	delete[] bytes;
+
+	/* 2) Many sized deletes (list of nodes), then reuse. */
+	Node	*head = nullptr;
+	for (long i = 0; i < 10000; i++)
+		head = new Node{head, i};
+	long	sum = 0;
+	while (head)
+	{
+		Node *next = head->next;
+		sum += head->value;
+		delete head;
+		head = next;
+	}
+	print_result("Sized delete of 10000 nodes", sum == 10000L * 9999 / 2);
+
+	/* 3) Over-aligned types use the aligned overloads. */
+	Aligned	*one = new Aligned();
+	Aligned	*many = new Aligned[5];
+	print_result("Aligned new", reinterpret_cast<std::uintptr_t>(one) % 256 == 0
+		&& owner_class(one) >= 0);
+	print_result("Aligned new[]", reinterpret_cast<std::uintptr_t>(many) % 256 == 0);
+	std::memset(many, 7, sizeof(Aligned) * 5);
+	delete one;
+	delete[] many;
+
+	/* 4) Failure: the new_handler loop runs, then std::bad_alloc. */
+	int		threw = 0;
+	std::set_new_handler(counting_handler);
+	try
+	{
+		void *huge = ::operator new(g_huge);
+		::operator delete(huge);
+	}
+	catch (const std::bad_alloc &)
+	{
+		threw = 1;
+	}
+	print_result("new_handler loop then bad_alloc", threw && g_handler_calls == 2);
+
+	/* 5) nothrow variants return nullptr instead. */
+	void	*none = ::operator new[](g_huge, std::nothrow);
+	print_result("nothrow new returns nullptr", none == nullptr);
+	return 0;
+}
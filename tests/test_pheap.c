@@ -0,0 +1,173 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define HEAP_PATH  "/tmp/ft_malloc_pheap.bin"
+#define OTHER_PATH "/tmp/ft_malloc_pheap_other.bin"
+#define HEAP_SIZE  (4UL * 1024UL * 1024UL)
+#define NODES      1000
+#define CRASHES    100
+
+/* Persistent list node: links are offsets, so they survive a remap. */
+typedef struct s_node {
+	size_t	next;
+	size_t	value;
+	char	name[40];
+}	t_node;
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Walk the list from the root; returns the number of nodes holding expected data. */
+static size_t	walk_list(t_pheap *heap, size_t *sum)
+{
+	size_t	count = 0;
+
+	*sum = 0;
+	for (t_node *node = ft_pheap_root(heap); node; node = ft_pheap_pointer(heap, node->next))
+	{
+		if (node->name[0] != 'n' || strtoul(node->name + 1, NULL, 10) != node->value)
+			break;
+		*sum += node->value;
+		count++;
+	}
+	return count;
+}
+
+/* Crash child: allocate and free forever until killed. */
+static void	churn(void)
+{
+	t_pheap	*heap = ft_pheap_open(HEAP_PATH, 0);
+	void	*slots[256] = {0};
+	size_t	seed = (size_t)getpid();
+
+	if (!heap)
+		_exit(1);
+	for (;;)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		size_t	i = (seed >> 33) % 256;
+
+		ft_pheap_free(heap, slots[i]);
+		slots[i] = ft_pheap_malloc(heap, (seed >> 20) % 3000);
+	}
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== PERSISTENT HEAP TEST ===\n", 1);
+	unlink(HEAP_PATH);
+
+	/* 1) Build a list in a fresh heap and record its head as the root. */
+	t_pheap	*heap = ft_pheap_open(HEAP_PATH, HEAP_SIZE);
+	size_t	head = 0;
+	int		ok = heap != NULL;
+
+	for (size_t i = 0; ok && i < NODES; i++)
+	{
+		t_node	*node = ft_pheap_malloc(heap, sizeof(t_node));
+
+		if (!node)
+			ok = 0;
+		else
+		{
+			node->next = head;
+			node->value = i;
+			snprintf(node->name, sizeof(node->name), "n%zu", i);
+			head = ft_pheap_offset(heap, node);
+		}
+	}
+	ft_pheap_set_root(heap, ft_pheap_pointer(heap, head));
+	print_result("Heap created and filled", ok);
+	print_result("Second open refused while open", ft_pheap_open(HEAP_PATH, 0) == NULL);
+
+	void	*old_base = ft_pheap_pointer(heap, 1);
+	ft_pheap_close(heap);
+
+	/* 2) Reopen at another address: the list is found again through offsets. */
+	void	*blocker = mmap(old_base, HEAP_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	size_t	sum;
+
+	heap = ft_pheap_open(HEAP_PATH, 0);
+	print_result("Reopened at a different address", heap && ft_pheap_pointer(heap, 1) != old_base);
+	print_result("Data structures survive", heap && walk_list(heap, &sum) == NODES
+		&& sum == (size_t)NODES * (NODES - 1) / 2);
+	print_result("Metadata consistent", ft_pheap_check(heap) == 0);
+	munmap(blocker, HEAP_SIZE);
+
+	/* 3) Invalid frees are ignored, the heap reports when it is full. */
+	t_node	*root = ft_pheap_root(heap);
+	char	outside[32];
+
+	ft_pheap_free(heap, outside);
+	ft_pheap_free(heap, (char *)root + 16);
+	void	*big = ft_pheap_malloc(heap, HEAP_SIZE);
+	print_result("Bad frees ignored, full heap returns NULL",
+		big == NULL && ft_pheap_check(heap) == 0 && walk_list(heap, &sum) == NODES);
+	ft_pheap_close(heap);
+
+	/* 4) Kill a writer at random points: reopening always finds a consistent heap. */
+	int	crash_ok = 1;
+
+	for (int i = 0; i < CRASHES; i++)
+	{
+		pid_t	pid = fork();
+
+		if (pid == 0)
+			churn();
+		usleep((useconds_t)(2000 + (i * 7919) % 20000));
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+
+		heap = ft_pheap_open(HEAP_PATH, 0);
+		if (!heap || ft_pheap_check(heap) != 0 || walk_list(heap, &sum) != NODES)
+			crash_ok = 0;
+		ft_pheap_close(heap);
+	}
+	print_result("Consistent after crashes", crash_ok);
+
+	/* 5) A file that is not a heap is refused. */
+	int	fd = open(OTHER_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	write(fd, "not a heap, just some text", 26);
+	close(fd);
+	print_result("Foreign file refused", ft_pheap_open(OTHER_PATH, 0) == NULL);
+
+	/* A zero-filled file is not a heap either: it is left as it is. */
+	char	zeros[4096] = {0};
+	char	back[4096];
+
+	fd = open(OTHER_PATH, O_WRONLY | O_TRUNC);
+	write(fd, zeros, sizeof(zeros));
+	close(fd);
+	int	zero_ok = ft_pheap_open(OTHER_PATH, 0) == NULL;
+
+	fd = open(OTHER_PATH, O_RDONLY);
+	zero_ok = zero_ok && read(fd, back, sizeof(back)) == (ssize_t)sizeof(back)
+		&& memcmp(back, zeros, sizeof(zeros)) == 0;
+	close(fd);
+	print_result("Zero-filled file refused, not formatted", zero_ok);
+	unlink(OTHER_PATH);
+
+	heap = ft_pheap_open(HEAP_PATH, 0);
+	print_result("Sync", ft_pheap_sync(heap) == 0);
+	ft_pheap_close(heap);
+	unlink(HEAP_PATH);
+	return 0;
+}
@@ -0,0 +1,70 @@
+#include "../include/ft_malloc.h"
+#include <string.h>
+#include <sys/resource.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define WARM_BYTES (4 * 1024 * 1024)
+#define OBJECTS    4000
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+static long	minor_faults(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+}
+
+int main(void)
+{
+	static void *objs[OBJECTS];
+
+	ft_putstr_fd("=== PREFAULT TEST ===\n", 1);
+
+	/* 1) Unknown parameters are rejected, ours are accepted. */
+	print_result("mallopt rejects unknown param", mallopt(12345, 1) == 0);
+	print_result("mallopt(M_FT_PREFAULT, 1)", mallopt(M_FT_PREFAULT, 1) == 1);
+	print_result("mallopt(M_FT_WARM, 4M)", mallopt(M_FT_WARM, WARM_BYTES) == 1);
+
+	/* 2) Warmed zones: filling 4000 x 64 bytes (~250 KB) must not fault. */
+	memset(objs, 0, sizeof(objs)); /* Fault the test's own array in first. */
+	long before = minor_faults();
+	int  ok = 1;
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		objs[i] = malloc(64);
+		if (!objs[i])
+			ok = 0;
+		else
+			memset(objs[i], i & 0xFF, 64);
+	}
+	long faults = minor_faults() - before;
+	print_result("TINY allocations after warm-up", ok);
+	print_result("No page faults in warmed TINY zones", faults < 4);
+
+	/* 3) MEDIUM zones are warmed too. */
+	before = minor_faults();
+	void *medium = malloc(200000);
+	if (medium)
+		memset(medium, 0x42, 200000);
+	print_result("No page faults in warmed MEDIUM zone", medium && minor_faults() - before < 4);
+
+	for (int i = 0; i < OBJECTS; i++)
+		free(objs[i]);
+	free(medium);
+	mallopt(M_FT_PREFAULT, 0);
+	return 0;
+}
@@ -1,4 +1,6 @@
 #include "../include/ft_malloc.h"
+#include <malloc.h>
+#include <stdint.h>
 #include <string.h>
 
 //MallocScribble=1 ./test_scribble
@@ -15,27 +17,54 @@ static int	check_range_is(const unsigned char *p, size_t from, size_t to, unsign
     return 1;
 }
 
-int main(void)
+static void	report(int ok, const char *what)
 {
-    ft_putstr_fd("=== SCRIBBLE FREE TEST (0x55) ===\n", 1);
-    ft_putstr_fd("- malloc scribble: 0xAA on requested_size\n", 1);
-    ft_putstr_fd("- free scribble:   0x55 on full block size\n\n", 1);
+    ft_putstr_fd(ok ? "[SUCCESS] " : "[FAIL] ", 1);
+    ft_putstr_fd(what, 1);
+    ft_putchar_fd('\n', 1);
+}
+
+// TINY zone holding ptr (single threaded: no lock needed)
+static t_zone	*tiny_zone_of(const void *ptr)
+{
+    for (t_zone *zone = g_zones[TINY]; zone; zone = zone->next)
+    {
+        if ((const char *)ptr >= (const char *)zone
+            && (const char *)ptr < (const char *)zone + zone->size)
+            return zone;
+    }
+    return NULL;
+}
+
+// Payload the next carve of this zone's frontier hands out, NULL once it is used up
+static unsigned char	*frontier_payload(const t_zone *zone)
+{
+    if (!zone || !zone->frontier)
+        return NULL;
+    return (unsigned char *)zone->frontier + BLOCK_HDR_SIZE;
+}
 
-    // 1) Allocate a 64-byte block and fill it with 0xAA ourselves (just to be sure)
+// 1) Fresh zone space is carved before freed blocks are searched.
+//    The freed block is tracked by address and zone, both taken before free().
+static int	test_frontier_first(uintptr_t *freed, t_zone **zone)
+{
+    // Allocate a 64-byte block and fill it with 0xAA ourselves (just to be sure)
     unsigned char *a = (unsigned char *)malloc(64);
     if (!a)
-        return 1;
+        return 0;
     memset(a, 0xAA, 64);
+    *freed = (uintptr_t)a;
+    *zone = tiny_zone_of(a);
 
-    // 2) Free it -> your free() should scribble 0x55 over the whole 64-byte payload
+    // Free it -> your free() should scribble 0x55 over the whole 64-byte payload
     free(a);
 
-    // 3) Reallocate a SMALLER size that should reuse the same free block.
-    //    malloc scribble will write 0xAA only over requested_size (here: 1 byte),
-    //    so bytes [1..15] (aligned block) should still be 0x55 if free-scribble worked.
+    // Reallocate a SMALLER size: it comes from the frontier, not from the freed block.
+    // malloc scribble will write 0xAA only over requested_size (here: 1 byte).
+    unsigned char *expected = frontier_payload(*zone);
     unsigned char *b = (unsigned char *)malloc(1);
     if (!b)
-        return 1;
+        return 0;
 
     ft_putstr_fd("Reallocated 1 byte at: ", 1);
     ft_putptr_fd(b, 1);
@@ -44,15 +73,51 @@ int main(void)
     // Dump for manual inspection too
     show_alloc_mem_ex();
 
-    // Check: first byte likely 0xAA (malloc scribble), the rest should be 0x55 (free scribble residue)
-    // We check the next 15 bytes to avoid dependence on requested_size.
-    int ok = check_range_is(b, 1, 16, 0x55);
+    report((uintptr_t)b != *freed && b == expected, "malloc(1) carved from the frontier, freed block left alone");
+    report(b[0] == 0xAA, "malloc scribble: byte [0] is 0xAA");
 
-    if (ok)
-        ft_putstr_fd("\n[SUCCESS] free scribble detected: bytes [1..15] are 0x55\n", 1);
-    else
-        ft_putstr_fd("\n[FAIL] free scribble NOT detected in bytes [1..15]\n", 1);
+    // The freed block is parked as it was left: past its list link, it still carries the free scribble
+    report(check_range_is((const unsigned char *)*freed, sizeof(void *), 64, 0x55),
+        "free scribble detected: parked block is 0x55");
+    return 1;
+}
+
+// 2) Once the frontier is gone, freed blocks are reused and still carry the free scribble
+static void	test_reuse(uintptr_t freed, t_zone *zone)
+{
+    while (zone && zone->frontier)
+    {
+        if (!malloc(16))
+            return;
+    }
 
-    free(b);
+    // The miss flushes the parked block; first-fit splits it and hands back its head.
+    // Bytes [1..15] (aligned block) should still be 0x55 if free-scribble worked.
+    unsigned char *c = (unsigned char *)malloc(1);
+    if (!c)
+        return;
+
+    report(zone && !zone->frontier && (uintptr_t)c == freed,
+        "malloc(1) reuses the freed block once the frontier is gone");
+    report(c[0] == 0xAA && check_range_is(c, 1, 16, 0x55),
+        "free scribble detected: bytes [1..15] are 0x55");
+    free(c);
+}
+
+int main(void)
+{
+    uintptr_t freed = 0;
+    t_zone *zone = NULL;
+
+    ft_putstr_fd("=== SCRIBBLE FREE TEST (0x55) ===\n", 1);
+    ft_putstr_fd("- malloc scribble: 0xAA on requested_size\n", 1);
+    ft_putstr_fd("- free scribble:   0x55 on full block size\n\n", 1);
+
+    // Exact sizes would otherwise move to hot-size slabs
+    mallopt(M_FT_HOT_SLABS, 0);
+
+    if (!test_frontier_first(&freed, &zone))
+        return 1;
+    test_reuse(freed, zone);
     return 0;
 }
@@ -0,0 +1,178 @@
+#include "../include/ft_malloc.h"
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define HEAP_SIZE (8UL * 1024UL * 1024UL)
+#define PRODUCERS 4
+#define MESSAGES  500
+#define CRASHES   50
+
+/* Message handed from a producer to the consumer, by offset. */
+typedef struct s_message {
+	size_t	producer;
+	size_t	seq;
+	size_t	len;
+	char	data[];
+}	t_message;
+
+static char	g_name[64];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Producer child: attach on its own, send MESSAGES offsets down the pipe. */
+static void	produce(size_t id, int fd, void *inherited)
+{
+	t_shm_heap	*heap = ft_shm_heap_attach(g_name);
+
+	if (!heap || ft_shm_heap_pointer(heap, 4096) == inherited)
+		_exit(1);
+	for (size_t seq = 0; seq < MESSAGES; seq++)
+	{
+		const size_t	len = 64 + (seq * 131 + id * 17) % 4000;
+		t_message		*msg;
+
+		while (!(msg = ft_shm_heap_malloc(heap, sizeof(*msg) + len)))
+			usleep(100);
+		msg->producer = id;
+		msg->seq = seq;
+		msg->len = len;
+		memset(msg->data, (int)(id * 31 + seq), len);
+
+		size_t	offset = ft_shm_heap_offset(heap, msg);
+		if (write(fd, &offset, sizeof(offset)) != sizeof(offset))
+			_exit(1);
+	}
+	ft_shm_heap_detach(heap);
+	_exit(0);
+}
+
+/* Crash child: allocate and free forever until killed. */
+static void	churn(void)
+{
+	t_shm_heap	*heap = ft_shm_heap_attach(g_name);
+	void		*slots[128] = {0};
+	size_t		seed = (size_t)getpid();
+
+	if (!heap)
+		_exit(1);
+	for (;;)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		size_t	i = (seed >> 33) % 128;
+
+		ft_shm_heap_free(heap, slots[i]);
+		slots[i] = ft_shm_heap_malloc(heap, (seed >> 20) % 2000);
+	}
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== SHARED MEMORY HEAP TEST ===\n", 1);
+	snprintf(g_name, sizeof(g_name), "/ft_malloc_test_heap.%d", (int)getpid());
+
+	/* 1) Create, then a second create of the same name fails. */
+	t_shm_heap	*heap = ft_shm_heap_create(g_name, HEAP_SIZE);
+
+	print_result("Heap created", heap != NULL);
+	print_result("Duplicate create refused", ft_shm_heap_create(g_name, HEAP_SIZE) == NULL);
+	print_result("Missing heap not attached", ft_shm_heap_attach("/ft_malloc_no_such_heap") == NULL);
+
+	/* 2) Producers allocate and fill; the consumer reads in place and frees. */
+	int		fds[2];
+	pid_t	pids[PRODUCERS];
+
+	pipe(fds);
+	for (size_t id = 0; id < PRODUCERS; id++)
+	{
+		pids[id] = fork();
+		if (pids[id] == 0)
+		{
+			close(fds[0]);
+			produce(id, fds[1], ft_shm_heap_pointer(heap, 4096));
+		}
+	}
+	close(fds[1]);
+
+	size_t	received = 0;
+	size_t	next_seq[PRODUCERS] = {0};
+	int		intact = 1;
+	size_t	offset;
+
+	while (read(fds[0], &offset, sizeof(offset)) == sizeof(offset))
+	{
+		t_message	*msg = ft_shm_heap_pointer(heap, offset);
+
+		if (!msg || msg->producer >= PRODUCERS || msg->seq != next_seq[msg->producer]++)
+			intact = 0;
+		else
+			for (size_t i = 0; i < msg->len; i++)
+				if (msg->data[i] != (char)(msg->producer * 31 + msg->seq))
+					intact = 0;
+		ft_shm_heap_free(heap, msg);
+		received++;
+	}
+	close(fds[0]);
+
+	int	children_ok = 1;
+	for (size_t id = 0; id < PRODUCERS; id++)
+	{
+		int	status = 0;
+
+		waitpid(pids[id], &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			children_ok = 0;
+	}
+	print_result("Producers attached at their own address", children_ok);
+	print_result("Every message received intact", received == PRODUCERS * MESSAGES && intact);
+	print_result("Metadata consistent", ft_shm_heap_check(heap) == 0);
+
+	void	*whole = ft_shm_heap_malloc(heap, HEAP_SIZE - 64 * 1024);
+	print_result("All blocks back and merged", whole != NULL);
+	ft_shm_heap_free(heap, whole);
+
+	/* 3) Kill processes while they use the heap: the next locker repairs it. */
+	int	crash_ok = 1;
+
+	for (int i = 0; i < CRASHES; i++)
+	{
+		pid_t	pid = fork();
+
+		if (pid == 0)
+			churn();
+		usleep((useconds_t)(1000 + (i * 7919) % 10000));
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+		if (ft_shm_heap_check(heap) != 0)
+			crash_ok = 0;
+	}
+	print_result("Consistent after crashes", crash_ok);
+
+	/* 4) A root object is shared between attachments. */
+	char	*shared = ft_shm_heap_malloc(heap, 32);
+	t_shm_heap	*other = ft_shm_heap_attach(g_name);
+
+	memcpy(shared, "hello", 6);
+	ft_shm_heap_set_root(heap, shared);
+	char	*seen = other ? ft_shm_heap_root(other) : NULL;
+	print_result("Root shared", seen && strcmp(seen, "hello") == 0);
+	ft_shm_heap_detach(other);
+
+	ft_shm_heap_detach(heap);
+	print_result("Destroyed", ft_shm_heap_destroy(g_name) == 0 && ft_shm_heap_attach(g_name) == NULL);
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS 1000
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Map a process's segment the way an outside reader would. */
+static const t_shm_stats	*map_segment(pid_t pid)
+{
+	char	path[64];
+
+	snprintf(path, sizeof(path), FT_SHM_STATS_PREFIX "%d", (int)pid);
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	const t_shm_stats *stats = mmap(NULL, sizeof(t_shm_stats), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	return stats == MAP_FAILED ? NULL : stats;
+}
+
+int main(void)
+{
+	static void *objs[OBJECTS];
+
+	ft_putstr_fd("=== SHM STATS TEST ===\n", 1);
+
+	/* 1) Enabling creates the segment. */
+	print_result("mallopt(M_FT_SHM_STATS, 1)", mallopt(M_FT_SHM_STATS, 1) == 1);
+	const t_shm_stats *stats = map_segment(getpid());
+	print_result("Segment is readable from outside", stats != NULL);
+	if (!stats)
+		return 1;
+	print_result("Header is valid", stats->magic == FT_SHM_STATS_MAGIC
+		&& stats->version == FT_SHM_STATS_VERSION && stats->pid == getpid());
+
+	/* 2) Allocations and frees show up per class. */
+	const t_shm_class_stats *tiny = &stats->classes[TINY];
+	uint64_t allocs = tiny->allocs;
+	uint64_t in_use = tiny->bytes_in_use;
+	for (int i = 0; i < OBJECTS; i++)
+		objs[i] = malloc(64);
+	print_result("TINY allocs counted", tiny->allocs - allocs == OBJECTS);
+	print_result("TINY bytes in use counted", tiny->bytes_in_use - in_use >= OBJECTS * 64);
+	print_result("TINY zones published", tiny->zones > 0 && tiny->zone_bytes > 0
+		&& tiny->mmap_calls > 0);
+	for (int i = 0; i < OBJECTS; i++)
+		free(objs[i]);
+	print_result("TINY frees counted", tiny->frees >= OBJECTS);
+	print_result("TINY bytes back to start", tiny->bytes_in_use == in_use);
+
+	/* 3) Recently-freed hits and LARGE zones. */
+	uint64_t hits = tiny->reuse_hits;
+	free(malloc(64));
+	print_result("Recently-freed hit counted", tiny->reuse_hits == hits + 1);
+	const t_shm_class_stats *large = &stats->classes[LARGE];
+	uint64_t munmaps = large->munmap_calls;
+	void *big = malloc(1 << 20);
+	print_result("LARGE zone counted", large->zones >= 1 && large->bytes_in_use >= (1 << 20));
+	free(big);
+	print_result("LARGE munmap counted", large->munmap_calls == munmaps + 1);
+	print_result("Lock counters published", tiny->lock_acquisitions > 0);
+
+	/* 4) A forked child stops publishing into the parent's segment. */
+	allocs = tiny->allocs;
+	pid_t child = fork();
+	if (child == 0)
+	{
+		for (int i = 0; i < OBJECTS; i++)
+			objs[i] = malloc(64);
+		_exit(map_segment(getpid()) == NULL ? 0 : 1);
+	}
+	int status = 0;
+	waitpid(child, &status, 0);
+	print_result("Child creates no segment", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	print_result("Child leaves parent counters alone", tiny->allocs == allocs);
+	return 0;
+}
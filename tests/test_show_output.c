@@ -0,0 +1,98 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define DUMP_PATH  "/tmp/ft_malloc_show_output.txt"
+#define DUMP_LIMIT 64
+
+static char g_text[1 << 20];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Read a whole file into g_text (NUL terminated); returns its length. */
+static size_t	read_file(const char *path)
+{
+	int		fd = open(path, O_RDONLY);
+	size_t	len = 0;
+	ssize_t	n;
+
+	if (fd < 0)
+		return 0;
+	while ((n = read(fd, g_text + len, sizeof(g_text) - 1 - len)) > 0)
+		len += (size_t)n;
+	close(fd);
+	g_text[len] = '\0';
+	return len;
+}
+
+static size_t	count_occurrences(const char *text, const char *needle)
+{
+	size_t count = 0;
+
+	while ((text = strstr(text, needle)) != NULL)
+	{
+		count++;
+		text += strlen(needle);
+	}
+	return count;
+}
+
+int main(void)
+{
+	ft_putstr_fd("=== SHOW OUTPUT TEST ===\n", 1);
+
+	char *a = malloc(32);
+	char *b = malloc(100);
+	char *c = malloc(4096);
+	memset(a, 'A', 32);
+	memset(b, 'B', 100);
+	memset(c, 'C', 4096);
+
+	/* 1) show_alloc_mem to a file descriptor. */
+	int fd = open(DUMP_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	show_alloc_mem_fd(fd);
+	close(fd);
+	read_file(DUMP_PATH);
+	print_result("show_alloc_mem_fd writes the total", strstr(g_text, "Total : ") != NULL);
+	print_result("show_alloc_mem_fd lists the blocks", strstr(g_text, " : 4096 bytes\n") != NULL);
+
+	/* 2) Unlimited hexdump to a file: every payload byte shows up. */
+	print_result("show_alloc_mem_ex_file opens the file", show_alloc_mem_ex_file(DUMP_PATH, 0) == 0);
+	read_file(DUMP_PATH);
+	print_result("Hexdump covers the whole payload", count_occurrences(g_text, "43 ") >= 4096);
+	print_result("ASCII column mirrors the payload", strstr(g_text, "|AAAAAAAAAAAAAAAA|") != NULL);
+	print_result("No limit note without a limit", strstr(g_text, "not dumped") == NULL);
+
+	/* 3) Byte limit: at most DUMP_LIMIT payload bytes are dumped in total. */
+	show_alloc_mem_ex_file(DUMP_PATH, DUMP_LIMIT);
+	read_file(DUMP_PATH);
+	print_result("Limit caps the dumped bytes",
+		count_occurrences(g_text, "41 ") + count_occurrences(g_text, "42 ")
+			+ count_occurrences(g_text, "43 ") <= DUMP_LIMIT);
+	print_result("Blocks past the limit are still listed", strstr(g_text, "SIZE: 4096 bytes") != NULL);
+	print_result("Limit note is printed", strstr(g_text, "bytes not dumped (limit)") != NULL);
+
+	/* 4) Unwritable path and closed fd fail cleanly. */
+	print_result("Bad path returns -1", show_alloc_mem_ex_file("/nonexistent/dir/file", 0) == -1);
+	show_alloc_mem_stats_fd(-1);
+	print_result("Closed fd does not crash", 1);
+
+	unlink(DUMP_PATH);
+	free(a);
+	free(b);
+	free(c);
+	return 0;
+}
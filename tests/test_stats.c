@@ -0,0 +1,156 @@
+#include "../include/ft_malloc.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+static char g_text[1 << 16];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* Run the report into a pipe and load it into g_text, after a newline so every line starts with one. */
+static void	load_report(void)
+{
+	int		fds[2];
+	size_t	len = 1;
+	ssize_t	n;
+
+	g_text[0] = '\n';
+	g_text[1] = '\0';
+	if (pipe(fds) != 0)
+		return;
+	show_alloc_mem_stats_fd(fds[1]);
+	close(fds[1]);
+	while ((n = read(fds[0], g_text + len, sizeof(g_text) - 1 - len)) > 0)
+		len += (size_t)n;
+	close(fds[0]);
+	g_text[len] = '\0';
+}
+
+/* Numeric value after `field` on the summary line of `name` ("TINY"), -1 when absent. */
+static long	summary_value(const char *name, const char *field)
+{
+	char		key[32] = "\n";
+	const char	*line;
+	const char	*end;
+	const char	*value;
+
+	strcat(strcat(key, name), " : zones=");
+	line = strstr(g_text, key);
+	if (!line)
+		return -1;
+	line++;
+	end = strchr(line, '\n');
+	value = strstr(line, field);
+	if (!value || (end && value > end))
+		return -1;
+	return atol(value + strlen(field));
+}
+
+/* Mapped bytes of a class, straight from its zone list. */
+static long	class_mapped(t_zone_type type)
+{
+	long	mapped = 0;
+
+	for (const t_zone *zone = g_zones[type]; zone; zone = zone->next)
+		mapped += (long)zone->size;
+	return mapped;
+}
+
+/* Every mapped byte is payload (used or free) or header. */
+static int	balanced(const char *name)
+{
+	return summary_value(name, "mapped=") == summary_value(name, "used=")
+		+ summary_value(name, "free=") + summary_value(name, "overhead=");
+}
+
+int main(void)
+{
+	const char	*names[ZONE_TYPE_COUNT] = {"TINY", "SMALL", "MEDIUM", "LARGE"};
+
+	ft_putstr_fd("=== STATS TEST ===\n", 1);
+
+	/* Exact sizes would otherwise move to hot-size slabs. */
+	mallopt(M_FT_HOT_SLABS, 0);
+
+	/* 1) Baseline: libc may already hold blocks before main(). */
+	long	base_zones[ZONE_TYPE_COUNT];
+	long	base_used[ZONE_TYPE_COUNT];
+
+	load_report();
+	print_result("Report captured from the fd", strstr(g_text, "Total : zones=") != NULL);
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+	{
+		base_zones[type] = summary_value(names[type], "zones=");
+		base_used[type] = summary_value(names[type], "used=");
+	}
+	print_result("Baseline balanced", balanced("Total") && base_used[TINY] == 0 && base_used[SMALL] == 0);
+
+	/* 2) A known sequence: three TINY (one freed), one of each other class. */
+	char	*t1 = malloc(32);
+	char	*t2 = malloc(32);
+	char	*t3 = malloc(48);
+	char	*s = malloc(500);
+	char	*m = malloc(100000);
+	char	*l = malloc(1 << 20);
+
+	free(t2);
+	load_report();
+
+	print_result("TINY: one zone, 80 bytes used, one parked",
+		summary_value("TINY", "zones=") == 1 && summary_value("TINY", "used=") == 32 + 48
+		&& summary_value("TINY", "deferred=") == 1);
+	print_result("TINY: parked block counted as free", summary_value("TINY", "free=") >= 32
+		&& summary_value("TINY", "largest_free=") <= summary_value("TINY", "free="));
+	print_result("SMALL: 500 rounds up to 512", summary_value("SMALL", "zones=") == 1
+		&& summary_value("SMALL", "used=") == 512 && summary_value("SMALL", "deferred=") == 0);
+	print_result("MEDIUM: one shared zone", summary_value("MEDIUM", "zones=") == 1
+		&& summary_value("MEDIUM", "used=") == base_used[MEDIUM] + 100000);
+	print_result("LARGE: one zone per block", summary_value("LARGE", "zones=") == base_zones[LARGE] + 1
+		&& summary_value("LARGE", "used=") >= base_used[LARGE] + (1 << 20)
+		&& summary_value("LARGE", "free=") == 0);
+
+	int	ok = 1;
+	long	zones = 0;
+	long	used = 0;
+
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+	{
+		ok &= summary_value(names[type], "mapped=") == class_mapped((t_zone_type)type);
+		ok &= balanced(names[type]);
+		zones += summary_value(names[type], "zones=");
+		used += summary_value(names[type], "used=");
+	}
+	print_result("mapped matches the zone lists", ok);
+	print_result("mapped = used + free + overhead", ok && balanced("Total"));
+	print_result("Total sums the classes", summary_value("Total", "zones=") == zones
+		&& summary_value("Total", "used=") == used);
+	print_result("Lock lines printed", strstr(g_text, "TINY lock : acquisitions=")
+		&& strstr(g_text, "LARGE lock : acquisitions="));
+
+	/* 3) Everything freed: back to the baseline; the LARGE zone is gone. */
+	free(t1);
+	free(t3);
+	free(s);
+	free(m);
+	free(l);
+	load_report();
+	ok = summary_value("LARGE", "zones=") == base_zones[LARGE];
+	for (int type = 0; type < ZONE_TYPE_COUNT; type++)
+		ok &= summary_value(names[type], "used=") == base_used[type];
+	print_result("Nothing left in use after free", ok);
+	print_result("Still balanced", balanced("TINY") && balanced("Total"));
+	return 0;
+}
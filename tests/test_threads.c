@@ -0,0 +1,176 @@
+#include "../include/ft_malloc.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define THREADS    8
+#define SLOTS      64
+#define ROUNDS     5000
+#define TIMEOUT    60
+
+/* One size per class, on both sides of each limit, so reallocs cross classes. */
+static const size_t	g_sizes[] = {
+	1, 48, TINY_MALLOC_LIMIT,
+	TINY_MALLOC_LIMIT + 1, 600, SMALL_MALLOC_LIMIT,
+	SMALL_MALLOC_LIMIT + 1, 20000, MEDIUM_MALLOC_LIMIT,
+	MEDIUM_MALLOC_LIMIT + 1, 400000,
+};
+#define SIZE_COUNT (sizeof(g_sizes) / sizeof(g_sizes[0]))
+
+typedef struct s_slot {
+	unsigned char	*ptr;
+	size_t			len;
+	unsigned char	tag;
+}	t_slot;
+
+static volatile sig_atomic_t	g_stop;
+static int						g_corrupt[THREADS];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+/* A deadlock never returns: report it instead of hanging the run. */
+static void	on_timeout(int sig)
+{
+	(void)sig;
+	ft_putstr_fd("No deadlock [" RED "FAIL" RESET "]\n", 1);
+	_exit(1);
+}
+
+/* First n bytes of the slot still hold its tag. */
+static int	intact(const t_slot *slot, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		if (slot->ptr[i] != slot->tag)
+			return 0;
+	return 1;
+}
+
+static void	fill(t_slot *slot, size_t len, unsigned char tag)
+{
+	slot->len = len;
+	slot->tag = tag;
+	memset(slot->ptr, tag, len);
+}
+
+static void	*worker(void *arg)
+{
+	const size_t	id = (size_t)arg;
+	t_slot			slots[SLOTS] = {0};
+	size_t			seed = id * 7919 + 1;
+
+	for (size_t round = 0; round < ROUNDS; round++)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		t_slot			*slot = &slots[(seed >> 33) % SLOTS];
+		const size_t	len = g_sizes[(seed >> 20) % SIZE_COUNT];
+		const unsigned char	tag = (unsigned char)(id * 31 + round);
+
+		if (!slot->ptr)
+		{
+			slot->ptr = malloc(len);
+			if (slot->ptr)
+				fill(slot, len, tag);
+		}
+		else if ((seed >> 12) % 3 == 0)
+		{
+			if (!intact(slot, slot->len))
+				g_corrupt[id]++;
+			free(slot->ptr);
+			slot->ptr = NULL;
+		}
+		else
+		{
+			const size_t	kept = slot->len < len ? slot->len : len;
+			unsigned char	*moved = realloc(slot->ptr, len);
+
+			if (!moved)
+				continue;
+			slot->ptr = moved;
+			if (!intact(slot, kept))
+				g_corrupt[id]++;
+			fill(slot, len, tag);
+		}
+	}
+	for (size_t i = 0; i < SLOTS; i++)
+	{
+		if (slots[i].ptr && !intact(&slots[i], slots[i].len))
+			g_corrupt[id]++;
+		free(slots[i].ptr);
+	}
+	return NULL;
+}
+
+/* Walks every class while the workers change them. */
+static void	*reporter(void *arg)
+{
+	const int	fd = *(const int *)arg;
+	size_t		walks = 0;
+
+	while (!g_stop)
+	{
+		show_alloc_mem_fd(fd);
+		show_alloc_mem_stats_fd(fd);
+		walks++;
+	}
+	return (void *)walks;
+}
+
+int main(void)
+{
+	pthread_t	threads[THREADS];
+	pthread_t	walker;
+	void		*walks = NULL;
+	int			devnull = open("/dev/null", O_WRONLY);
+	int			corrupt = 0;
+
+	ft_putstr_fd("=== THREADS TEST ===\n", 1);
+	signal(SIGALRM, on_timeout);
+	alarm(TIMEOUT);
+
+	/* 1) Workers malloc/free/realloc across all classes, a reporter walks them. */
+	pthread_create(&walker, NULL, reporter, &devnull);
+	for (size_t i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, worker, (void *)i);
+	for (size_t i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+	g_stop = 1;
+	pthread_join(walker, &walks);
+	alarm(0);
+	close(devnull);
+
+	for (size_t i = 0; i < THREADS; i++)
+		corrupt += g_corrupt[i];
+	print_result("No deadlock", 1);
+	print_result("Reporter ran alongside the workers", walks != NULL);
+	print_result("Payloads intact across realloc and free", corrupt == 0);
+
+	/* 2) Everything came back: the allocator still serves every class. */
+	int	ok = 1;
+
+	for (size_t i = 0; i < SIZE_COUNT; i++)
+	{
+		unsigned char	*p = malloc(g_sizes[i]);
+
+		if (!p)
+			ok = 0;
+		else
+			memset(p, 0x5A, g_sizes[i]);
+		free(p);
+	}
+	print_result("All classes usable afterwards", ok);
+	return 0;
+}
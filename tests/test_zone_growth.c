@@ -0,0 +1,121 @@
+#include "../include/ft_malloc.h"
+#include <malloc.h>
+#include <string.h>
+#include <time.h>
+
+#define RESET   "\033[0m"
+#define RED     "\033[31m"
+#define GREEN   "\033[32m"
+
+#define OBJECTS   400000
+#define LATE      20000
+#define OBJ_SIZE  32
+#define ALIGNED   4000
+
+/* Freeing LATE blocks took about 0.02 s before zones grew, 6 s with a zone walk. */
+#define MAX_SECONDS 0.5
+
+static char	*g_objs[OBJECTS];
+
+static void	print_result(const char *test_name, int condition)
+{
+	ft_putstr_fd(test_name, 1);
+	ft_putstr_fd(" [", 1);
+	if (condition)
+		ft_putstr_fd(GREEN "OK" RESET, 1);
+	else
+		ft_putstr_fd(RED "FAIL" RESET, 1);
+	ft_putstr_fd("]\n", 1);
+}
+
+static double	seconds_since(const struct timespec *start)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Longest run of back-to-back blocks among the last LATE objects. */
+static size_t	longest_run(void)
+{
+	size_t	best = 1;
+	size_t	run = 1;
+
+	for (size_t i = OBJECTS - LATE + 1; i < OBJECTS; i++)
+	{
+		run = g_objs[i] - g_objs[i - 1] == OBJ_SIZE + (long)BLOCK_HDR_SIZE ? run + 1 : 1;
+		if (run > best)
+			best = run;
+	}
+	return best;
+}
+
+int main(void)
+{
+	struct timespec	start;
+	int				ok = 1;
+
+	ft_putstr_fd("=== ZONE GROWTH TEST ===\n", 1);
+
+	/* Every block goes through the regular zones, not through hot-size slabs. */
+	mallopt(M_FT_HOT_SLABS, 0);
+
+	/* 1) Many TINY blocks: the late ones land in one big grown zone. */
+	for (size_t i = 0; i < OBJECTS; i++)
+	{
+		g_objs[i] = malloc(OBJ_SIZE);
+		if (!g_objs[i])
+			ok = 0;
+		else
+			memset(g_objs[i], (char)i, OBJ_SIZE);
+	}
+	print_result("Allocations succeed", ok);
+	print_result("Late blocks share one large zone", longest_run() > LATE / 2);
+
+	/* 2) realloc() of late blocks finds them without a zone walk. */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = OBJECTS - LATE; i < OBJECTS; i++)
+		if (realloc(g_objs[i], OBJ_SIZE / 2) != g_objs[i])
+			ok = 0;
+	print_result("realloc of late blocks is fast", ok && seconds_since(&start) < MAX_SECONDS);
+
+	/* 3) Invalid pointers into the big zone are still rejected. */
+	char	*victim = g_objs[OBJECTS - 1];
+
+	free(victim + BLOCK_HDR_SIZE);
+	free(victim + MALLOC_ALIGN / 2);
+	print_result("Interior pointers ignored", victim[0] == (char)(OBJECTS - 1));
+
+	/* 4) Freeing the late blocks costs O(1) each. */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = OBJECTS - LATE; i < OBJECTS; i++)
+		free(g_objs[i]);
+	const double	free_seconds = seconds_since(&start);
+
+	print_result("free of late blocks is fast", free_seconds < MAX_SECONDS);
+
+	/* 5) A double free is caught: two new blocks never alias. */
+	free(victim);
+	char	*a = malloc(OBJ_SIZE);
+	char	*b = malloc(OBJ_SIZE);
+	print_result("Double free ignored", a && b && a != b);
+	free(a);
+	free(b);
+
+	/* 6) Aligned blocks (cut out of padded ones) are found the same way. */
+	static char	*aligned[ALIGNED];
+
+	ok = 1;
+	for (size_t i = 0; i < ALIGNED; i++)
+		if (posix_memalign((void **)&aligned[i], 64, OBJ_SIZE) != 0 || (size_t)aligned[i] % 64)
+			ok = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ALIGNED; i++)
+		free(aligned[i]);
+	print_result("Aligned blocks freed fast", ok && seconds_since(&start) < MAX_SECONDS);
+
+	for (size_t i = 0; i < OBJECTS - LATE; i++)
+		free(g_objs[i]);
+	return 0;
+}
@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Render a ft_malloc heap layout dump (JSON Lines) for fragmentation analysis.
+
+The dump comes from show_alloc_mem_layout_fd() / show_alloc_mem_layout_file(),
+or from MallocLayoutDump=<path> at exit. Standard library only.
+
+Prints:
+- a per-class summary: mapped, used, free, untouched (frontier) bytes, largest
+  free block, external fragmentation, and stranded pages (pages that hold live
+  data but are mostly free: they stay resident and cannot be returned)
+- an occupancy map: one row per zone, one character per slice of the zone
+- a fragmentation heatmap: one row per zone, one character per slice of pages,
+  darker where resident pages are mostly free space
+
+With --svg, the same occupancy map and heatmap are also drawn to an SVG file.
+"""
+
+import argparse
+import json
+import sys
+
+STATES = ("meta", "used", "free", "deferred", "frontier")
+
+# Occupancy characters, by the state covering most of a slice.
+OCCUPANCY_CHARS = {"meta": "+", "used": "#", "free": ".", "deferred": "~", "frontier": " "}
+OCCUPANCY_COLORS = {"meta": "#7f7f7f", "used": "#1f77b4", "free": "#e0e0e0",
+                    "deferred": "#ffbf7f", "frontier": "#ffffff"}
+
+# Heatmap ramp: share of free bytes on pages that still hold live data.
+HEAT_RAMP = " .:-=+*#%@"
+
+# A page is stranded when live data pins it but most of it is free.
+STRANDED_FREE_SHARE = 0.5
+
+
+def load(path):
+    """Return (heap, zones); each zone dict gets a 'blocks' list."""
+    heap = {}
+    zones = []
+    stream = sys.stdin if path == "-" else open(path, encoding="ascii")
+    with stream:
+        for number, line in enumerate(stream, 1):
+            if not line.strip():
+                continue
+            try:
+                record = json.loads(line)
+            except ValueError as error:
+                sys.exit(f"{path}:{number}: {error}")
+            kind = record.get("kind")
+            if kind == "heap":
+                heap = record
+            elif kind == "zone":
+                record["blocks"] = []
+                zones.append(record)
+            elif kind == "block":
+                zones[record["zone"]]["blocks"].append(record)
+    return heap, zones
+
+
+def intervals(zone, header):
+    """Byte ranges of a zone as (start, end, state), in address order.
+
+    Headers of live blocks are metadata; a free block's header counts as
+    part of the free space it describes.
+    """
+    ranges = [(0, zone["first"], "meta")]
+    end = zone["first"]
+    for block in zone["blocks"]:
+        start = block["offset"]
+        state = block["state"]
+        ranges.append((start, start + header, "meta" if state == "used" else state))
+        ranges.append((start + header, start + header + block["size"], block["state"]))
+        end = start + header + block["size"]
+    ranges.append((end, zone["size"], "meta"))  # fence (and LARGE page rounding)
+    return ranges
+
+
+def bin_bytes(ranges, bin_size, bins):
+    """Bytes of each state falling in each bin of bin_size bytes."""
+    counts = {state: [0] * bins for state in STATES}
+    for start, end, state in ranges:
+        while start < end:
+            index = min(start // bin_size, bins - 1)
+            stop = min(end, (index + 1) * bin_size) if index < bins - 1 else end
+            counts[state][index] += stop - start
+            start = stop
+    return counts
+
+
+def page_stats(ranges, page_size, size):
+    """Per page: (live bytes, free bytes); untouched frontier pages count as neither.
+
+    The zone header and fence are left out: they only pin the first and last page.
+    """
+    pages = max(1, (size + page_size - 1) // page_size)
+    counts = bin_bytes(ranges[1:-1], page_size, pages)
+    live = [counts["used"][i] + counts["meta"][i] for i in range(pages)]
+    free = [counts["free"][i] + counts["deferred"][i] for i in range(pages)]
+    return live, free
+
+
+def largest_free(zone):
+    sizes = [b["size"] for b in zone["blocks"] if b["state"] in ("free", "deferred")]
+    return max(sizes, default=0)
+
+
+def human(value):
+    for unit in ("B", "K", "M", "G"):
+        if value < 1024 or unit == "G":
+            return f"{value:.0f}{unit}" if unit == "B" else f"{value:.1f}{unit}"
+        value /= 1024
+    return str(value)
+
+
+def summarize(zones, header, page_size):
+    print(f"{'class':<7}{'zones':>6}{'mapped':>10}{'used':>10}{'free':>10}"
+          f"{'untouched':>11}{'largest':>10}{'frag':>7}{'stranded':>10}")
+    totals = {}
+    for zone in zones:
+        entry = totals.setdefault(zone["class"], {"zones": 0, "mapped": 0, "used": 0, "free": 0,
+                                                  "frontier": 0, "largest": 0, "stranded": 0})
+        entry["zones"] += 1
+        entry["mapped"] += zone["size"]
+        for block in zone["blocks"]:
+            state = block["state"]
+            key = "free" if state == "deferred" else state
+            entry[key] += block["size"]
+        entry["largest"] = max(entry["largest"], largest_free(zone))
+        live, free = page_stats(intervals(zone, header), page_size, zone["size"])
+        entry["stranded"] += sum(1 for l, f in zip(live, free)
+                                 if l and f > STRANDED_FREE_SHARE * page_size)
+    for name in ("TINY", "SMALL", "MEDIUM", "LARGE"):
+        if name not in totals:
+            continue
+        entry = totals[name]
+        frag = 1 - entry["largest"] / entry["free"] if entry["free"] else 0
+        print(f"{name:<7}{entry['zones']:>6}{human(entry['mapped']):>10}{human(entry['used']):>10}"
+              f"{human(entry['free']):>10}{human(entry['frontier']):>11}"
+              f"{human(entry['largest']):>10}{frag:>6.0%}{entry['stranded']:>10}")
+
+
+def occupancy_row(ranges, size, width):
+    bin_size = max(1, (size + width - 1) // width)
+    bins = (size + bin_size - 1) // bin_size
+    counts = bin_bytes(ranges, bin_size, bins)
+    row = []
+    for i in range(bins):
+        state = max(STATES, key=lambda s: counts[s][i])
+        row.append(state)
+    return row
+
+
+def heat_row(ranges, size, page_size, width):
+    """Per column: free share of the resident (live) pages it covers, or None."""
+    live, free = page_stats(ranges, page_size, size)
+    per_cell = max(1, (len(live) + width - 1) // width)
+    row = []
+    for start in range(0, len(live), per_cell):
+        pinned = [f for l, f in zip(live[start:start + per_cell], free[start:start + per_cell]) if l]
+        row.append(sum(pinned) / (len(pinned) * page_size) if pinned else None)
+    return row
+
+
+def heat_char(share):
+    if share is None:
+        return " "
+    return HEAT_RAMP[min(len(HEAT_RAMP) - 1, int(share * len(HEAT_RAMP)))]
+
+
+def zone_label(zone):
+    hot = " hot" if zone.get("hot") else ""
+    return f"{zone['class']:<6} #{zone['zone']:<4} {zone['addr']:>14} {human(zone['size']):>7}{hot:<4}"
+
+
+def print_maps(zones, header, page_size, width, limit):
+    shown = zones[:limit] if limit else zones
+    legend = "  ".join(f"'{OCCUPANCY_CHARS[s]}' {s}" for s in STATES)
+    print(f"\nOccupancy ({legend})")
+    for zone in shown:
+        row = occupancy_row(intervals(zone, header), zone["size"], width)
+        print(f"{zone_label(zone)} |{''.join(OCCUPANCY_CHARS[s] for s in row)}|")
+    print(f"\nFragmentation heatmap (free share of pages holding live data: "
+          f"'{HEAT_RAMP[1]}' low .. '{HEAT_RAMP[-1]}' high, blank = no live data)")
+    for zone in shown:
+        row = heat_row(intervals(zone, header), zone["size"], page_size, width)
+        print(f"{zone_label(zone)} |{''.join(heat_char(s) for s in row)}|")
+    if limit and len(zones) > limit:
+        print(f"... {len(zones) - limit} more zones (use --zones 0 to show all)")
+
+
+def write_svg(path, zones, header, page_size, width):
+    cell, row_height, label = 2, 10, 260
+    rows = []
+    y = 20
+    for zone in zones:
+        ranges = intervals(zone, header)
+        rows.append(f'<text x="0" y="{y + 8}">{zone_label(zone)}</text>')
+        for x, state in enumerate(occupancy_row(ranges, zone["size"], width)):
+            rows.append(f'<rect x="{label + x * cell}" y="{y}" width="{cell}" height="{row_height}" '
+                        f'fill="{OCCUPANCY_COLORS[state]}"/>')
+        heat_x = label + (width + 10) * cell
+        for x, share in enumerate(heat_row(ranges, zone["size"], page_size, width)):
+            if share is not None:
+                red = int(255 * share)
+                rows.append(f'<rect x="{heat_x + x * cell}" y="{y}" width="{cell}" height="{row_height}" '
+                            f'fill="rgb({red},{255 - red},64)"/>')
+        y += row_height + 2
+    total_width = label + (2 * width + 10) * cell
+    with open(path, "w", encoding="ascii") as out:
+        out.write(f'<svg xmlns="http://www.w3.org/2000/svg" width="{total_width}" height="{y}" '
+                  f'font-family="monospace" font-size="9">\n')
+        out.write(f'<text x="{label}" y="12">occupancy</text>'
+                  f'<text x="{label + (width + 10) * cell}" y="12">free share of live pages</text>\n')
+        out.write("\n".join(rows))
+        out.write("\n</svg>\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", help="layout dump (JSON Lines), '-' for stdin")
+    parser.add_argument("-w", "--width", type=int, default=96, help="map columns per zone")
+    parser.add_argument("-z", "--zones", type=int, default=64,
+                        help="zones shown in the maps (0: all)")
+    parser.add_argument("-c", "--class", dest="zone_class", help="only zones of this class")
+    parser.add_argument("--svg", help="also draw the maps to this SVG file")
+    args = parser.parse_args()
+
+    heap, zones = load(args.dump)
+    page_size = heap.get("page_size", 4096)
+    header = heap.get("block_header", 16)
+    if args.zone_class:
+        zones = [z for z in zones if z["class"] == args.zone_class.upper()]
+    print(f"pid {heap.get('pid', '?')}: {len(zones)} zones, "
+          f"{sum(len(z['blocks']) for z in zones)} blocks\n")
+    summarize(zones, header, page_size)
+    print_maps(zones, header, page_size, args.width, args.zones)
+    if args.svg:
+        write_svg(args.svg, zones, header, page_size, args.width)
+
+
+if __name__ == "__main__":
+    main()
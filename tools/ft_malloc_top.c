@@ -0,0 +1,174 @@
+/*
+ * ft_malloc_top: live view of a process's allocator stats.
+ *
+ * Maps the stats segment an ft_malloc process publishes with
+ * MallocShmStats=1 (/dev/shm/ft_malloc.<pid>) read-only and redraws a
+ * per-class table every interval, in the style of top(1). Nothing is
+ * injected into the target: it keeps running untouched.
+ *
+ * usage: ft_malloc_top <pid | segment path> [-i interval_ms] [-n iterations]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ft_malloc_shm.h"
+
+static const char *g_class_names[FT_SHM_CLASS_COUNT] = {"TINY", "SMALL", "MEDIUM", "LARGE"};
+
+static uint64_t load(const uint64_t *counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/* Copy every counter out of the shared mapping with relaxed loads. */
+static void sample(const t_shm_stats *shared, t_shm_stats *out) {
+    memset(out, 0, sizeof(*out));
+    for (int c = 0; c < FT_SHM_CLASS_COUNT; c++) {
+        const uint64_t *src = (const uint64_t *)&shared->classes[c];
+        uint64_t *      dst = (uint64_t *)&out->classes[c];
+
+        for (size_t i = 0; i < sizeof(t_shm_class_stats) / sizeof(uint64_t); i++)
+            dst[i] = load(&src[i]);
+    }
+    out->caches.hits   = load(&shared->caches.hits);
+    out->caches.misses = load(&shared->caches.misses);
+    out->caches.frees  = load(&shared->caches.frees);
+}
+
+/* 1536 -> "1.5K", human-readable byte counts for narrow columns. */
+static const char *human(uint64_t bytes, char *buf, size_t size) {
+    static const char *units = "BKMGTP";
+    double             value = (double)bytes;
+    int                unit  = 0;
+
+    while (value >= 1024.0 && units[unit + 1]) {
+        value /= 1024.0;
+        unit++;
+    }
+    if (unit == 0)
+        snprintf(buf, size, "%lluB", (unsigned long long)bytes);
+    else
+        snprintf(buf, size, "%.1f%c", value, units[unit]);
+    return buf;
+}
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void draw(const t_shm_stats *header, const t_shm_stats *now, const t_shm_stats *prev,
+                 double seconds, int clear) {
+    char     in_use[16];
+    char     mapped[16];
+    uint64_t total_in_use = 0;
+    uint64_t total_mapped = 0;
+
+    if (clear)
+        printf("\033[H\033[2J");
+    printf("ft_malloc_top - pid %lld - up %llds\n\n", (long long)header->pid,
+           (long long)(time(NULL) - header->start_time));
+    printf("%-7s %10s %10s %6s %10s %10s %8s %8s %7s %9s %7s\n", "CLASS", "IN_USE", "MAPPED",
+           "ZONES", "ALLOC/s", "FREE/s", "MMAP", "MUNMAP", "REUSE%", "LOCK_CONT", "CONT%");
+
+    for (int c = 0; c < FT_SHM_CLASS_COUNT; c++) {
+        const t_shm_class_stats *n = &now->classes[c];
+        const t_shm_class_stats *p = &prev->classes[c];
+
+        printf("%-7s %10s %10s %6llu %10.0f %10.0f %8llu %8llu %6.1f%% %9llu %6.2f%%\n",
+               g_class_names[c], human(n->bytes_in_use, in_use, sizeof(in_use)),
+               human(n->zone_bytes, mapped, sizeof(mapped)), (unsigned long long)n->zones,
+               (double)(n->allocs - p->allocs) / seconds,
+               (double)(n->frees - p->frees) / seconds,
+               (unsigned long long)n->mmap_calls, (unsigned long long)n->munmap_calls,
+               percent(n->reuse_hits, n->reuse_hits + n->reuse_misses),
+               (unsigned long long)n->lock_contended,
+               percent(n->lock_contended, n->lock_acquisitions));
+        total_in_use += n->bytes_in_use;
+        total_mapped += n->zone_bytes;
+    }
+
+    printf("\nTotal   %10s %10s  (%.1f%% of mapped bytes in use)\n",
+           human(total_in_use, in_use, sizeof(in_use)),
+           human(total_mapped, mapped, sizeof(mapped)), percent(total_in_use, total_mapped));
+    printf("Caches  hits=%llu misses=%llu hit-rate=%.1f%% frees=%llu\n",
+           (unsigned long long)now->caches.hits, (unsigned long long)now->caches.misses,
+           percent(now->caches.hits, now->caches.hits + now->caches.misses),
+           (unsigned long long)now->caches.frees);
+    fflush(stdout);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s <pid | segment path> [-i interval_ms] [-n iterations]\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    char path[256];
+    long interval_ms = 1000;
+    long iterations  = -1;
+
+    if (argc < 2)
+        usage(argv[0]);
+    if (strchr(argv[1], '/'))
+        snprintf(path, sizeof(path), "%s", argv[1]);
+    else
+        snprintf(path, sizeof(path), "%s%s", FT_SHM_STATS_PREFIX, argv[1]);
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            interval_ms = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atol(argv[++i]);
+        else
+            usage(argv[0]);
+    }
+    if (interval_ms <= 0)
+        interval_ms = 1000;
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s: %s (is MallocShmStats=1 set?)\n", argv[0], path, strerror(errno));
+        return 1;
+    }
+
+    const t_shm_stats *shared = mmap(NULL, sizeof(t_shm_stats), PROT_READ, MAP_SHARED, fd, 0);
+    if (shared == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap: %s\n", argv[0], strerror(errno));
+        return 1;
+    }
+    if (__atomic_load_n(&shared->magic, __ATOMIC_ACQUIRE) != FT_SHM_STATS_MAGIC
+        || shared->version != FT_SHM_STATS_VERSION) {
+        fprintf(stderr, "%s: %s: not an ft_malloc stats segment (or another version)\n",
+                argv[0], path);
+        return 1;
+    }
+
+    t_shm_stats           prev;
+    t_shm_stats           now;
+    const struct timespec pause = {interval_ms / 1000, (interval_ms % 1000) * 1000000L};
+    const int             clear = isatty(STDOUT_FILENO);
+
+    sample(shared, &prev);
+    for (long i = 0; iterations < 0 || i < iterations; i++) {
+        struct stat st;
+
+        nanosleep(&pause, NULL);
+        sample(shared, &now);
+        draw(shared, &now, &prev, (double)interval_ms / 1000.0, clear);
+        prev = now;
+
+        /* The segment is unlinked when the process exits. */
+        if (fstat(fd, &st) != 0 || st.st_nlink == 0 || kill((pid_t)shared->pid, 0) != 0) {
+            printf("\nprocess %lld exited\n", (long long)shared->pid);
+            break;
+        }
+    }
+    return 0;
+}